@@ -53,6 +53,7 @@ Interface::Interface()
 
     // Load stored settings.
     loadFromYAML();
+    m_waveformCache.setDirectory(settingsDirectory() + "WaveformCache");
     getLatestFile();
     if (m_autoFileState == "Enabled") generateFileName();
     calculatePulsesPerTX();
@@ -79,7 +80,7 @@ void Interface::systemInfo()
         red << "|" << yellow << "          ¶ ¶¶         ¶¶       " << red << "|" << blue << "\t[TARGET FILE]: " << white << "'" << m_targetFileName << "'\n" <<
         red << "|" << yellow << "          ¶  ¶¶         ¶¶    ¶¶" << red << "|" << blue << "\t[AUTO FILING]: " << white << m_autoFileState << "\n" <<
         red << "|" << yellow << "          ¶  ¶¶          ¶¶¶¶¶¶¶" << red << "|" << blue << "\t[OTW FORMAT] : " << white << m_overTheWire << "\n" <<
-        red << "|" << yellow << "         ¶¶  ¶¶¶      ¶¶¶¶¶¶   ¶" << red << "|" << blue << "\t[CPU FORMAT] : " << white << m_cpuFormat << "\n" <<
+        red << "|" << yellow << "         ¶¶  ¶¶¶      ¶¶¶¶¶¶   ¶" << red << "|" << blue << "\t[CPU FORMAT] : " << white << "TX " << m_txCpuFormat << ", RX " << m_cpuFormat << blue << "\t[TX LEVEL]: " << white << m_txNormalisation << " -" << m_txBackoff << " dBFS, dither " << m_txDither << "\n" <<
         red << "|" << yellow << "         ¶¶   ¶¶  ¶¶¶¶¶¶  ¶¶    " << red << "|" << blue << "\n" <<
         red << "|" << yellow << "      ¶¶  ¶¶   ¶¶          ¶¶   " << red << "|" << blue << "\t[TX SMAMPLING]--[TARGET]: " << white << m_txSamplingFrequencyTarget / (1e6) << " MHz" << blue << "\t[" << green << "ACTUAL" << blue << "]: " << white << m_txSamplingFrequencyActual / (1e6) << " MHz\n" <<
         red << "|" << yellow << "       ¶¶ ¶    ¶¶¶¶        ¶¶   " << red << "|" << blue << "\t[RX SMAMPLING]--[TARGET]: " << white << m_rxSamplingFrequencyTarget / (1e6) << " MHz" << blue << "\t[" << green << "ACTUAL" << blue << "]: " << white << m_rxSamplingFrequencyActual / (1e6) << " MHz\n" <<
@@ -90,16 +91,16 @@ void Interface::systemInfo()
         red << "|" << yellow << "¶¶  ¶¶¶¶¶¶    ¶¶¶¶¶¶¶¶¶      ¶¶ " << red << "|" << blue << "\t[TX BW]---------[TARGET]: " << white << m_txBWTarget / (1e6) << " MHz" << blue << "\t[" << green << "ACTUAL" << blue << "]: " << white << m_txBWActual / (1e6) << " MHz\n" <<
         red << "|" << yellow << "¶¶¶¶¶   ¶      ¶   ¶¶¶¶¶     ¶¶ " << red << "|" << blue << "\t[RX BW]---------[TARGET]: " << white << m_rxBWTarget / (1e6) << " MHz" << blue << "\t[" << green << "ACTUAL" << blue << "]: " << white << m_rxBWActual / (1e6) << " MHz\n" <<
         red << "|" << yellow << "        ¶¶¶¶¶¶¶¶      ¶¶¶¶¶ ¶¶  " << red << "|" << blue << "\n" <<
-        red << "|" << yellow << "      ¶¶¶¶¶¶¶¶¶¶¶        ¶¶¶¶   " << red << "|" << blue << "\t[WAVE TYPE]      : " << white << m_waveType << "\n" <<
+        red << "|" << yellow << "      ¶¶¶¶¶¶¶¶¶¶¶        ¶¶¶¶   " << red << "|" << blue << "\t[WAVE TYPE]      : " << white << ((m_txSource == "CW tone") ? "CW tone (DDS)" : (m_txSource == "FMCW") ? "FMCW " + m_fmcwRamp : m_waveformFile.size() ? "File (" + std::filesystem::path(m_waveformFile).filename().string() + ")" : m_waveType) << "\n" <<
         red << "|" << yellow << "      ¶¶¶¶¶¶¶¶¶¶¶¶              " << red << "|" << blue << "\t[WINDOW FUNCTION]: " << white << m_windowFunction << "\n" <<
         red << "|" << yellow << "      ¶  ¶¶ ¶¶¶¶¶¶              " << red << "|" << blue << "\t[DEADZONE RANGE] : " << white << m_deadzone << " m" << blue << " \t[" << green << "ACTUAL" << blue << "] : " << white << m_deadzoneActual << " m\n" <<
         red << "|" << yellow << "     ¶¶      ¶   ¶              " << red << "|" << blue << "\t[MAX RANGE]      : " << white << m_maxRange << " m" << blue << " \t[" << green << "ACTUAL" << blue << "] : " << white << m_maxRangeActual << " m\n" <<
         red << "|" << yellow << "     ¶¶     ¶¶   ¶              " << red << "|" << blue << "\t[TX DURATION]    : " << white << m_txDuration << " s" << blue << "  \t[" << green << "ACTUAL" << blue << "] : " << white << m_txDurationActual << " s\n" <<
         red << "|" << yellow << "     ¶      ¶¶   ¶              " << red << "|" << blue << "\t[TOTAL PULSES]   : " << white << m_pulsesPerTransmission / 1000 << " k \n" << white <<
-        red << "|" << yellow << "    ¶¶      ¶¶   ¶¶             " << red << "|" << blue << "\n" <<
-        red << "|" << yellow << "    ¶¶      ¶¶   ¶¶             " << red << "|" << blue << "\n" <<
-        red << "|" << yellow << "   ¶¶¶¶¶¶¶¶¶¶¶¶¶¶¶¶             " << red << "|" << blue << "\n" <<
-        red << "|" << yellow << "  ¶¶¶¶¶¶¶¶¶ ¶¶¶¶¶¶¶¶            " << red << "|" << blue << "\n" <<
+        red << "|" << yellow << "    ¶¶      ¶¶   ¶¶             " << red << "|" << blue << "\t[WAVE CACHE]     : " << white << m_waveCacheStatus << "\n" <<
+        red << "|" << yellow << "    ¶¶      ¶¶   ¶¶             " << red << "|" << blue << "\t[COMPRESSION]    : " << white << m_streamingCompression << ", MTI " << m_streamingMTI << "\n" <<
+        red << "|" << yellow << "   ¶¶¶¶¶¶¶¶¶¶¶¶¶¶¶¶             " << red << "|" << blue << "\t[INTEGRATION]    : " << white << (m_integrationPRIs ? std::to_string(m_integrationPRIs) + " PRIs" + ((m_integrationVariance == "Enabled") ? ", variance" : "") : "Disabled") << "\n" <<
+        red << "|" << yellow << "  ¶¶¶¶¶¶¶¶¶ ¶¶¶¶¶¶¶¶            " << red << "|" << blue << "\t[RANGE GATE]     : " << white << m_rangeGate << ((m_rangeGate == "Custom") ? ", " + std::to_string((int)m_rangeGateStart) + " - " + std::to_string((int)m_rangeGateStop) + " m" : "") << "\n" <<
         red << "|" << yellow << "  ¶¶        ¶¶¶    ¶¶           " << red << "|" << blue << "\n" <<
         red << "|" << yellow << "   ¶¶¶¶¶¶¶¶¶¶¶¶¶¶¶¶¶            " << red << "|" << blue << "\n" << 
         red <<                 "----------------------------------"              << "\n";
@@ -9,6 +9,16 @@
 // ================================================================================================================================================================================ //
 
 #include "Utils/wavetable.hpp"
+#include "Utils/WindowFunctions.h"
+#include "Utils/Waveforms.h"
+#include "Utils/WaveformCache.h"
+#include "Utils/Predistortion.h"
+#include "Utils/WaveformFile.h"
+#include "Utils/PulseProfiles.h"
+#include "Processing/StreamingCompression.h"
+#include "Processing/CoherentIntegration.h"
+#include "Processing/RangeGate.h"
+#include "Processing/Dechirp.h"
 #include <string>									// String handling.
 #include <vector>									// C++ vectors.
 #include <uhd/exception.hpp>						// -- Ettus UHD.
@@ -91,9 +101,21 @@ private:
 	std::string m_txError = "None";
 	std::string m_rxError = "None";
 	std::string m_windowFunction = "None";
-	std::string m_waveType = "Linear Frequency Chirp";
-
-	std::vector<std::complex<float>> m_transmissionWave;
+	WindowParameters m_windowParameters;
+	std::string m_waveType = linearChirpWave;
+	std::string m_txSource = "Pulsed";		// "Pulsed" transmits the generated waveform, "CW tone" a DDS tone, "FMCW" continuous ramps.
+	double m_toneFrequency = 1e6;			// Offset of the CW tone from the TX carrier [Hz].
+	std::string m_fmcwRamp = "Sawtooth";	// "Sawtooth" or "Triangle".
+	double m_fmcwSweepTime = 1e-3;			// Period of the FMCW ramp [s].
+
+	std::vector<std::complex<float>> m_transmissionWave;		// Transmitted wave as fc32 without the TX predistortion, used as the processing reference.
+	std::vector<std::complex<int16_t>> m_transmissionWaveSC16;	// Transmitted wave as it is sent to the DAC.
+	WaveformCache<std::complex<int16_t>> m_waveformCache;		// Previously generated waveforms.
+	WaveformKey m_waveformKey;								// Parameters of the current waveform.
+	std::string m_waveCacheStatus = "No waveform generated.";
+	std::string m_waveformFile = "";						// Waveform file transmitted instead of the generated wave, empty to generate.
+	std::string m_pulseProfile = "None";					// Standard profile whose compiled pulse table replaces the generator.
+	std::string m_pulseProfileStatus = "Not used.";
 	const wave_table_class* wave_table;
 	uhd::tx_streamer::sptr tx_stream;
 	uhd::tx_metadata_t md;
@@ -111,7 +133,24 @@ private:
 	uhd::usrp::multi_usrp::sptr tx_usrp;
 	uhd::usrp::multi_usrp::sptr rx_usrp;
 	std::string m_overTheWire = "sc16";
-	std::string m_cpuFormat = "fc32";
+	std::string m_cpuFormat = "fc32";		// RX CPU format.
+	std::string m_txCpuFormat = "sc16";		// TX CPU format, the waveform is generated in this format.
+	float m_txBackoff = 1;					// Level of the waveform below DAC full scale [dB].
+	std::string m_txNormalisation = "Peak";	// Level measured for the backoff, "Peak" or "RMS".
+	std::string m_txDither = "Disabled";	// TPDF dither added when quantising the waveform.
+	std::string m_predistortion = "Disabled";	// Apply the TX predistortion calibrated for the current settings.
+	Predistortion m_predistortionCorrection;	// Correction for the current carrier, rate and gain.
+	std::string m_predistortionStatus = "Not applied.";
+	std::string m_streamingCompression = "Disabled";	// Compress the RX samples on worker threads while capturing.
+	std::string m_streamingMTI = "Disabled";			// MTI canceller run on the streamed compression, "2-pulse" or "3-pulse".
+	unsigned m_integrationPRIs = 0;						// PRIs averaged into every record of the capture, 0 writes every sample.
+	std::string m_integrationVariance = "Disabled";		// Also write the variance of every sample over the PRIs.
+	std::string m_rangeGate = "Disabled";				// Samples kept of every PRI, "Dead zone to max range" or "Custom".
+	double m_rangeGateStart = 0;						// Custom gate [m].
+	double m_rangeGateStop = 0;
+	unsigned m_processingThreads = 0;					// Threads of the processing executor, 0 uses every core that is not reserved.
+	unsigned m_reservedCores = 2;						// Physical cores kept free for the RX and TX threads.
+	std::string m_threadPinning = "Disabled";			// Pin the processing threads to the cores after the reserved ones.
 
 	// Transmit variables.
 	std::string tx_args, wave_type, tx_ant, tx_subdev, ref, otw, tx_channels;
@@ -195,8 +234,16 @@ public:
 	void setTXGain();
 	void setRXGain();
 	void setFilterBandwidth();
+	void setTXLevel();
+	void toggleTXDither();
+	void toggleStreamingCompression();
+	void toggleStreamingMTI();
+	void setCoherentIntegration();
+	void setRangeGate();
+	void setProcessingThreads();
 	void saveToYAML();
 	void loadFromYAML();
+	std::string settingsDirectory();	// Directory containing the settings file, next to the .exe.
 
 	// ----------------- //
 	//  W A V E F O R M  //
@@ -208,6 +255,14 @@ public:
 	void setDeadzoneRange();
 	void setTxTime();
 	void setPulseWaveform();
+	void setWindowParameter();
+	void setTxSource();
+	void setFMCW();
+	void analyseAmbiguity();
+	void predistortionMenu();
+	void setWaveformFile();
+	bool loadWaveformFile();
+	const PulseProfile* selectPulseProfile();
 	void generateTransmissionPusle();
 
 	// ------------------- //
@@ -217,22 +272,40 @@ public:
 	// Should the workers stop?
 	bool m_stopSignalCalled = false;			
 	// Signal handler.
-	void transmitBuffer(std::vector<std::complex<float>> transmitWave,
+	void transmitBuffer(std::vector<std::complex<int16_t>> transmitWave,
 						uhd::tx_streamer::sptr tx_streamer,
 						uhd::tx_metadata_t metadata,
 						size_t wavesPerBuffer);
+	// Transmit the pulse through a loopback and estimate the TX predistortion from the capture.
+	void calibratePredistortion();
+	// Transmit a continuous tone from the DDS, generated buffer by buffer.
+	void transmitTone(uhd::tx_streamer::sptr tx_streamer,
+					  uhd::tx_metadata_t metadata,
+					  size_t bufferSize);
+
+	// Can the stages that use the transmitted pulse on the RX stream (compression, range gate)
+	// run?  When they cannot, status is set to the reason.
+	bool pulsedStreamStagesSupported(std::string& status) const;
 
 	// Generate a file name based on the files currently in the folder.
 	void generateFileName();
 	void getLatestFile();
 	void removePathFromName(std::string& fileName);
 
-	// Recv_to_file function.
+	// Recv_to_file function.  Every buffer is also handed to the compressor, if there is one, is
+	// range gated when there is a gate, and goes to the integrator instead of the file when
+	// integrating.  startTime is the device time [s] of the first sample, negative to start
+	// settling_time from now.
 	void receiveBufferToFile(uhd::usrp::multi_usrp::sptr usrp,
 							 const std::string& file,
 							 size_t samps_per_buff,
 							 int num_requested_samples,
-							 double settling_time);
+							 double settling_time,
+							 StreamingCompressor* compressor = nullptr,
+							 CoherentIntegrator* integrator = nullptr,
+							 RangeGateStage* gate = nullptr,
+							 DechirpStage* dechirp = nullptr,
+							 double startTime = -1);
 };
 
 // ================================================================================================================================================================================ //
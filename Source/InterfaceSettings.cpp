@@ -3,8 +3,10 @@
 // ================================================================================================================================================================================ //
 
 #include "Interface.h"
+#include "Processing/Executor.h"
 #include <string>
 #include <iostream>
+#include <cmath>
 
 // ================================================================================================================================================================================ //
 //  Settings Main.                                                                                                                                                                  //
@@ -21,14 +23,21 @@ void Interface::settingsMenu()
 	std::cout << green << "\t  [3]: " << white << "TX gain.\n";
 	std::cout << green << "\t  [4]: " << white << "RX gain.\n";
 	std::cout << green << "\t  [5]: " << white << "Filter bandwidth.\n";
+	std::cout << green << "\t  [6]: " << white << "TX DAC level.\n";
+	std::cout << green << "\t  [7]: " << white << "Toggle TX dither.\n";
+	std::cout << green << "\t  [8]: " << white << "Toggle streaming pulse compression.\n";
+	std::cout << green << "\t  [9]: " << white << "Streaming MTI canceller.\n";
+	std::cout << green << "\t [10]: " << white << "Coherent integration.\n";
+	std::cout << green << "\t [11]: " << white << "Range gate.\n";
+	std::cout << green << "\t [12]: " << white << "Processing threads.\n";
 	std::cout << green << "\t  [0]: " << white << "Return.\n";
-	m_currentTerminalLine += 8;
+	m_currentTerminalLine += 15;
 	menuListBar(1);
 	unsigned int answer;
 	readInput(&answer);
 
 	// Handle errors.
-	while (answer < 0 || answer > 5) 
+	while (answer < 0 || answer > 12) 
 	{
 		clear();
 		systemInfo();
@@ -39,8 +48,15 @@ void Interface::settingsMenu()
 		std::cout << green << "\t  [3]: " << white << "TX gain.\n";
 		std::cout << green << "\t  [4]: " << white << "RX gain.\n";
 		std::cout << green << "\t  [5]: " << white << "Filter bandwidth.\n";
+		std::cout << green << "\t  [6]: " << white << "TX DAC level.\n";
+		std::cout << green << "\t  [7]: " << white << "Toggle TX dither.\n";
+		std::cout << green << "\t  [8]: " << white << "Toggle streaming pulse compression.\n";
+		std::cout << green << "\t  [9]: " << white << "Streaming MTI canceller.\n";
+		std::cout << green << "\t [10]: " << white << "Coherent integration.\n";
+		std::cout << green << "\t [11]: " << white << "Range gate.\n";
+		std::cout << green << "\t [12]: " << white << "Processing threads.\n";
 		std::cout << green << "\t  [0]: " << white << "Return.\n";
-		m_currentTerminalLine += 9;
+		m_currentTerminalLine += 16;
 		menuListBar(1);
 		printError(answer);
 		readInput(&answer);
@@ -63,6 +79,27 @@ void Interface::settingsMenu()
 	case 5:
 		setFilterBandwidth();
 		break;
+	case 6:
+		setTXLevel();
+		break;
+	case 7:
+		toggleTXDither();
+		break;
+	case 8:
+		toggleStreamingCompression();
+		break;
+	case 9:
+		toggleStreamingMTI();
+		break;
+	case 10:
+		setCoherentIntegration();
+		break;
+	case 11:
+		setRangeGate();
+		break;
+	case 12:
+		setProcessingThreads();
+		break;
 	case 0:
 		break;
 	}
@@ -346,6 +383,363 @@ void Interface::setFilterBandwidth()
 	settingsMenu();
 }
 
+void Interface::setTXLevel()
+{
+	// Level measured for the backoff.
+	clear();
+	systemInfo();
+	std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+	std::cout << green << "\t   |-> " << yellow << "Settings.\n";
+	std::cout << green << "\t   |-> " << yellow << "TX DAC level.\n";
+	std::cout << green << "\t  [i]: " << white << "The waveform is scaled to the 16 bit DAC range once, when it is generated.\n";
+	std::cout << green << "\t  [1]: " << white << "Peak (backoff from the largest sample on either rail).\n";
+	std::cout << green << "\t  [2]: " << white << "RMS (backoff from the RMS of the pulse, peaks may clip).\n";
+	m_currentTerminalLine += 6;
+	menuListBar(1);
+	unsigned int normalisation;
+	readInput(&normalisation);
+
+	while (normalisation != 1 && normalisation != 2)
+	{
+		clear();
+		systemInfo();
+		std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+		std::cout << green << "\t   |-> " << yellow << "Settings.\n";
+		std::cout << green << "\t   |-> " << yellow << "TX DAC level.\n";
+		std::cout << green << "\t  [i]: " << white << "The waveform is scaled to the 16 bit DAC range once, when it is generated.\n";
+		std::cout << green << "\t  [1]: " << white << "Peak (backoff from the largest sample on either rail).\n";
+		std::cout << green << "\t  [2]: " << white << "RMS (backoff from the RMS of the pulse, peaks may clip).\n";
+		m_currentTerminalLine += 7;
+		menuListBar(1);
+		printError(normalisation);
+		readInput(&normalisation);
+	}
+
+	// Backoff from full scale.
+	clear();
+	systemInfo();
+	std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+	std::cout << green << "\t   |-> " << yellow << "Settings.\n";
+	std::cout << green << "\t   |-> " << yellow << "TX DAC level.\n";
+	std::cout << green << "\t  [i]: " << white << "Enter the backoff below full scale [dB] (0 - 60):\n";
+	m_currentTerminalLine += 4;
+	menuListBar(1);
+	double answer;
+	readInput(&answer);
+
+	while (answer == -1 || answer < 0 || answer > 60)
+	{
+		clear();
+		systemInfo();
+		std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+		std::cout << green << "\t   |-> " << yellow << "Settings.\n";
+		std::cout << green << "\t   |-> " << yellow << "TX DAC level.\n";
+		std::cout << green << "\t  [i]: " << white << "Enter the backoff below full scale [dB] (0 - 60):\n";
+		m_currentTerminalLine += 5;
+		menuListBar(1);
+		if (answer == -1) printError(answer);
+		else std::cout << red << "\t[ERROR]: " << white << "A backoff of " << answer << " dB is not supported.\n";
+		readInput(&answer);
+	}
+
+	m_txNormalisation = (normalisation == 1) ? "Peak" : "RMS";
+	m_txBackoff = answer;
+	m_settingsStatusYAML = "Changed settings not saved to YAML file.";
+	generateTransmissionPusle();
+	settingsMenu();
+}
+
+void Interface::toggleTXDither()
+{
+	m_txDither = (m_txDither == "Enabled") ? "Disabled" : "Enabled";
+	m_settingsStatusYAML = "Changed settings not saved to YAML file.";
+	generateTransmissionPusle();
+	settingsMenu();
+}
+
+void Interface::toggleStreamingCompression()
+{
+	m_streamingCompression = (m_streamingCompression == "Enabled") ? "Disabled" : "Enabled";
+	m_settingsStatusYAML = "Changed settings not saved to YAML file.";
+	settingsMenu();
+}
+
+void Interface::toggleStreamingMTI()
+{
+	// Cycles through the cancellers, the compressed file then only holds the cancelled samples.
+	if (m_streamingMTI == "Disabled") m_streamingMTI = "2-pulse";
+	else if (m_streamingMTI == "2-pulse") m_streamingMTI = "3-pulse";
+	else m_streamingMTI = "Disabled";
+	m_settingsStatusYAML = "Changed settings not saved to YAML file.";
+	settingsMenu();
+}
+
+void Interface::setCoherentIntegration()
+{
+	// PRIs per record.
+	clear();
+	systemInfo();
+	std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+	std::cout << green << "\t   |-> " << yellow << "Settings.\n";
+	std::cout << green << "\t   |-> " << yellow << "Coherent integration.\n";
+	std::cout << green << "\t  [i]: " << white << "Only the average of every N PRIs is written, instead of every sample.\n";
+	std::cout << green << "\t  [i]: " << white << "Enter N (0 writes every sample, up to 1000000):\n";
+	m_currentTerminalLine += 5;
+	menuListBar(1);
+	double answer;
+	readInput(&answer);
+
+	while (answer == -1 || answer < 0 || answer > 1e6 || answer != std::floor(answer))
+	{
+		clear();
+		systemInfo();
+		std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+		std::cout << green << "\t   |-> " << yellow << "Settings.\n";
+		std::cout << green << "\t   |-> " << yellow << "Coherent integration.\n";
+		std::cout << green << "\t  [i]: " << white << "Only the average of every N PRIs is written, instead of every sample.\n";
+		std::cout << green << "\t  [i]: " << white << "Enter N (0 writes every sample, up to 1000000):\n";
+		m_currentTerminalLine += 6;
+		menuListBar(1);
+		if (answer == -1) printError(answer);
+		else std::cout << red << "\t[ERROR]: " << white << "Cannot integrate " << answer << " PRIs.\n";
+		readInput(&answer);
+	}
+	m_integrationPRIs = (unsigned)answer;
+
+	// Variance per range bin.
+	if (m_integrationPRIs)
+	{
+		clear();
+		systemInfo();
+		std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+		std::cout << green << "\t   |-> " << yellow << "Settings.\n";
+		std::cout << green << "\t   |-> " << yellow << "Coherent integration.\n";
+		std::cout << green << "\t  [1]: " << white << "Average only.\n";
+		std::cout << green << "\t  [2]: " << white << "Average and the variance of every range bin.\n";
+		m_currentTerminalLine += 5;
+		menuListBar(1);
+		unsigned int variance;
+		readInput(&variance);
+
+		while (variance != 1 && variance != 2)
+		{
+			clear();
+			systemInfo();
+			std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+			std::cout << green << "\t   |-> " << yellow << "Settings.\n";
+			std::cout << green << "\t   |-> " << yellow << "Coherent integration.\n";
+			std::cout << green << "\t  [1]: " << white << "Average only.\n";
+			std::cout << green << "\t  [2]: " << white << "Average and the variance of every range bin.\n";
+			m_currentTerminalLine += 6;
+			menuListBar(1);
+			printError(variance);
+			readInput(&variance);
+		}
+		m_integrationVariance = (variance == 2) ? "Enabled" : "Disabled";
+	}
+
+	m_settingsStatusYAML = "Changed settings not saved to YAML file.";
+	settingsMenu();
+}
+
+void Interface::setRangeGate()
+{
+	clear();
+	systemInfo();
+	std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+	std::cout << green << "\t   |-> " << yellow << "Settings.\n";
+	std::cout << green << "\t   |-> " << yellow << "Range gate.\n";
+	std::cout << green << "\t  [i]: " << white << "Only the samples of every PRI inside the gate are written.\n";
+	std::cout << green << "\t  [1]: " << white << "Disabled.\n";
+	std::cout << green << "\t  [2]: " << white << "Dead zone to max range.\n";
+	std::cout << green << "\t  [3]: " << white << "Custom.\n";
+	m_currentTerminalLine += 7;
+	menuListBar(1);
+	unsigned int answer;
+	readInput(&answer);
+
+	while (answer < 1 || answer > 3)
+	{
+		clear();
+		systemInfo();
+		std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+		std::cout << green << "\t   |-> " << yellow << "Settings.\n";
+		std::cout << green << "\t   |-> " << yellow << "Range gate.\n";
+		std::cout << green << "\t  [i]: " << white << "Only the samples of every PRI inside the gate are written.\n";
+		std::cout << green << "\t  [1]: " << white << "Disabled.\n";
+		std::cout << green << "\t  [2]: " << white << "Dead zone to max range.\n";
+		std::cout << green << "\t  [3]: " << white << "Custom.\n";
+		m_currentTerminalLine += 8;
+		menuListBar(1);
+		printError(answer);
+		readInput(&answer);
+	}
+	if (answer == 1) m_rangeGate = "Disabled";
+	else if (answer == 2) m_rangeGate = "Dead zone to max range";
+	else
+	{
+		// Start and stop of the gate.
+		clear();
+		systemInfo();
+		std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+		std::cout << green << "\t   |-> " << yellow << "Settings.\n";
+		std::cout << green << "\t   |-> " << yellow << "Range gate.\n";
+		std::cout << green << "\t  [i]: " << white << "The max range is " << m_maxRangeActual << " m.\n";
+		std::cout << green << "\t  [i]: " << white << "Enter the start of the gate [m]:\n";
+		m_currentTerminalLine += 5;
+		menuListBar(1);
+		double start;
+		readInput(&start);
+
+		while (start == -1 || start < 0 || start >= m_maxRangeActual)
+		{
+			clear();
+			systemInfo();
+			std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+			std::cout << green << "\t   |-> " << yellow << "Settings.\n";
+			std::cout << green << "\t   |-> " << yellow << "Range gate.\n";
+			std::cout << green << "\t  [i]: " << white << "The max range is " << m_maxRangeActual << " m.\n";
+			std::cout << green << "\t  [i]: " << white << "Enter the start of the gate [m]:\n";
+			m_currentTerminalLine += 6;
+			menuListBar(1);
+			if (start == -1) printError(start);
+			else std::cout << red << "\t[ERROR]: " << white << "The gate cannot start at " << start << " m.\n";
+			readInput(&start);
+		}
+
+		clear();
+		systemInfo();
+		std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+		std::cout << green << "\t   |-> " << yellow << "Settings.\n";
+		std::cout << green << "\t   |-> " << yellow << "Range gate.\n";
+		std::cout << green << "\t  [i]: " << white << "The gate starts at " << start << " m.\n";
+		std::cout << green << "\t  [i]: " << white << "Enter the stop of the gate [m]:\n";
+		m_currentTerminalLine += 5;
+		menuListBar(1);
+		double stop;
+		readInput(&stop);
+
+		while (stop == -1 || stop <= start)
+		{
+			clear();
+			systemInfo();
+			std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+			std::cout << green << "\t   |-> " << yellow << "Settings.\n";
+			std::cout << green << "\t   |-> " << yellow << "Range gate.\n";
+			std::cout << green << "\t  [i]: " << white << "The gate starts at " << start << " m.\n";
+			std::cout << green << "\t  [i]: " << white << "Enter the stop of the gate [m]:\n";
+			m_currentTerminalLine += 6;
+			menuListBar(1);
+			if (stop == -1) printError(stop);
+			else std::cout << red << "\t[ERROR]: " << white << "The gate has to stop after " << start << " m.\n";
+			readInput(&stop);
+		}
+		m_rangeGate = "Custom";
+		m_rangeGateStart = start;
+		m_rangeGateStop = stop;
+	}
+
+	m_settingsStatusYAML = "Changed settings not saved to YAML file.";
+	settingsMenu();
+}
+
+void Interface::setProcessingThreads()
+{
+	// Cores kept for the RX and TX threads.
+	unsigned cores = physicalCores();
+	clear();
+	systemInfo();
+	std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+	std::cout << green << "\t   |-> " << yellow << "Settings.\n";
+	std::cout << green << "\t   |-> " << yellow << "Processing threads.\n";
+	std::cout << green << "\t  [i]: " << white << "This machine has " << cores << " physical cores, the processing does not use the reserved ones.\n";
+	std::cout << green << "\t  [i]: " << white << "Enter the cores reserved for the RX and TX threads (0 to " << cores - 1 << "):\n";
+	m_currentTerminalLine += 5;
+	menuListBar(1);
+	double reserved;
+	readInput(&reserved);
+
+	while (reserved == -1 || reserved < 0 || reserved > cores - 1 || reserved != std::floor(reserved))
+	{
+		clear();
+		systemInfo();
+		std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+		std::cout << green << "\t   |-> " << yellow << "Settings.\n";
+		std::cout << green << "\t   |-> " << yellow << "Processing threads.\n";
+		std::cout << green << "\t  [i]: " << white << "This machine has " << cores << " physical cores, the processing does not use the reserved ones.\n";
+		std::cout << green << "\t  [i]: " << white << "Enter the cores reserved for the RX and TX threads (0 to " << cores - 1 << "):\n";
+		m_currentTerminalLine += 6;
+		menuListBar(1);
+		if (reserved == -1) printError(reserved);
+		else std::cout << red << "\t[ERROR]: " << white << "Cannot reserve " << reserved << " cores.\n";
+		readInput(&reserved);
+	}
+	m_reservedCores = (unsigned)reserved;
+
+	// Threads of the executor.
+	unsigned available = cores - m_reservedCores;
+	clear();
+	systemInfo();
+	std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+	std::cout << green << "\t   |-> " << yellow << "Settings.\n";
+	std::cout << green << "\t   |-> " << yellow << "Processing threads.\n";
+	std::cout << green << "\t  [i]: " << white << available << " cores are not reserved.\n";
+	std::cout << green << "\t  [i]: " << white << "Enter the processing threads (0 uses every core that is not reserved, up to " << available << "):\n";
+	m_currentTerminalLine += 5;
+	menuListBar(1);
+	double threads;
+	readInput(&threads);
+
+	while (threads == -1 || threads < 0 || threads > available || threads != std::floor(threads))
+	{
+		clear();
+		systemInfo();
+		std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+		std::cout << green << "\t   |-> " << yellow << "Settings.\n";
+		std::cout << green << "\t   |-> " << yellow << "Processing threads.\n";
+		std::cout << green << "\t  [i]: " << white << available << " cores are not reserved.\n";
+		std::cout << green << "\t  [i]: " << white << "Enter the processing threads (0 uses every core that is not reserved, up to " << available << "):\n";
+		m_currentTerminalLine += 6;
+		menuListBar(1);
+		if (threads == -1) printError(threads);
+		else std::cout << red << "\t[ERROR]: " << white << "Cannot use " << threads << " threads.\n";
+		readInput(&threads);
+	}
+	m_processingThreads = (unsigned)threads;
+
+	// Pinning.
+	clear();
+	systemInfo();
+	std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+	std::cout << green << "\t   |-> " << yellow << "Settings.\n";
+	std::cout << green << "\t   |-> " << yellow << "Processing threads.\n";
+	std::cout << green << "\t  [1]: " << white << "Let the system place the threads.\n";
+	std::cout << green << "\t  [2]: " << white << "Pin every thread to its own core after the reserved ones.\n";
+	m_currentTerminalLine += 5;
+	menuListBar(1);
+	unsigned int pinning;
+	readInput(&pinning);
+
+	while (pinning != 1 && pinning != 2)
+	{
+		clear();
+		systemInfo();
+		std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+		std::cout << green << "\t   |-> " << yellow << "Settings.\n";
+		std::cout << green << "\t   |-> " << yellow << "Processing threads.\n";
+		std::cout << green << "\t  [1]: " << white << "Let the system place the threads.\n";
+		std::cout << green << "\t  [2]: " << white << "Pin every thread to its own core after the reserved ones.\n";
+		m_currentTerminalLine += 6;
+		menuListBar(1);
+		printError(pinning);
+		readInput(&pinning);
+	}
+	m_threadPinning = (pinning == 2) ? "Enabled" : "Disabled";
+
+	m_settingsStatusYAML = "Changed settings not saved to YAML file.";
+	settingsMenu();
+}
+
 void Interface::saveSettings() 
 {
 	clear();
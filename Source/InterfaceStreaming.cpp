@@ -4,6 +4,9 @@
 
 #include "Interface.h"				//  Class running the app.
 #include "Utils/Waveforms.h"        // Waveform generation.
+#include "Processing/Ambiguity.h"   // Reading captures.
+#include "Processing/Executor.h"    // Processing threads.
+#include <filesystem>               // Calibration directory.
 #include <chrono>                   // For time.             
 #include <time.h>                   // "
 
@@ -201,7 +204,8 @@ void Interface::setupSDR()
         throw std::runtime_error("[WAVEFORM] [ERROR]: Wave frequency is out of Nyquist zone.");
 
     // Create the transmission streamer.
-    uhd::stream_args_t stream_args(m_cpuFormat, m_overTheWire);
+    // The waveform is already in the TX CPU format, so UHD does not convert it on every send.
+    uhd::stream_args_t stream_args(m_txCpuFormat, m_overTheWire);
     stream_args.channels = tx_channel_nums;
     tx_stream = tx_usrp->get_tx_stream(stream_args);
 
@@ -314,6 +318,14 @@ void Interface::setupSDR()
 //  SDR Transmission.                                                                                                                                                               //
 // ================================================================================================================================================================================ //
 
+bool Interface::pulsedStreamStagesSupported(std::string& status) const
+{
+    // The transmitted pulse is only a matched filter or pulse grid for fc32 RX samples at the TX rate.
+    if (m_txSource == "Pulsed" && m_cpuFormat == "fc32" && m_pulseLengthSamples && m_rxSamplingFrequencyActual == m_txSamplingFrequencyActual) return true;
+    status = "Not run, needs a pulsed TX, fc32 RX and equal TX and RX rates";
+    return false;
+}
+
 void Interface::startTransmission()
 {
     // reset usrp time to prepare for transmit/receive
@@ -324,28 +336,132 @@ void Interface::startTransmission()
     std::cout << blue << "[SDR] [BUFFERS]: " << red;
     tx_usrp->set_time_now(uhd::time_spec_t(0.0));
 
+    // The processing threads keep off the cores of the RX and TX threads.  Nothing runs on the
+    // executor between captures, so it can be replaced here.
+    ExecutorParameters executor;
+    executor.threads = m_processingThreads;
+    executor.reservedCores = m_reservedCores;
+    executor.pinning = m_threadPinning;
+    Executor::configure(executor);
+
     // The default buffer size in the Ettus example is 20 400 samples.
     // It is the max number of samples of the buffer times 10.  I do not 
     // know why they use this number, but for now it is going to be
     // used in this code.
     // Adjust the max number so that the waves fit in perfectly.
+    // A wave longer than the max is sent one at a time.
     size_t maxBufferSize = 20400;
-    size_t wavesPerBuffer = std::floor(maxBufferSize / m_waveLengthSamples);
+    size_t wavesPerBuffer = std::max((size_t)1, maxBufferSize / m_waveLengthSamples);
     size_t bufferSize = wavesPerBuffer * m_waveLengthSamples;
+    // The dechirp runs on a continuous stream, so the RX buffers do not follow the ramp period.
+    size_t rxBufferSize = (m_txSource == "FMCW") ? maxBufferSize : bufferSize;
 
     // ----------------------- //
     //  T R A N S M I T T E R  //
     // ----------------------- //
 
     // Start transmit worker thread
-    std::thread transmit_thread([&]() { Interface::transmitBuffer(m_transmissionWave, tx_stream, md, wavesPerBuffer); });
+    std::thread transmit_thread([&]()
+    {
+        if (m_txSource == "CW tone") Interface::transmitTone(tx_stream, md, bufferSize);
+        else Interface::transmitBuffer(m_transmissionWaveSC16, tx_stream, md, wavesPerBuffer);
+    });
 
     // ------------------------- //
     //  R E C E I V E   F I L E  //
     // ------------------------- //
 
+    // The matched filter is the pulse that is transmitted, which only matches the RX samples
+    // when they are fc32 and at the TX rate.  Compressed samples go next to the raw ones.
+    std::unique_ptr<StreamingCompressor> compressor;
+    std::string compressedFile = "Disabled";
+    if (m_streamingCompression == "Enabled")
+    {
+        if (pulsedStreamStagesSupported(compressedFile))
+        {
+            compressedFile = m_targetFileName;
+            compressedFile.erase(compressedFile.length() - 4, 4);
+            compressedFile += (m_streamingMTI == "Disabled") ? "_compressed.bin" : "_mti.bin";
+            StreamingParameters streaming;
+            streaming.mti = m_streamingMTI;
+            std::span<const std::complex<float>> pulse(m_transmissionWave.data(), m_pulseLengthSamples);
+            compressor = std::make_unique<StreamingCompressor>(pulse, m_waveLengthSamples, m_folderName + "\\" + compressedFile, streaming);
+            if (!compressor->isOpen()) { compressor.reset(); compressedFile = "Not saved"; }
+        }
+    }
+
+    // The range gate keeps a window of every PRI, from the pulse grid it synchronises to on the
+    // first PRIs of the capture.  The gate is in RX samples, so it needs equal TX and RX rates.
+    std::unique_ptr<RangeGateStage> gate;
+    std::string gating = "Disabled";
+    double gateStart = 0, gateStop = 0;
+    if (m_rangeGate != "Disabled")
+    {
+        if (pulsedStreamStagesSupported(gating))
+        {
+            gateStart = (m_rangeGate == "Custom") ? m_rangeGateStart : m_deadzoneActual;
+            gateStop = (m_rangeGate == "Custom") ? m_rangeGateStop : m_maxRangeActual;
+            RangeGate window = rangeGateFromRanges(gateStart, gateStop, m_rxSamplingFrequencyActual, m_waveLengthSamples, m_pulseLengthSamples);
+            if (window.valid())
+            {
+                std::span<const std::complex<float>> pulse(m_transmissionWave.data(), m_pulseLengthSamples);
+                gate = std::make_unique<RangeGateStage>(window, pulse);
+                gating = m_rangeGate;
+            }
+            else gating = "Not run, the gate is outside the PRI";
+        }
+    }
+
+    // FMCW is dechirped against the transmitted ramp, and only the beats of the echoes up to the
+    // max range are kept, decimated.  The ramp is the reference, so it needs equal TX and RX rates.
+    std::unique_ptr<DechirpStage> dechirp;
+    std::string dechirping = "Disabled";
+    double sweepRate = 0;
+    if (m_txSource == "FMCW")
+    {
+        dechirping = "Not run, needs fc32 RX and equal TX and RX rates";
+        if (m_cpuFormat == "fc32" && m_rxSamplingFrequencyActual == m_txSamplingFrequencyActual)
+        {
+            size_t sweepSamples = (m_fmcwRamp == "Triangle") ? m_waveLengthSamples / 2 : m_waveLengthSamples;
+            sweepRate = m_waveBandwidth * m_txSamplingFrequencyActual / sweepSamples;
+            size_t decimation = dechirpDecimation(m_rxSamplingFrequencyActual, beatFrequency(sweepRate, m_maxRangeActual), sweepSamples);
+            dechirp = std::make_unique<DechirpStage>(m_transmissionWave, decimation);
+            dechirping = dechirp->describe();
+        }
+    }
+
+    // With coherent integration the target file gets the averaged PRIs instead of every sample.
     std::string file = m_folderName + "\\" + m_targetFileName;
-    receiveBufferToFile(rx_usrp, file, bufferSize, total_num_samps, settling);
+    std::unique_ptr<CoherentIntegrator> integrator;
+    std::string integration = "Disabled";
+    if (m_integrationPRIs)
+    {
+        integration = "Not run, needs fc32 RX";
+        if (m_cpuFormat == "fc32")
+        {
+            // A gated PRI only holds the gated samples, a dechirped sweep the decimated ones.
+            integrator = std::make_unique<CoherentIntegrator>(gate ? gate->gate().count : dechirp ? dechirp->periodSamples() : m_waveLengthSamples, m_integrationPRIs, m_integrationVariance == "Enabled", file);
+            integration = std::to_string(m_integrationPRIs) + " PRIs per record, " + ((m_integrationVariance == "Enabled") ? "average and variance" : "average");
+        }
+    }
+    // The dechirp reference starts at the first sample of the ramp, so the RX stream starts on
+    // a ramp, a whole number of periods after the TX start.  The fixed delay of the TX and RX
+    // chains is left, it shows as a constant range offset.
+    double rxStart = -1;
+    if (dechirp)
+    {
+        double period = m_transmissionWaveSC16.size() / m_txSamplingFrequencyActual;
+        double txStart = md.time_spec.get_real_secs();
+        double earliest = std::max(rx_usrp->get_time_now().get_real_secs() + settling, txStart);
+        rxStart = txStart + std::ceil((earliest - txStart) / period) * period;
+    }
+    receiveBufferToFile(rx_usrp, file, rxBufferSize, total_num_samps, settling, compressor.get(), integrator.get(), gate.get(), dechirp.get(), rxStart);
+    if (dechirp) dechirping += ", " + std::to_string(dechirp->samplesOut()) + " of " + std::to_string(dechirp->samplesIn()) + " samples kept";
+    if (integrator)
+    {
+        integrator->finish();
+        integration += ", " + std::to_string(integrator->records()) + " records";
+    }
 
     // --------------- //
     //  C L E A N U P  //
@@ -355,6 +471,29 @@ void Interface::startTransmission()
     m_stopSignalCalled = true;
     transmit_thread.join();
 
+    // Compress what the workers have not reached yet.
+    if (compressor)
+    {
+        std::cout << blue << "\n[SDR] [INFO]: " << white << "Finishing pulse compression on " << compressor->threads() << " threads...";
+        compressor->finish();
+        if (compressor->samplesDropped()) compressedFile += ", " + std::to_string(compressor->samplesDropped()) + " of " + std::to_string(compressor->samplesWritten()) + " samples dropped";
+    }
+
+    // Keep the exact transmitted waveform with the capture.  The file is named by its checksum,
+    // so captures that transmitted the same waveform share one file.
+    std::string waveformFile = "None (CW tone)";
+    if (m_txSource != "CW tone")
+    {
+        char checksum[32];
+        snprintf(checksum, sizeof(checksum), "%016llx", (unsigned long long)waveformChecksum(m_transmissionWaveSC16.data(), m_transmissionWaveSC16.size() * sizeof(std::complex<int16_t>)));
+        waveformFile = "Waveforms\\" + std::string(checksum) + ".wfm";
+        std::error_code error;
+        std::filesystem::create_directories(m_folderName + "\\Waveforms", error);
+        if (!std::filesystem::exists(m_folderName + "\\" + waveformFile) &&
+            !writeWaveformFile(m_folderName + "\\" + waveformFile, m_transmissionWaveSC16, m_txSamplingFrequencyActual, m_pulseLengthSamples, m_waveformKey.describe()))
+            waveformFile = "Not saved";
+    }
+
     std::cout << blue << "\n[SDR] [INFO]: " << white << "Transmission complete.\n";
     std::cout << green << "[APP] [INFO]: " << white << "Add a transmission note:\n";
     // Remove .bin extension and add .txt.
@@ -373,12 +512,41 @@ void Interface::startTransmission()
     noteFile << "TX error: " << m_txError << "\n";
     noteFile << "RX error: " << m_rxError << "\n";
     noteFile << "OTW format: " << m_overTheWire << "\n";
-    noteFile << "CPU format: " << m_cpuFormat << "\n\n";
+    noteFile << "CPU format: " << m_cpuFormat << "\n";
+    noteFile << "TX CPU format: " << m_txCpuFormat << "\n";
+    noteFile << "TX source: " << m_txSource;
+    if (m_txSource == "CW tone") noteFile << " (" << m_toneFrequency / 1e6 << " MHz offset)";
+    if (m_txSource == "FMCW") noteFile << " (" << m_fmcwRamp << ", " << m_fmcwSweepTime * 1e3 << " ms period)";
+    noteFile << "\n";
+    noteFile << "TX predistortion: " << m_predistortion << ", " << m_predistortionStatus << "\n";
+    noteFile << "TX level: " << m_txNormalisation << " -" << m_txBackoff << " dBFS, dither " << m_txDither << "\n";
+    noteFile << "Waveform file: " << waveformFile << "\n";
+    noteFile << "Compressed file: " << compressedFile << "\n";
+    noteFile << "Streaming MTI: " << m_streamingMTI << "\n";
+    noteFile << "Processing threads: " << Executor::shared().threads() << ", " << m_reservedCores << " cores reserved, pinning " << m_threadPinning << "\n";
+    noteFile << "Coherent integration: " << integration << "\n";
+    noteFile << "Dechirp: " << dechirping << "\n";
+    noteFile << "Range gate: " << gating;
+    if (gate)
+    {
+        const PulseGridSync& grid = gate->sync();
+        noteFile << ", " << gateStart << " m to " << gateStop << " m, " << gate->gate().describe() << "\n";
+        noteFile << "Range gate grid: first PRI at sample " << grid.offset << ", ";
+        if (grid.found) noteFile << "synchronised (" << grid.contrast << " dB contrast)";
+        else noteFile << "pulse not found, grid assumed to start the capture";
+    }
+    noteFile << "\n";
+    noteFile << "Pulse profile: " << m_pulseProfile << ", " << m_pulseProfileStatus << "\n\n";
     noteFile <<   "The data is packed as I Q I Q samples." <<
                 "\nEach sample size is given by the CPU format." <<
                 "\nOTW format is not required for parsing the .bin file, " <<
                 "\nsince this describes how data is transferred on the SDR." <<
                 "\nThe .bin file does not contain any type of headers, it is just IQ samples.\n";
+    if (integrator) noteFile << "With coherent integration every record is the average PRI (fc32), followed by the variance of every sample (f32) when it is kept.\n";
+    if (dechirp) noteFile << "With FMCW the file holds the dechirped beat signal at " << m_rxSamplingFrequencyActual / dechirp->decimation() / 1e6 << " MSps, " << dechirp->periodSamples() << " samples per ramp period," <<
+                             "\na beat of f Hz is the echo from " << 299792458 / (2 * sweepRate) << " * |f| m (negative beats on up ramps, positive on down ramps).\n";
+    if (gate) noteFile << "With a range gate every PRI holds samples " << gate->gate().first << " to " << gate->gate().first + gate->gate().count - 1 << " after the start of the pulse only," <<
+                          "\nsample n of a PRI is the echo of the pulse from " << 299792458 / (2 * m_rxSamplingFrequencyActual) << " * (n + " << gate->gate().first << ") m.\n";
     noteFile << "\n---------------------------------------------------------------------------------------\n";
     noteFile << "|                               Radar Settings                                        |\n";
     noteFile << "---------------------------------------------------------------------------------------\n\n";
@@ -415,6 +583,90 @@ void Interface::startTransmission()
     m_rxError = "None";
 }
 
+// ================================================================================================================================================================================ //
+//  Predistortion calibration.                                                                                                                                                      //
+// ================================================================================================================================================================================ //
+
+void Interface::calibratePredistortion()
+{
+    clear();
+    systemInfo();
+    std::cout << green << "\n\n[APP] [INFO]: " << yellow << "TX predistortion calibration.\n";
+    if (m_sdrInfo != "SDR is connected.")
+    {
+        std::cout << red << "[APP] [ERROR]: " << white << "Set up the SDR before calibrating.\n";
+        std::cout << green << "[APP] [INPUT]: " << white << "Enter any key to continue.";
+        hold();
+        return;
+    }
+    if (m_rxSamplingFrequencyActual != m_txSamplingFrequencyActual)
+    {
+        std::cout << red << "[APP] [ERROR]: " << white << "The TX and RX sampling rates have to be the same.\n";
+        std::cout << green << "[APP] [INPUT]: " << white << "Enter any key to continue.";
+        hold();
+        return;
+    }
+    std::cout << green << "[APP] [INFO]: " << white << "Connect TX to RX with a cable and enough attenuation to keep the RX linear.\n";
+    std::cout << green << "[APP] [INFO]: " << white << "The correction is calibrated for " << PredistortionKey{ m_txFreqActual, m_txSamplingFrequencyActual, m_txGainActual }.describe() << ".\n";
+    std::cout << green << "\t  [1]: " << white << "Start.\n";
+    std::cout << green << "\t  [0]: " << white << "Cancel.\n";
+    unsigned int answer;
+    readInput(&answer);
+    if (answer != 1) return;
+
+    // The pulse is transmitted without the old correction.
+    std::string predistortion = m_predistortion;
+    m_predistortion = "Disabled";
+    generateTransmissionPusle();
+
+    // ----------------- //
+    //  L O O P B A C K  //
+    // ----------------- //
+
+    // Capture a few PRIs more than are averaged, the first is skipped as a transient.
+    size_t calibrationPRIs = 64;
+    size_t maxBufferSize = 20400;
+    size_t wavesPerBuffer = std::max((size_t)1, maxBufferSize / m_waveLengthSamples);
+    size_t bufferSize = wavesPerBuffer * m_waveLengthSamples;
+    size_t captureSamples = (calibrationPRIs + 3) * m_waveLengthSamples;
+    std::string directory = settingsDirectory() + "Predistortion";
+    std::filesystem::create_directories(directory);
+    std::string file = directory + "\\loopback.bin";
+
+    std::cout << blue << "\n[SDR] [INFO]: " << white << "Capturing the loopback...\n";
+    tx_usrp->set_time_now(uhd::time_spec_t(0.0));
+    std::thread transmit_thread([&]() { Interface::transmitBuffer(m_transmissionWaveSC16, tx_stream, md, wavesPerBuffer); });
+    receiveBufferToFile(rx_usrp, file, bufferSize, captureSamples, settling);
+    m_stopSignalCalled = true;
+    transmit_thread.join();
+    m_stopSignalCalled = false;
+
+    // ----------------- //
+    //  E S T I M A T E  //
+    // ----------------- //
+
+    std::vector<std::complex<float>> capture = readPulseFile(file);
+    Predistortion correction = estimatePredistortion(m_transmissionWave, m_pulseLengthSamples, capture);
+    m_predistortion = predistortion;
+    if (correction.empty())
+    {
+        std::cout << red << "[APP] [ERROR]: " << white << "The pulse was not found in the capture (RX error: " << m_rxError << ").\n";
+        m_rxError = "None";
+    }
+    else
+    {
+        correction.key = { m_txFreqActual, m_txSamplingFrequencyActual, m_txGainActual };
+        m_predistortionCorrection = correction;
+        bool saved = savePredistortion(correction, directory);
+        std::cout << green << "[APP] [INFO]: " << white << "TX chain ripple: " << correction.ripple << " dB, RMS phase error: " << correction.phaseError << " deg.\n";
+        if (saved) std::cout << green << "[APP] [INFO]: " << white << "Correction saved to " << directory << ".\n";
+        else std::cout << red << "[APP] [ERROR]: " << white << "Could not save the correction to " << directory << ".\n";
+    }
+    generateTransmissionPusle();
+    std::cout << green << "[APP] [INPUT]: " << white << "Enter any key to continue.";
+    hold();
+}
+
 // ================================================================================================================================================================================ //
 //  Reception.  	                                                                                                                                                                //
 // ================================================================================================================================================================================ //
@@ -423,7 +675,12 @@ void Interface::receiveBufferToFile(uhd::usrp::multi_usrp::sptr usrp,
                                     const std::string& file,
                                     size_t samps_per_buff,
                                     int num_requested_samples,
-                                    double settling_time)
+                                    double settling_time,
+                                    StreamingCompressor* compressor,
+                                    CoherentIntegrator* integrator,
+                                    RangeGateStage* gate,
+                                    DechirpStage* dechirp,
+                                    double startTime)
 {
     // ----------- //
     //  S E T U P  //
@@ -438,23 +695,33 @@ void Interface::receiveBufferToFile(uhd::usrp::multi_usrp::sptr usrp,
     std::vector<std::complex<float>> receiveBuffer(samps_per_buff);
     // Receive buffer pointer.
     std::complex<float>* receiveBufferPtr = &receiveBuffer.front();
+    // Gated samples of the buffer.
+    std::vector<std::complex<float>> gatedBuffer;
+    // Dechirped and decimated samples of the buffer.
+    std::vector<std::complex<float>> dechirpedBuffer;
 
     // Create offstream object for reception.
-    std::shared_ptr<std::ofstream> outfile = std::make_shared<std::ofstream>(file, std::ofstream::binary);
+    // Not opened when integrating, the integrator writes the file.
+    std::shared_ptr<std::ofstream> outfile;
+    if (!integrator) outfile = std::make_shared<std::ofstream>(file, std::ofstream::binary);
 
     // Error handling.
     bool overflow_message = true;
 
+    // Without a start time the stream starts once the settling time has passed.
+    uhd::time_spec_t now = usrp->get_time_now();
+    uhd::time_spec_t start = (startTime < 0) ? now + uhd::time_spec_t(settling_time) : uhd::time_spec_t(startTime);
+
     // We increase the first timeout to cover for the delay between now + the
     // command time, plus 500ms of buffer. In the loop, we will then reduce the
     // timeout for subsequent receives.
-    double timeout = settling_time + 1.f;
+    double timeout = (start - now).get_real_secs() + 1.f;
 
     // Issue stream command.
     uhd::stream_cmd_t stream_cmd(uhd::stream_cmd_t::STREAM_MODE_NUM_SAMPS_AND_DONE);
     stream_cmd.num_samps = num_requested_samples;
     stream_cmd.stream_now = false;
-    stream_cmd.time_spec = usrp->get_time_now() + uhd::time_spec_t(settling_time);
+    stream_cmd.time_spec = start;
     rx_stream->issue_stream_cmd(stream_cmd);
 
     // ------------------- //
@@ -478,26 +745,50 @@ void Interface::receiveBufferToFile(uhd::usrp::multi_usrp::sptr usrp,
         if (rxMD.error_code != uhd::rx_metadata_t::ERROR_CODE_NONE) { throw std::runtime_error(str(boost::format("Receiver error %s") % rxMD.strerror())); m_rxError = rxMD.strerror(); }
 
         totalReceivedSamples += currentReceivedSamples;
-        outfile->write((const char*)receiveBufferPtr, currentReceivedSamples * sizeof(std::complex<float>));
+        std::span<const std::complex<float>> samples(receiveBufferPtr, currentReceivedSamples);
+        // Only copies the samples, the compression runs on the workers.
+        if (compressor) compressor->push(samples);
+        // Only the decimated beats are stored.
+        if (dechirp)
+        {
+            dechirp->process(samples, dechirpedBuffer);
+            samples = dechirpedBuffer;
+        }
+        // The gate holds the first PRIs back until it has synchronised to them.
+        if (gate)
+        {
+            gate->process(samples, gatedBuffer);
+            samples = gatedBuffer;
+        }
+        if (integrator) integrator->push(samples);
+        else outfile->write((const char*)samples.data(), samples.size() * sizeof(std::complex<float>));
+    }
+
+    // A capture shorter than the PRIs the gate synchronises on.
+    if (gate)
+    {
+        gate->finish(gatedBuffer);
+        if (integrator) integrator->push(gatedBuffer);
+        else outfile->write((const char*)gatedBuffer.data(), gatedBuffer.size() * sizeof(std::complex<float>));
     }
 
     // Close file.
-    outfile->close();
+    if (outfile) outfile->close();
 }
 
 // ================================================================================================================================================================================ //
 //  Transmission.	                                                                                                                                                                //
 // ================================================================================================================================================================================ //
 
-void Interface::transmitBuffer(std::vector<std::complex<float>> transmitWave,
+void Interface::transmitBuffer(std::vector<std::complex<int16_t>> transmitWave,
                                uhd::tx_streamer::sptr tx_streamer,
                                uhd::tx_metadata_t metadata,
                                size_t wavesPerBuffer)
 {
     // Generate a larger buffer that contains the waveform.
-    std::vector<std::complex<float>> waveBuffer;
+    std::vector<std::complex<int16_t>> waveBuffer;
     for (int i = 0; i < wavesPerBuffer; i++) { waveBuffer.insert(waveBuffer.end(), transmitWave.begin(), transmitWave.end()); }
-    std::complex<float>* bufferPtr = &waveBuffer.front();
+    std::complex<int16_t>* bufferPtr = &waveBuffer.front();
     // Transmit the data until the stop signal is called.
     while (not m_stopSignalCalled)
     {
@@ -511,6 +802,30 @@ void Interface::transmitBuffer(std::vector<std::complex<float>> transmitWave,
     tx_streamer->send("", 0, metadata);
 }
 
+void Interface::transmitTone(uhd::tx_streamer::sptr tx_streamer,
+                             uhd::tx_metadata_t metadata,
+                             size_t bufferSize)
+{
+    // The tone sits at the TX DAC level, the DDS interpolates so the tone is not limited to
+    // frequencies that divide the table.
+    wave_table_class dds("SINE", std::pow(10.f, -m_txBackoff / 20.f));
+    dds.set_interpolation(true);
+    uint64_t phaseIncrement = wave_table_class::get_phase_increment(m_toneFrequency, m_txSamplingFrequencyActual);
+    std::vector<std::complex<int16_t>> toneBuffer(bufferSize);
+    // Transmit the data until the stop signal is called.
+    while (not m_stopSignalCalled)
+    {
+        // The phase carries over, so consecutive buffers are continuous.
+        dds.fill(std::span(toneBuffer), phaseIncrement);
+        tx_streamer->send(toneBuffer.data(), toneBuffer.size(), metadata);
+        metadata.start_of_burst = false;
+        metadata.has_time_spec = false;
+    }
+    // Send an End-Of-Burst packet.
+    metadata.end_of_burst = true;
+    tx_streamer->send("", 0, metadata);
+}
+
 // ================================================================================================================================================================================ //
 //  EOF.	                                                                                                                                                                        //
 // ================================================================================================================================================================================ //
\ No newline at end of file
@@ -4,6 +4,12 @@
 
 #include "Interface.h"
 #include "Utils/Waveforms.h"
+#include "Utils/ComplexKernels.h"
+#include "Processing/Ambiguity.h"
+#include <sstream>
+#include <span>
+#include <algorithm>
+#include <filesystem>
 
 // ================================================================================================================================================================================ //
 //  Menu.                                                                                                                                                                           //
@@ -20,14 +26,18 @@ void Interface::waveFormMenu()
 	std::cout << green << "\t  [3]: " << white << "Radar dead zone range.\n";
 	std::cout << green << "\t  [4]: " << white << "Radar transmission time.\n";
 	std::cout << green << "\t  [5]: " << white << "Window function.\n";
+	std::cout << green << "\t  [6]: " << white << "TX source.\n";
+	std::cout << green << "\t  [7]: " << white << "Ambiguity analysis.\n";
+	std::cout << green << "\t  [8]: " << white << "TX predistortion.\n";
+	std::cout << green << "\t  [9]: " << white << "Waveform file.\n";
 	std::cout << green << "\t  [0]: " << white << "Return.\n";
-	m_currentTerminalLine += 8;
+	m_currentTerminalLine += 12;
 	menuListBar(1);
 	unsigned int answer;
 	readInput(&answer);
 
 	// Handle errors.
-	while (answer < 0 || answer > 4)
+	while (answer < 0 || answer > 9)
 	{
 		clear();
 		systemInfo();
@@ -38,8 +48,12 @@ void Interface::waveFormMenu()
 		std::cout << green << "\t  [3]: " << white << "Radar dead zone range.\n";
 		std::cout << green << "\t  [4]: " << white << "Radar transmission time.\n";
 		std::cout << green << "\t  [5]: " << white << "Window function.\n";
+		std::cout << green << "\t  [6]: " << white << "TX source.\n";
+		std::cout << green << "\t  [7]: " << white << "Ambiguity analysis.\n";
+		std::cout << green << "\t  [8]: " << white << "TX predistortion.\n";
+		std::cout << green << "\t  [9]: " << white << "Waveform file.\n";
 		std::cout << green << "\t  [0]: " << white << "Return.\n";
-		m_currentTerminalLine += 9;
+		m_currentTerminalLine += 13;
 		menuListBar(1);
 		printError(answer);
 		readInput(&answer);
@@ -62,6 +76,18 @@ void Interface::waveFormMenu()
 	case 5:
 		setPulseWaveform();
 		break;
+	case 6:
+		setTxSource();
+		break;
+	case 7:
+		analyseAmbiguity();
+		break;
+	case 8:
+		predistortionMenu();
+		break;
+	case 9:
+		setWaveformFile();
+		break;
 	case 0:
 		break;
 	}
@@ -185,12 +211,16 @@ void Interface::setPulseWaveform()
 	std::cout << green << "\t  [1]: " << white << "None.\n";
 	std::cout << green << "\t  [2]: " << white << "Blackman.\n";
 	std::cout << green << "\t  [3]: " << white << "Hamming.\n";
+	std::cout << green << "\t  [4]: " << white << "Kaiser.\n";
+	std::cout << green << "\t  [5]: " << white << "Taylor.\n";
+	std::cout << green << "\t  [6]: " << white << "Dolph-Chebyshev.\n";
+	std::cout << green << "\t  [7]: " << white << "Tukey.\n";
 	std::cout << green << "\t  [0]: " << white << "Return.\n";
-	m_currentTerminalLine += 9;
+	m_currentTerminalLine += 13;
 	menuListBar(1);
 	double answer;
 	readInput(&answer);
-	while (answer > 3 || answer < 0)
+	while (answer > 7 || answer < 0)
 	{
 		clear();
 		systemInfo();
@@ -202,20 +232,66 @@ void Interface::setPulseWaveform()
 		std::cout << green << "\t  [1]: " << white << "None.\n";
 		std::cout << green << "\t  [2]: " << white << "Blackman.\n";
 		std::cout << green << "\t  [3]: " << white << "Hamming.\n";
+		std::cout << green << "\t  [4]: " << white << "Kaiser.\n";
+		std::cout << green << "\t  [5]: " << white << "Taylor.\n";
+		std::cout << green << "\t  [6]: " << white << "Dolph-Chebyshev.\n";
+		std::cout << green << "\t  [7]: " << white << "Tukey.\n";
 		std::cout << green << "\t  [0]: " << white << "Return.\n";
-		m_currentTerminalLine += 10;
+		m_currentTerminalLine += 14;
 		menuListBar(1);
 		printError(answer);
 		readInput(&answer);
 	}
 	m_settingsStatusSDR = "Changed settings not uploaded to SDR.";
 	m_settingsStatusYAML = "Changed settings not saved to YAML file.";
-	if (answer == 1) m_windowFunction = "None";
-	else if (answer == 2) m_windowFunction = "Blackman";
-	else if (answer == 3) m_windowFunction = "Hamming";
+	if (answer == 0) { waveFormMenu(); return; }
+	m_windowFunction = windowTypes()[(unsigned)answer - 1];
+	// The windows with a shape parameter ask for it.
+	if (answer >= 4) setWindowParameter();
 	waveFormMenu();
 }
 
+void Interface::setWindowParameter()
+{
+	// Describe the parameter of the selected window.
+	std::string description;
+	float* parameter;
+	if (m_windowFunction == "Kaiser")			{ description = "Kaiser shape parameter, beta (0 - 20):\n"; parameter = &m_windowParameters.kaiserBeta; }
+	else if (m_windowFunction == "Tukey")		{ description = "Tukey taper fraction, alpha (0 - 1):\n"; parameter = &m_windowParameters.tukeyAlpha; }
+	else										{ description = "Sidelobe level below the mainlobe [dB] (13 - 120):\n"; parameter = &m_windowParameters.sidelobeLevel; }
+	float min = (m_windowFunction == "Kaiser" || m_windowFunction == "Tukey") ? 0 : 13;
+	float max = (m_windowFunction == "Kaiser") ? 20 : (m_windowFunction == "Tukey") ? 1 : 120;
+
+	clear();
+	systemInfo();
+	std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+	std::cout << green << "\t   |-> " << yellow << "Waveform.\n";
+	std::cout << green << "\t   |-> " << yellow << "Window function.\n";
+	std::cout << green << "\t   |-> " << yellow << m_windowFunction << ".\n";
+	std::cout << green << "\t  [i]: " << white << "Current value: " << *parameter << "\n";
+	std::cout << green << "\t  [i]: " << white << description;
+	m_currentTerminalLine += 6;
+	menuListBar(1);
+	double answer;
+	readInput(&answer);
+	while (answer < min || answer > max)
+	{
+		clear();
+		systemInfo();
+		std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+		std::cout << green << "\t   |-> " << yellow << "Waveform.\n";
+		std::cout << green << "\t   |-> " << yellow << "Window function.\n";
+		std::cout << green << "\t   |-> " << yellow << m_windowFunction << ".\n";
+		std::cout << green << "\t  [i]: " << white << "Current value: " << *parameter << "\n";
+		std::cout << green << "\t  [i]: " << white << description;
+		m_currentTerminalLine += 7;
+		menuListBar(1);
+		std::cout << red << "\t[ERROR]: " << white << "The value has to be between " << min << " and " << max << ".\n";
+		readInput(&answer);
+	}
+	*parameter = answer;
+}
+
 void Interface::calculatePulsesPerTX()
 {
 	// Now calculate the amount of pulses that are transmitted with each transmission cycle.
@@ -231,9 +307,9 @@ void Interface::setWaveType()
 	std::cout << green << "\t   |-> " << yellow << "Wave type.\n";
 	std::cout << green << "\t  [i]: " << white << "The waveform that is transmitted.\n";
 	std::cout << green << "\t  [i]: " << white << "Select the waveform:\n";
-	std::cout << green << "\t  [1]: " << white << "Linear Frequency Chirp.\n";
-	std::cout << green << "\t  [2]: " << white << "Non-Linear Frequency Chirp.\n";
-	std::cout << green << "\t  [3]: " << white << "Constant sine.\n";
+	std::cout << green << "\t  [1]: " << white << linearChirpWave << ".\n";
+	std::cout << green << "\t  [2]: " << white << nonLinearChirpWave << ".\n";
+	std::cout << green << "\t  [3]: " << white << constantSineWave << ".\n";
 	std::cout << green << "\t  [0]: " << white << "Return.\n";
 	m_currentTerminalLine += 9;
 	menuListBar(1);
@@ -248,9 +324,9 @@ void Interface::setWaveType()
 		std::cout << green << "\t   |-> " << yellow << "Wave type.\n";
 		std::cout << green << "\t  [i]: " << white << "The waveform that is transmitted.\n";
 		std::cout << green << "\t  [i]: " << white << "Select the waveform:\n";
-		std::cout << green << "\t  [1]: " << white << "Linear Frequency Chirp.\n";
-		std::cout << green << "\t  [2]: " << white << "Non-Linear Frequency Chirp.\n";
-		std::cout << green << "\t  [3]: " << white << "Constant sine.\n";
+		std::cout << green << "\t  [1]: " << white << linearChirpWave << ".\n";
+		std::cout << green << "\t  [2]: " << white << nonLinearChirpWave << ".\n";
+		std::cout << green << "\t  [3]: " << white << constantSineWave << ".\n";
 		std::cout << green << "\t  [0]: " << white << "Return.\n";
 		m_currentTerminalLine += 10;
 		menuListBar(1);
@@ -259,35 +335,537 @@ void Interface::setWaveType()
 	}
 	m_settingsStatusSDR = "Changed settings not uploaded to SDR.";
 	m_settingsStatusYAML = "Changed settings not saved to YAML file.";
-	if (answer == 1) m_waveType = "Linear Frequency Chirp";
-	else if (answer == 2) m_waveType = "Non-Linear Frequency Chirp";
-	else if (answer == 3) m_waveType = "Constant sine";
-	else if (answer == 4) m_waveType = "Hamming";
+	if (answer == 1) m_waveType = linearChirpWave;
+	else if (answer == 2) m_waveType = nonLinearChirpWave;
+	else if (answer == 3) m_waveType = constantSineWave;
+	waveFormMenu();
+}
+
+void Interface::setTxSource()
+{
+	clear();
+	systemInfo();
+	std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+	std::cout << green << "\t   |-> " << yellow << "Waveform.\n";
+	std::cout << green << "\t   |-> " << yellow << "TX source.\n";
+	std::cout << green << "\t  [i]: " << white << "Current source: " << m_txSource << "\n";
+	std::cout << green << "\t  [1]: " << white << "Pulsed (the generated waveform).\n";
+	std::cout << green << "\t  [2]: " << white << "CW tone (continuous test tone from the DDS).\n";
+	std::cout << green << "\t  [3]: " << white << "FMCW (continuous ramps, dechirped while receiving).\n";
+	std::cout << green << "\t  [0]: " << white << "Return.\n";
+	m_currentTerminalLine += 8;
+	menuListBar(1);
+	unsigned int answer;
+	readInput(&answer);
+
+	while (answer < 0 || answer > 3)
+	{
+		clear();
+		systemInfo();
+		std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+		std::cout << green << "\t   |-> " << yellow << "Waveform.\n";
+		std::cout << green << "\t   |-> " << yellow << "TX source.\n";
+		std::cout << green << "\t  [i]: " << white << "Current source: " << m_txSource << "\n";
+		std::cout << green << "\t  [1]: " << white << "Pulsed (the generated waveform).\n";
+		std::cout << green << "\t  [2]: " << white << "CW tone (continuous test tone from the DDS).\n";
+		std::cout << green << "\t  [3]: " << white << "FMCW (continuous ramps, dechirped while receiving).\n";
+		std::cout << green << "\t  [0]: " << white << "Return.\n";
+		m_currentTerminalLine += 9;
+		menuListBar(1);
+		printError(answer);
+		readInput(&answer);
+	}
+	if (answer == 0) { waveFormMenu(); return; }
+	m_settingsStatusYAML = "Changed settings not saved to YAML file.";
+	// The FMCW ramp replaces the pulse, so the waveform has to be generated again.
+	if (answer == 3 || m_txSource == "FMCW") m_settingsStatusSDR = "Changed settings not uploaded to SDR.";
+	if (answer == 1) { m_txSource = "Pulsed"; waveFormMenu(); return; }
+	if (answer == 3) { setFMCW(); return; }
+	m_txSource = "CW tone";
+
+	// Tone frequency, relative to the carrier.
+	double nyquist = m_txSamplingFrequencyActual / 2e6;
+	clear();
+	systemInfo();
+	std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+	std::cout << green << "\t   |-> " << yellow << "Waveform.\n";
+	std::cout << green << "\t   |-> " << yellow << "TX source.\n";
+	std::cout << green << "\t  [i]: " << white << "Offsets above " << nyquist << " MHz wrap around to negative offsets.\n";
+	std::cout << green << "\t  [i]: " << white << "Enter the tone offset from the TX carrier [MHz]:\n";
+	m_currentTerminalLine += 5;
+	menuListBar(1);
+	double offset;
+	readInput(&offset);
+
+	while (offset == -1 || offset < 0 || offset > 2 * nyquist)
+	{
+		clear();
+		systemInfo();
+		std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+		std::cout << green << "\t   |-> " << yellow << "Waveform.\n";
+		std::cout << green << "\t   |-> " << yellow << "TX source.\n";
+		std::cout << green << "\t  [i]: " << white << "Offsets above " << nyquist << " MHz wrap around to negative offsets.\n";
+		std::cout << green << "\t  [i]: " << white << "Enter the tone offset from the TX carrier [MHz]:\n";
+		m_currentTerminalLine += 6;
+		menuListBar(1);
+		if (offset == -1) printError(offset);
+		else std::cout << red << "\t[ERROR]: " << white << "A tone offset of " << offset << " MHz is not supported.\n";
+		readInput(&offset);
+	}
+	m_toneFrequency = offset * 1e6;
+	waveFormMenu();
+}
+
+void Interface::setFMCW()
+{
+	// Ramp shape.
+	clear();
+	systemInfo();
+	std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+	std::cout << green << "\t   |-> " << yellow << "Waveform.\n";
+	std::cout << green << "\t   |-> " << yellow << "TX source.\n";
+	std::cout << green << "\t   |-> " << yellow << "FMCW.\n";
+	std::cout << green << "\t  [i]: " << white << "Current ramp: " << m_fmcwRamp << ", " << m_fmcwSweepTime * 1e3 << " ms.\n";
+	std::cout << green << "\t  [1]: " << white << "Sawtooth (up ramps).\n";
+	std::cout << green << "\t  [2]: " << white << "Triangle (up and down ramps, the range rate follows from the two beats).\n";
+	m_currentTerminalLine += 8;
+	menuListBar(1);
+	unsigned int answer;
+	readInput(&answer);
+
+	while (answer < 1 || answer > 2)
+	{
+		clear();
+		systemInfo();
+		std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+		std::cout << green << "\t   |-> " << yellow << "Waveform.\n";
+		std::cout << green << "\t   |-> " << yellow << "TX source.\n";
+		std::cout << green << "\t   |-> " << yellow << "FMCW.\n";
+		std::cout << green << "\t  [i]: " << white << "Current ramp: " << m_fmcwRamp << ", " << m_fmcwSweepTime * 1e3 << " ms.\n";
+		std::cout << green << "\t  [1]: " << white << "Sawtooth (up ramps).\n";
+		std::cout << green << "\t  [2]: " << white << "Triangle (up and down ramps, the range rate follows from the two beats).\n";
+		m_currentTerminalLine += 9;
+		menuListBar(1);
+		printError(answer);
+		readInput(&answer);
+	}
+	m_fmcwRamp = (answer == 1) ? "Sawtooth" : "Triangle";
+
+	// Period of the ramp.  The echo of the max range has to be much shorter than a sweep, the
+	// beat only exists while the echo and the ramp overlap.  A period is one TX buffer and the
+	// dechirp reference, so it is kept to 100 ms and to the TX duration.
+	double shortest = 10 * 2 * m_maxRange / c * 1e3;
+	double longest = std::max(shortest, std::min(100.0, m_txDuration * 1e3));
+	clear();
+	systemInfo();
+	std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+	std::cout << green << "\t   |-> " << yellow << "Waveform.\n";
+	std::cout << green << "\t   |-> " << yellow << "TX source.\n";
+	std::cout << green << "\t   |-> " << yellow << "FMCW.\n";
+	std::cout << green << "\t  [i]: " << white << "At least ten times the echo delay of the max range, " << shortest << " ms, at most " << longest << " ms.\n";
+	std::cout << green << "\t  [i]: " << white << "Enter the period of the ramp [ms]:\n";
+	m_currentTerminalLine += 6;
+	menuListBar(1);
+	double period;
+	readInput(&period);
+
+	while (period == -1 || period <= 0 || period < shortest || period > longest)
+	{
+		clear();
+		systemInfo();
+		std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+		std::cout << green << "\t   |-> " << yellow << "Waveform.\n";
+		std::cout << green << "\t   |-> " << yellow << "TX source.\n";
+		std::cout << green << "\t   |-> " << yellow << "FMCW.\n";
+		std::cout << green << "\t  [i]: " << white << "At least ten times the echo delay of the max range, " << shortest << " ms, at most " << longest << " ms.\n";
+		std::cout << green << "\t  [i]: " << white << "Enter the period of the ramp [ms]:\n";
+		m_currentTerminalLine += 7;
+		menuListBar(1);
+		if (period == -1) printError(period);
+		else if (period < shortest) std::cout << red << "\t[ERROR]: " << white << "A period of " << period << " ms is too short for the max range.\n";
+		else std::cout << red << "\t[ERROR]: " << white << "A period of " << period << " ms is too long.\n";
+		readInput(&period);
+	}
+	m_txSource = "FMCW";
+	m_fmcwSweepTime = period * 1e-3;
+	waveFormMenu();
+}
+
+void Interface::setWaveformFile()
+{
+	clear();
+	systemInfo();
+	std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+	std::cout << green << "\t   |-> " << yellow << "Waveform.\n";
+	std::cout << green << "\t   |-> " << yellow << "Waveform file.\n";
+	std::cout << green << "\t  [i]: " << white << "Current file: " << (m_waveformFile.size() ? m_waveformFile : "None (waveform is generated)") << "\n";
+	std::cout << green << "\t  [i]: " << white << "Enter the path to a .wfm file, or 'None' to generate the waveform:\n";
+	m_currentTerminalLine += 5;
+	menuListBar(1);
+	std::string path;
+	readInput(&path);
+
+	while (path != "None" && !std::filesystem::is_regular_file(path))
+	{
+		clear();
+		systemInfo();
+		std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+		std::cout << green << "\t   |-> " << yellow << "Waveform.\n";
+		std::cout << green << "\t   |-> " << yellow << "Waveform file.\n";
+		std::cout << green << "\t  [i]: " << white << "Current file: " << (m_waveformFile.size() ? m_waveformFile : "None (waveform is generated)") << "\n";
+		std::cout << green << "\t  [i]: " << white << "Enter the path to a .wfm file, or 'None' to generate the waveform:\n";
+		m_currentTerminalLine += 6;
+		menuListBar(1);
+		std::cout << red << "\t[ERROR]: " << white << "The file '" << path << "' does not exist.\n";
+		readInput(&path);
+	}
+	m_settingsStatusSDR = "Changed settings not uploaded to SDR.";
+	m_settingsStatusYAML = "Changed settings not saved to YAML file.";
+	m_waveformFile = (path == "None") ? "" : path;
 	waveFormMenu();
 }
 
 void Interface::generateTransmissionPusle() 
 {
 	// Calculate wave samples.
-	m_waveLengthSamples = std::round((m_maxRange * 2 / c) * m_txSamplingFrequencyActual);
-	m_maxRangeActual = ((m_waveLengthSamples / 2) / m_txSamplingFrequencyActual) * c;
-	m_pulseLengthSamples = std::round((m_deadzone * 2 / c) * m_txSamplingFrequencyActual);
-	// Ensure wave samples is uneven.
-	if (m_pulseLengthSamples % 2 == 0) { m_pulseLengthSamples++; }
-	m_deadzoneActual = (m_pulseLengthSamples / 2 / m_txSamplingFrequencyActual) * c;
+	bool fmcw = m_txSource == "FMCW";
+	if (fmcw)
+	{
+		// The ramp fills the whole period, there is no dead zone.  The halves of a triangle are
+		// equally long.
+		m_waveLengthSamples = std::round(m_fmcwSweepTime * m_txSamplingFrequencyActual);
+		if (m_fmcwRamp == "Triangle" && m_waveLengthSamples % 2) { m_waveLengthSamples++; }
+		m_pulseLengthSamples = m_waveLengthSamples;
+		m_maxRangeActual = m_maxRange;
+		m_deadzoneActual = 0;
+	}
+	else
+	{
+		m_waveLengthSamples = std::round((m_maxRange * 2 / c) * m_txSamplingFrequencyActual);
+		m_maxRangeActual = ((m_waveLengthSamples / 2) / m_txSamplingFrequencyActual) * c;
+		m_pulseLengthSamples = std::round((m_deadzone * 2 / c) * m_txSamplingFrequencyActual);
+		// Ensure wave samples is uneven.
+		if (m_pulseLengthSamples % 2 == 0) { m_pulseLengthSamples++; }
+		m_deadzoneActual = (m_pulseLengthSamples / 2 / m_txSamplingFrequencyActual) * c;
+	}
 	m_waveAmplitude = 1;
 	m_waveBandwidth = m_txSamplingFrequencyActual / 2.1;    // Nyquist.
+	// A waveform file replaces the generated wave and sets the pulse and PRI lengths.
+	bool fromFile = !fmcw && m_waveformFile.size() && loadWaveformFile();
+	// A standard profile fixes the pulse, its compiled table replaces the generator.
+	const PulseProfile* profile = (fromFile || fmcw) ? nullptr : selectPulseProfile();
+	if (fmcw) m_pulseProfileStatus = "Not used with FMCW.";
 	// Update total samples.
 	total_num_samps = m_txDuration * m_txSamplingFrequencyActual;
 	m_txDurationActual = std::floor((total_num_samps / m_waveLengthSamples)) * m_waveLengthSamples / m_txSamplingFrequencyActual;
 	total_num_samps = m_txDurationActual * m_txSamplingFrequencyActual;
-	// Generate the transmission wave.
-	if (m_waveType == "Linear Frequency Chirp") m_transmissionWave = generateLinearChirp(m_pulseLengthSamples, m_waveBandwidth, m_waveAmplitude, m_txSamplingFrequencyActual, m_windowFunction);
-	else if (m_waveType == "Non Linear Frequency Chirp") m_transmissionWave = generateNonLinearChirp(m_pulseLengthSamples, m_txSamplingFrequencyActual / 2.5, m_waveAmplitude, m_txSamplingFrequencyActual, m_windowFunction);
-	else if (m_waveType == "Constant Sine") m_transmissionWave = generateConstSine(m_pulseLengthSamples, m_txSamplingFrequencyActual / 2.5, m_waveAmplitude, m_txSamplingFrequencyActual, m_windowFunction);
-	else { std::cout << red << "[ERROR]: " << white << "Wave type '" << m_waveType << "' not supported.\n"; hold(); }
-	std::vector<std::complex<float>> zeros(m_waveLengthSamples - m_pulseLengthSamples, 0);
-	m_transmissionWave.insert(m_transmissionWave.end(), zeros.begin(), zeros.end());
+	bool predistorted = false;
+	if (!fromFile)
+	{
+		// Describe the waveform so that it can be found in the cache.
+		WaveformKey key;
+		// A window would modulate the continuous FMCW ramp, it is only applied to pulses.  A profile
+		// brings its own type and window, the user's settings are kept for when it is switched off.
+		key.type = fmcw ? "FMCW " + m_fmcwRamp : profile ? profile->waveType : m_waveType;
+		key.pulseSamples = m_pulseLengthSamples;
+		key.priSamples = m_waveLengthSamples;
+		key.bandwidth = profile ? profile->bandwidth : (m_waveType == linearChirpWave || fmcw) ? m_waveBandwidth : m_txSamplingFrequencyActual / 2.5;
+		key.samplingFreq = m_txSamplingFrequencyActual;
+		key.window = fmcw ? "None" : profile ? profile->window : m_windowFunction;
+		key.windowParameters = m_windowParameters;
+		key.amplitude = m_waveAmplitude;
+		key.format = m_txCpuFormat;
+		std::ostringstream scaling;
+		scaling << m_txNormalisation << " -" << m_txBackoff << " dBFS" << ((m_txDither == "Enabled") ? ", dither" : "");
+		key.scaling = scaling.str();
+		// Find the predistortion calibrated for the current carrier, rate and gain.
+		bool predistort = false;
+		if (m_predistortion == "Enabled")
+		{
+			PredistortionKey predistortionKey = { m_txFreqActual, m_txSamplingFrequencyActual, m_txGainActual };
+			if (m_predistortionCorrection.empty() || m_predistortionCorrection.key.fileName() != predistortionKey.fileName())
+				if (!loadPredistortion(predistortionKey, settingsDirectory() + "Predistortion", m_predistortionCorrection)) m_predistortionCorrection = Predistortion();
+			predistort = predistorted = !m_predistortionCorrection.empty();
+			if (predistort) key.predistortion = m_predistortionCorrection.id();
+			m_predistortionStatus = predistort ? "Applied." : "Not calibrated for " + predistortionKey.describe() + ".";
+		}
+		else m_predistortionStatus = "Not applied.";
+		// Only generate the wave if it has not been generated before.
+		CacheResult cacheResult = m_waveformCache.fetch(key, m_transmissionWaveSC16);
+		if (cacheResult == CacheResult::MemoryHit) m_waveCacheStatus = "Hit (memory).";
+		else if (cacheResult == CacheResult::DiskHit) m_waveCacheStatus = "Hit (disk).";
+		else
+		{
+			// Generate the transmission wave.  Without dither or predistortion it is generated directly in
+			// sc16, scaled by a gain measured from the pulse, otherwise it is generated in fc32, filtered by
+			// the predistortion and quantised once.
+			bool generated;
+			m_transmissionWaveSC16.assign(m_waveLengthSamples, std::complex<int16_t>(0, 0));
+			std::span<std::complex<int16_t>> pulse(m_transmissionWaveSC16.data(), std::min(m_pulseLengthSamples, m_waveLengthSamples));
+			if (m_txDither == "Disabled" && !predistort)
+			{
+				WaveLevel level = profile ? profile->level() : measureWave(key.type, (int)pulse.size(), key.bandwidth, m_waveAmplitude, m_txSamplingFrequencyActual, key.window, m_windowParameters);
+				float gain = dacGain(level, m_txBackoff, m_txNormalisation);
+				if (profile) { copyPulseProfile(*profile, pulse, gain); generated = true; }
+				else generated = generateWave(pulse, key.type, key.bandwidth, m_waveAmplitude, m_txSamplingFrequencyActual, key.window, m_windowParameters, gain);
+			}
+			else
+			{
+				m_transmissionWave.assign(m_waveLengthSamples, std::complex<float>(0, 0));
+				if (profile) { copyPulseProfile(*profile, std::span(m_transmissionWave).first(pulse.size())); generated = true; }
+				else generated = generateWave(std::span(m_transmissionWave).first(pulse.size()), key.type, key.bandwidth, m_waveAmplitude, m_txSamplingFrequencyActual, key.window, m_windowParameters);
+				if (predistort) applyPredistortion(m_transmissionWave, (unsigned)pulse.size(), m_predistortionCorrection);
+				m_transmissionWaveSC16 = convertToSC16(m_transmissionWave, (int)pulse.size(), m_txBackoff, m_txNormalisation, m_txDither == "Enabled");
+			}
+			if (generated) m_waveformCache.store(key, m_transmissionWaveSC16);
+			else hold();
+			// Report what invalidated the previous waveform.
+			std::string changed = key.differences(m_waveformKey);
+			if (m_waveformKey.type.empty()) m_waveCacheStatus = "Miss, waveform generated.";
+			else if (changed.size()) m_waveCacheStatus = "Miss, waveform regenerated (changed: " + changed + ").";
+			else m_waveCacheStatus = "Miss, waveform regenerated.";
+		}
+		m_waveformKey = key;
+	}
+	// The processing reference is exactly what is sent to the DAC.
+	m_transmissionWave.resize(m_transmissionWaveSC16.size());
+	for (size_t n = 0; n < m_transmissionWaveSC16.size(); n++)
+		m_transmissionWave[n] = std::complex<float>(m_transmissionWaveSC16[n].real() / 32767.f, m_transmissionWaveSC16[n].imag() / 32767.f);
+	// Except with predistortion: the DAC gets the pulse filtered by the correction, with its tails
+	// wrapped around the PRI, but the TX chain undoes the correction and the echo is the pulse
+	// itself.  The reference is then the pulse without the correction, at the energy of the sent wave.
+	if (predistorted)
+	{
+		std::vector<std::complex<float>> reference(m_transmissionWave.size(), std::complex<float>(0, 0));
+		std::span<std::complex<float>> pulse = std::span(reference).first(std::min((size_t)m_pulseLengthSamples, reference.size()));
+		bool generated = true;
+		if (profile) copyPulseProfile(*profile, pulse);
+		else generated = generateWave(pulse, m_waveformKey.type, m_waveformKey.bandwidth, m_waveAmplitude, m_txSamplingFrequencyActual, m_waveformKey.window, m_windowParameters);
+		double sent = complexPowerSum(m_transmissionWave), generatedPower = complexPowerSum(reference);
+		if (generated && generatedPower > 0)
+		{
+			float scale = (float)std::sqrt(sent / generatedPower);
+			for (std::complex<float>& sample : reference) sample *= scale;
+			m_transmissionWave = std::move(reference);
+		}
+	}
+}
+
+const PulseProfile* Interface::selectPulseProfile()
+{
+	if (m_pulseProfile == "None") { m_pulseProfileStatus = "Not used."; return nullptr; }
+	const PulseProfile* profile = findPulseProfile(m_pulseProfile);
+	std::string problem;
+	if (!profile)																		problem = pulseProfiles().empty() ? "profiles are not compiled into this build" : "unknown profile";
+	else if (std::abs((double)profile->samplingFreq - m_txSamplingFrequencyActual) > 1)	problem = "the TX rate is not " + std::to_string(profile->samplingFreq / 1000000) + " MSps";
+	else verifyPulseProfile(*profile, problem);
+	if (problem.size())
+	{
+		m_pulseProfileStatus = "Not applied, " + problem + ".";
+		std::cout << red << "\n[WAVEFORM] [ERROR]: " << white << "Pulse profile '" << m_pulseProfile << "' not used, " << problem << ".  The waveform is generated instead.\n";
+		return nullptr;
+	}
+
+	// The profile determines the pulse, the PRI still follows the max range.
+	m_pulseLengthSamples = profile->pulseSamples;
+	m_deadzoneActual = (m_pulseLengthSamples / 2 / m_txSamplingFrequencyActual) * c;
+	m_pulseProfileStatus = "Applied (" + m_pulseProfile + ", " + profile->waveType + ", window " + profile->window + ").";
+	return profile;
+}
+
+bool Interface::loadWaveformFile()
+{
+	MappedWaveform file(m_waveformFile);
+	std::string problem;
+	if (!file.isOpen())																		problem = file.error();
+	else if (!file.verify())																problem = "the checksum does not match the samples";
+	else if (std::abs(file.header().samplingFreq - m_txSamplingFrequencyActual) > 1)		problem = "it is sampled at " + std::to_string(file.header().samplingFreq / 1e6) + " MSps";
+	else if (file.header().pulseSamples > file.header().priSamples)							problem = "the pulse is longer than the PRI";
+	if (problem.size())
+	{
+		std::cout << red << "\n[WAVEFORM] [ERROR]: " << white << "Waveform file '" << m_waveformFile << "' not used, " << problem << ".  The waveform is generated instead.\n";
+		return false;
+	}
+
+	// sc16 files are sent as they are, fc32 files are quantised with the current TX level.
+	const WaveformFileHeader& header = file.header();
+	if (file.format() == "sc16")
+	{
+		std::span<const std::complex<int16_t>> samples = file.samples<std::complex<int16_t>>();
+		m_transmissionWaveSC16.assign(samples.begin(), samples.end());
+	}
+	else
+	{
+		std::span<const std::complex<float>> samples = file.samples<std::complex<float>>();
+		m_transmissionWaveSC16 = convertToSC16(std::vector<std::complex<float>>(samples.begin(), samples.end()), (int)header.pulseSamples, m_txBackoff, m_txNormalisation, m_txDither == "Enabled");
+	}
+
+	// The file determines the pulse and the PRI.
+	m_waveLengthSamples = (unsigned)header.priSamples;
+	m_pulseLengthSamples = (unsigned)header.pulseSamples;
+	m_maxRangeActual = ((m_waveLengthSamples / 2) / m_txSamplingFrequencyActual) * c;
+	m_deadzoneActual = (m_pulseLengthSamples / 2 / m_txSamplingFrequencyActual) * c;
+	char checksum[32];
+	snprintf(checksum, sizeof(checksum), "%016llx", (unsigned long long)header.checksum);
+	WaveformKey key;
+	key.type = std::string("File ") + checksum;
+	key.pulseSamples = m_pulseLengthSamples;
+	key.priSamples = m_waveLengthSamples;
+	key.samplingFreq = (float)header.samplingFreq;
+	key.format = m_txCpuFormat;
+	std::ostringstream scaling;
+	scaling << m_txNormalisation << " -" << m_txBackoff << " dBFS" << ((m_txDither == "Enabled") ? ", dither" : "");
+	key.scaling = (file.format() == "sc16") ? "As stored" : scaling.str();
+	m_waveformKey = key;
+	m_waveCacheStatus = "Not used, waveform loaded from file.";
+	m_predistortionStatus = "Not applied (waveform file).";
+	return true;
+}
+
+// ================================================================================================================================================================================ //
+//  Analysis.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+void Interface::analyseAmbiguity()
+{
+	clear();
+	systemInfo();
+	std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+	std::cout << green << "\t   |-> " << yellow << "Waveform.\n";
+	std::cout << green << "\t   |-> " << yellow << "Ambiguity analysis.\n";
+	std::cout << green << "\t  [1]: " << white << "Current pulse.\n";
+	std::cout << green << "\t  [2]: " << white << "Pulse from a file (raw fc32 samples).\n";
+	std::cout << green << "\t  [0]: " << white << "Return.\n";
+	m_currentTerminalLine += 6;
+	menuListBar(1);
+	unsigned int answer;
+	readInput(&answer);
+
+	while (answer < 0 || answer > 2)
+	{
+		clear();
+		systemInfo();
+		std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+		std::cout << green << "\t   |-> " << yellow << "Waveform.\n";
+		std::cout << green << "\t   |-> " << yellow << "Ambiguity analysis.\n";
+		std::cout << green << "\t  [1]: " << white << "Current pulse.\n";
+		std::cout << green << "\t  [2]: " << white << "Pulse from a file (raw fc32 samples).\n";
+		std::cout << green << "\t  [0]: " << white << "Return.\n";
+		m_currentTerminalLine += 7;
+		menuListBar(1);
+		printError(answer);
+		readInput(&answer);
+	}
+	if (answer == 0) { waveFormMenu(); return; }
+
+	// Get the pulse.
+	std::vector<std::complex<float>> pulse;
+	std::string description;
+	std::string name;
+	if (answer == 1)
+	{
+		pulse.assign(m_transmissionWave.begin(), m_transmissionWave.begin() + std::min((size_t)m_pulseLengthSamples, m_transmissionWave.size()));
+		description = m_waveformKey.describe();
+		std::ostringstream hash;
+		hash << std::hex << m_waveformKey.hash();
+		name = hash.str();
+	}
+	else
+	{
+		std::cout << green << "\t  [i]: " << white << "Enter the path of the pulse file:\n";
+		std::string path;
+		readInput(&path);
+		pulse = readPulseFile(path);
+		description = path;
+		name = std::filesystem::path(path).stem().string();
+	}
+	if (pulse.empty())
+	{
+		std::cout << red << "\n[APP] [ERROR]: " << white << "There is no pulse to analyse.\n";
+		std::cout << green << "[APP] [INPUT]: " << white << "Enter any key to continue.";
+		hold();
+		waveFormMenu();
+		return;
+	}
+
+	// Doppler span.
+	std::cout << green << "\t  [i]: " << white << "Enter the max Doppler shift [kHz] (0 for a quarter of the sampling frequency):\n";
+	double maxDoppler;
+	readInput(&maxDoppler);
+	while (maxDoppler == -1 || maxDoppler < 0)
+	{
+		std::cout << red << "\t[ERROR]: " << white << "Enter a positive Doppler shift.\n";
+		readInput(&maxDoppler);
+	}
+
+	// Analyse and export.
+	std::cout << green << "\n[APP] [INFO]: " << white << "Computing the ambiguity surface of " << pulse.size() << " samples...\n";
+	AmbiguityParameters parameters;
+	parameters.maxDoppler = maxDoppler * 1e3;
+	AmbiguitySurface surface = computeAmbiguity(pulse, m_txSamplingFrequencyActual, parameters);
+	const AmbiguityMetrics& metrics = surface.metrics;
+	std::cout << green << "[APP] [INFO]: " << white << "PSLR: " << metrics.pslr << " dB, ISLR: " << metrics.islr << " dB.\n";
+	std::cout << green << "[APP] [INFO]: " << white << "Mainlobe width: " << metrics.mainlobeWidth * 1e9 << " ns (-3 dB), " << metrics.mainlobeNullWidth * 1e9 << " ns (null to null).\n";
+	std::cout << green << "[APP] [INFO]: " << white << "Doppler tolerance: " << (metrics.dopplerToleranceFound ? "" : "> ") << metrics.dopplerTolerance << " Hz.\n";
+	std::cout << green << "[APP] [INFO]: " << white << "Analysed in " << metrics.analysisTime << " s.\n";
+	std::string basePath = m_folderName + "\\AMBIGUITY_" + name;
+	if (exportAmbiguity(surface, basePath, description)) std::cout << green << "[APP] [INFO]: " << white << "Surface and metrics written to " << basePath << ".\n";
+	else std::cout << red << "[APP] [ERROR]: " << white << "Could not write to " << basePath << ".\n";
+	std::cout << green << "[APP] [INPUT]: " << white << "Enter any key to continue.";
+	hold();
+	waveFormMenu();
+}
+
+void Interface::predistortionMenu()
+{
+	clear();
+	systemInfo();
+	std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+	std::cout << green << "\t   |-> " << yellow << "Waveform.\n";
+	std::cout << green << "\t   |-> " << yellow << "TX predistortion.\n";
+	std::cout << green << "\t  [i]: " << white << "Predistortion is " << m_predistortion << ", " << m_predistortionStatus << "\n";
+	if (!m_predistortionCorrection.empty())
+		std::cout << green << "\t  [i]: " << white << "Calibrated TX chain: " << m_predistortionCorrection.ripple << " dB ripple, " << m_predistortionCorrection.phaseError << " deg RMS phase error.\n";
+	std::cout << green << "\t  [1]: " << white << "Toggle predistortion.\n";
+	std::cout << green << "\t  [2]: " << white << "Calibrate from a loopback capture.\n";
+	std::cout << green << "\t  [0]: " << white << "Return.\n";
+	m_currentTerminalLine += 7 + !m_predistortionCorrection.empty();
+	menuListBar(1);
+	unsigned int answer;
+	readInput(&answer);
+
+	while (answer < 0 || answer > 2)
+	{
+		clear();
+		systemInfo();
+		std::cout << green << "\n\n[APP] [INFO]: " << yellow << "Main Menu:\n";
+		std::cout << green << "\t   |-> " << yellow << "Waveform.\n";
+		std::cout << green << "\t   |-> " << yellow << "TX predistortion.\n";
+		std::cout << green << "\t  [i]: " << white << "Predistortion is " << m_predistortion << ", " << m_predistortionStatus << "\n";
+		if (!m_predistortionCorrection.empty())
+			std::cout << green << "\t  [i]: " << white << "Calibrated TX chain: " << m_predistortionCorrection.ripple << " dB ripple, " << m_predistortionCorrection.phaseError << " deg RMS phase error.\n";
+		std::cout << green << "\t  [1]: " << white << "Toggle predistortion.\n";
+		std::cout << green << "\t  [2]: " << white << "Calibrate from a loopback capture.\n";
+		std::cout << green << "\t  [0]: " << white << "Return.\n";
+		m_currentTerminalLine += 8 + !m_predistortionCorrection.empty();
+		menuListBar(1);
+		printError(answer);
+		readInput(&answer);
+	}
+
+	if (answer == 1)
+	{
+		m_predistortion = (m_predistortion == "Enabled") ? "Disabled" : "Enabled";
+		m_settingsStatusYAML = "Changed settings not saved to YAML file.";
+		generateTransmissionPusle();
+		predistortionMenu();
+	}
+	else if (answer == 2)
+	{
+		calibratePredistortion();
+		predistortionMenu();
+	}
+	else waveFormMenu();
 }
 
 // ================================================================================================================================================================================ //
@@ -16,14 +16,7 @@ HMODULE getCurrentModule();
 
 void Interface::saveToYAML()
 {
-    // Find the path to the exe.
-    TCHAR pathWindows[100];
-    GetModuleFileNameA(getCurrentModule(), pathWindows, 100);
-    std::string path = pathWindows;
-    std::string toErase = "EttusB210-Interface.exe";
-    size_t pos = path.find(toErase);
-    path.erase(pos, toErase.length());
-    path = path + "Settings\\Settings.yml";
+    std::string path = settingsDirectory() + "Settings.yml";
 
     // Open the yaml file.
     std::ofstream yamlFile;
@@ -70,8 +63,28 @@ void Interface::saveToYAML()
     radarOut << YAML::Value << m_deadzone;
     radarOut << YAML::Key << "window-function";
     radarOut << YAML::Value << m_windowFunction;
+    radarOut << YAML::Key << "window-kaiser-beta";
+    radarOut << YAML::Value << m_windowParameters.kaiserBeta;
+    radarOut << YAML::Key << "window-taylor-nbar";
+    radarOut << YAML::Value << m_windowParameters.taylorNBar;
+    radarOut << YAML::Key << "window-sidelobe-level";
+    radarOut << YAML::Value << m_windowParameters.sidelobeLevel;
+    radarOut << YAML::Key << "window-tukey-alpha";
+    radarOut << YAML::Value << m_windowParameters.tukeyAlpha;
     radarOut << YAML::Key << "wave-type";
     radarOut << YAML::Value << m_waveType;
+    radarOut << YAML::Key << "tx-source";
+    radarOut << YAML::Value << m_txSource;
+    radarOut << YAML::Key << "tone-frequency";
+    radarOut << YAML::Value << m_toneFrequency;
+    radarOut << YAML::Key << "fmcw-ramp";
+    radarOut << YAML::Value << m_fmcwRamp;
+    radarOut << YAML::Key << "fmcw-sweep-time";
+    radarOut << YAML::Value << m_fmcwSweepTime;
+    radarOut << YAML::Key << "waveform-file";
+    radarOut << YAML::Value << m_waveformFile;
+    radarOut << YAML::Key << "pulse-profile";
+    radarOut << YAML::Value << m_pulseProfile;
     radarOut << YAML::EndMap;
     yamlFile << radarOut.c_str();
 
@@ -95,6 +108,34 @@ void Interface::saveToYAML()
     sdrOut << YAML::Value << m_txBWTarget;
     sdrOut << YAML::Key << "filter-bandwidth-rx";
     sdrOut << YAML::Value << m_rxBWTarget;
+    sdrOut << YAML::Key << "tx-backoff";
+    sdrOut << YAML::Value << m_txBackoff;
+    sdrOut << YAML::Key << "tx-normalisation";
+    sdrOut << YAML::Value << m_txNormalisation;
+    sdrOut << YAML::Key << "tx-dither";
+    sdrOut << YAML::Value << m_txDither;
+    sdrOut << YAML::Key << "tx-predistortion";
+    sdrOut << YAML::Value << m_predistortion;
+    sdrOut << YAML::Key << "streaming-compression";
+    sdrOut << YAML::Value << m_streamingCompression;
+    sdrOut << YAML::Key << "streaming-mti";
+    sdrOut << YAML::Value << m_streamingMTI;
+    sdrOut << YAML::Key << "integration-pris";
+    sdrOut << YAML::Value << m_integrationPRIs;
+    sdrOut << YAML::Key << "integration-variance";
+    sdrOut << YAML::Value << m_integrationVariance;
+    sdrOut << YAML::Key << "range-gate";
+    sdrOut << YAML::Value << m_rangeGate;
+    sdrOut << YAML::Key << "range-gate-start";
+    sdrOut << YAML::Value << m_rangeGateStart;
+    sdrOut << YAML::Key << "range-gate-stop";
+    sdrOut << YAML::Value << m_rangeGateStop;
+    sdrOut << YAML::Key << "processing-threads";
+    sdrOut << YAML::Value << m_processingThreads;
+    sdrOut << YAML::Key << "reserved-cores";
+    sdrOut << YAML::Value << m_reservedCores;
+    sdrOut << YAML::Key << "thread-pinning";
+    sdrOut << YAML::Value << m_threadPinning;
     sdrOut << YAML::EndMap;
     yamlFile << sdrOut.c_str();
 
@@ -124,14 +165,7 @@ void Interface::saveToYAML()
 
 void Interface::loadFromYAML()
 {
-    // Find the path to the exe.
-    TCHAR pathWindows[100];
-    GetModuleFileNameA(getCurrentModule(), pathWindows, 100);
-    std::string path = pathWindows;
-    std::string toErase = "EttusB210-Interface.exe";
-    size_t pos = path.find(toErase);
-    path.erase(pos, toErase.length());
-    path = path + "Settings\\Settings.yml";
+    std::string path = settingsDirectory() + "Settings.yml";
 
     // Load the YAML file.
     YAML::Node yamlFile = YAML::LoadFile(path);
@@ -146,7 +180,18 @@ void Interface::loadFromYAML()
     m_txDuration                = std::stof(yamlFile["tx-duration"].as<std::string>());
     m_deadzone                  = std::stof(yamlFile["dead-zone"].as<std::string>());
     m_windowFunction            = yamlFile["window-function"].as<std::string>();
-    m_waveType                  = yamlFile["wave-type"].as<std::string>();
+    // Window parameters fall back to the defaults for older settings files.
+    m_windowParameters.kaiserBeta       = yamlFile["window-kaiser-beta"].as<float>(m_windowParameters.kaiserBeta);
+    m_windowParameters.taylorNBar       = yamlFile["window-taylor-nbar"].as<unsigned>(m_windowParameters.taylorNBar);
+    m_windowParameters.sidelobeLevel    = yamlFile["window-sidelobe-level"].as<float>(m_windowParameters.sidelobeLevel);
+    m_windowParameters.tukeyAlpha       = yamlFile["window-tukey-alpha"].as<float>(m_windowParameters.tukeyAlpha);
+    m_waveType                  = canonicalWaveType(yamlFile["wave-type"].as<std::string>());
+    m_txSource                  = yamlFile["tx-source"].as<std::string>(m_txSource);
+    m_toneFrequency             = yamlFile["tone-frequency"].as<double>(m_toneFrequency);
+    m_fmcwRamp                  = yamlFile["fmcw-ramp"].as<std::string>(m_fmcwRamp);
+    m_fmcwSweepTime             = yamlFile["fmcw-sweep-time"].as<double>(m_fmcwSweepTime);
+    m_waveformFile              = yamlFile["waveform-file"].as<std::string>(m_waveformFile);
+    m_pulseProfile              = yamlFile["pulse-profile"].as<std::string>(m_pulseProfile);
     // Load SDR settings.
     m_txSamplingFrequencyTarget = yamlFile["sample-rate-tx"].as<float>();
     m_rxSamplingFrequencyTarget = yamlFile["sample-rate-rx"].as<float>();
@@ -156,6 +201,20 @@ void Interface::loadFromYAML()
     m_rxGainTarget              = yamlFile["gain-rx"].as<double>();
     m_txBWTarget                = yamlFile["filter-bandwidth-tx"].as<double>();
     m_rxBWTarget                = yamlFile["filter-bandwidth-rx"].as<double>();
+    m_txBackoff                 = yamlFile["tx-backoff"].as<float>(m_txBackoff);
+    m_txNormalisation           = yamlFile["tx-normalisation"].as<std::string>(m_txNormalisation);
+    m_txDither                  = yamlFile["tx-dither"].as<std::string>(m_txDither);
+    m_predistortion             = yamlFile["tx-predistortion"].as<std::string>(m_predistortion);
+    m_streamingCompression      = yamlFile["streaming-compression"].as<std::string>(m_streamingCompression);
+    m_streamingMTI              = yamlFile["streaming-mti"].as<std::string>(m_streamingMTI);
+    m_integrationPRIs           = yamlFile["integration-pris"].as<unsigned>(m_integrationPRIs);
+    m_integrationVariance       = yamlFile["integration-variance"].as<std::string>(m_integrationVariance);
+    m_rangeGate                 = yamlFile["range-gate"].as<std::string>(m_rangeGate);
+    m_rangeGateStart            = yamlFile["range-gate-start"].as<double>(m_rangeGateStart);
+    m_rangeGateStop             = yamlFile["range-gate-stop"].as<double>(m_rangeGateStop);
+    m_processingThreads         = yamlFile["processing-threads"].as<unsigned>(m_processingThreads);
+    m_reservedCores             = yamlFile["reserved-cores"].as<unsigned>(m_reservedCores);
+    m_threadPinning             = yamlFile["thread-pinning"].as<std::string>(m_threadPinning);
     // Load device settings.
     ref                         = yamlFile["clock-ref"].as<std::string>();
     tx_channels                 = yamlFile["channels-tx"].as<std::string>();
@@ -186,6 +245,18 @@ void Interface::loadFromYAML()
 }
 
 
+std::string Interface::settingsDirectory()
+{
+    // Find the path to the exe.
+    TCHAR pathWindows[100];
+    GetModuleFileNameA(getCurrentModule(), pathWindows, 100);
+    std::string path = pathWindows;
+    std::string toErase = "EttusB210-Interface.exe";
+    size_t pos = path.find(toErase);
+    path.erase(pos, toErase.length());
+    return path + "Settings\\";
+}
+
 // Get the current windows module.
 HMODULE getCurrentModule()
 {
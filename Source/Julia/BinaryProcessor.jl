@@ -0,0 +1,42 @@
+# Modules.
+using Mmap
+
+# Reads a waveform file (.wfm) written by the interface, see Source/Utils/WaveformFile.h.
+# The samples are memory mapped, so the transmitted waveform is used as is and not regenerated.
+# Returns the header fields and the samples as complex values.
+function loadWaveform(filepath)
+    io = open(filepath, "r")
+    # Header.
+    magic = String(read(io, 8))
+    magic == "B210WFM1" || error("$filepath is not a waveform file.")
+    version = read(io, UInt32)
+    headerSize = read(io, UInt32)
+    format = rstrip(String(read(io, 8)), '\0')
+    sampleSize = read(io, UInt32)
+    read(io, UInt32)
+    samplingFreq = read(io, Float64)
+    pulseSamples = Int(read(io, UInt64))
+    priSamples = Int(read(io, UInt64))
+    dataOffset = Int(read(io, UInt64))
+    checksum = read(io, UInt64)
+    generator = rstrip(String(read(io, 184)), '\0')
+    # Samples.
+    if format == "sc16"
+        samples = Mmap.mmap(io, Vector{Complex{Int16}}, priSamples, dataOffset)
+    elseif format == "fc32"
+        samples = Mmap.mmap(io, Vector{ComplexF32}, priSamples, dataOffset)
+    else
+        error("Sample format $format is not supported.")
+    end
+    close(io)
+    return (samplingFreq = samplingFreq, pulseSamples = pulseSamples, priSamples = priSamples,
+            format = format, checksum = checksum, generator = generator, samples = samples)
+end
+
+# The waveform as Float32 samples with sc16 scaled to ±1, as used by the processing in the interface.
+function waveformReference(waveform)
+    if waveform.format == "sc16"
+        return ComplexF32.(waveform.samples) ./ 32767
+    end
+    return ComplexF32.(waveform.samples)
+end
@@ -0,0 +1,157 @@
+// ********************************************************************************************************************************
+//
+// Checks every complex kernel of every level this machine supports against the scalar version,
+// on all lengths up to 67 so that every tail is covered, and times them on a buffer that fits
+// in the L1 cache and one that does not.  Build it on its own with Utils/ComplexKernels.cpp.
+//
+// ********************************************************************************************************************************
+//
+// Includes
+//
+// ********************************************************************************************************************************
+
+#include "../Utils/ComplexKernels.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// ********************************************************************************************************************************
+//
+// Function
+//
+// ********************************************************************************************************************************
+
+int main(int argc, char* argv[])
+{
+    using Complex = std::complex<float>;
+    size_t largeSamples = (size_t)1 << 22;
+    if (argc > 1) largeSamples = std::atoi(argv[1]);
+
+    std::mt19937 generator(2021);
+    std::normal_distribution<float> noise;
+    auto random = [&](size_t n)
+    {
+        std::vector<Complex> samples(n);
+        for (Complex& sample : samples) sample = Complex(noise(generator), noise(generator));
+        return samples;
+    };
+
+    const ComplexKernels& scalar = *complexKernels(SimdLevel::Scalar);
+    std::vector<SimdLevel> levels;
+    for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512 })
+        if (complexKernels(level)) levels.push_back(level);
+    std::cout << "Detected " << simdLevelName(detectSimdLevel()) << ", in use " << simdLevelName(complexKernels().level) << ".\n\n";
+
+    // ------------------------- //
+    //  C O R R E C T N E S S   //
+    // ------------------------- //
+
+    // Largest difference to the scalar kernel, relative to the largest scalar output.
+    bool passed = true;
+    for (SimdLevel level : levels)
+    {
+        const ComplexKernels& kernels = *complexKernels(level);
+        double worst[7] = {};
+        for (size_t n = 0; n <= 67; n++)
+        {
+            std::vector<Complex> a = random(n), b = random(n), c = random(n);
+            std::vector<Complex> expected(n), output(n);
+            std::vector<float> expectedReal(n), outputReal(n);
+            auto compare = [&](int kernel, auto& reference, auto& result)
+            {
+                double largest = 1e-30, difference = 0;
+                for (size_t k = 0; k < n; k++)
+                {
+                    largest = std::max(largest, (double)std::abs(reference[k]));
+                    difference = std::max(difference, (double)std::abs(reference[k] - result[k]));
+                }
+                worst[kernel] = std::max(worst[kernel], difference / largest);
+            };
+            scalar.multiply(a.data(), b.data(), expected.data(), n);
+            kernels.multiply(a.data(), b.data(), output.data(), n);
+            compare(0, expected, output);
+            scalar.conjugateMultiply(a.data(), b.data(), expected.data(), n);
+            kernels.conjugateMultiply(a.data(), b.data(), output.data(), n);
+            compare(1, expected, output);
+            expected = c;
+            output = c;
+            scalar.multiplyAccumulate(a.data(), b.data(), expected.data(), n);
+            kernels.multiplyAccumulate(a.data(), b.data(), output.data(), n);
+            compare(2, expected, output);
+            scalar.magnitude(a.data(), expectedReal.data(), n);
+            kernels.magnitude(a.data(), outputReal.data(), n);
+            compare(3, expectedReal, outputReal);
+            scalar.magnitudeSquared(a.data(), expectedReal.data(), n);
+            kernels.magnitudeSquared(a.data(), outputReal.data(), n);
+            compare(4, expectedReal, outputReal);
+            double power = scalar.powerSum(a.data(), n);
+            worst[5] = std::max(worst[5], std::abs(power - kernels.powerSum(a.data(), n)) / std::max(power, 1e-30));
+            scalar.scale(a.data(), 0.37f, expected.data(), n);
+            kernels.scale(a.data(), 0.37f, output.data(), n);
+            compare(6, expected, output);
+        }
+        double largest = *std::max_element(worst, worst + 7);
+        passed = passed && largest < 1e-5;
+        std::cout << std::setw(8) << simdLevelName(level) << " largest relative difference to scalar: " << largest << "\n";
+    }
+    std::cout << (passed ? "All kernels match the scalar ones.\n\n" : "KERNELS DIFFER FROM THE SCALAR ONES.\n\n");
+
+    // --------------- //
+    //  T I M I N G   //
+    // --------------- //
+
+    // Nanoseconds per sample, best of a few runs of enough calls to take a few ms.
+    for (size_t samples : { (size_t)1024, largeSamples })
+    {
+        std::vector<Complex> a = random(samples), b = random(samples), output(samples);
+        std::vector<float> real(samples);
+        size_t calls = std::max<size_t>(1, ((size_t)1 << 24) / samples);
+        std::cout << samples << " samples, ns per sample:\n" << std::setw(20) << "";
+        for (SimdLevel level : levels) std::cout << std::setw(10) << simdLevelName(level);
+        std::cout << "\n";
+
+        const char* names[] = { "multiply", "conjugate multiply", "multiply accumulate", "magnitude", "magnitude squared", "power sum", "scale" };
+        for (int kernel = 0; kernel < 7; kernel++)
+        {
+            std::cout << std::setw(20) << names[kernel];
+            for (SimdLevel level : levels)
+            {
+                const ComplexKernels& kernels = *complexKernels(level);
+                volatile double sink = 0;
+                std::function<void()> call;
+                switch (kernel)
+                {
+                case 0: call = [&]() { kernels.multiply(a.data(), b.data(), output.data(), samples); }; break;
+                case 1: call = [&]() { kernels.conjugateMultiply(a.data(), b.data(), output.data(), samples); }; break;
+                case 2: call = [&]() { kernels.multiplyAccumulate(a.data(), b.data(), output.data(), samples); }; break;
+                case 3: call = [&]() { kernels.magnitude(a.data(), real.data(), samples); }; break;
+                case 4: call = [&]() { kernels.magnitudeSquared(a.data(), real.data(), samples); }; break;
+                case 5: call = [&]() { sink = sink + kernels.powerSum(a.data(), samples); }; break;
+                default: call = [&]() { kernels.scale(a.data(), 0.5f, output.data(), samples); }; break;
+                }
+                double best = 1e9;
+                for (int run = 0; run < 3; run++)
+                {
+                    auto start = std::chrono::steady_clock::now();
+                    for (size_t c = 0; c < calls; c++) call();
+                    best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+                }
+                std::cout << std::setw(10) << std::fixed << std::setprecision(3) << 1e9 * best / ((double)calls * samples);
+            }
+            std::cout << "\n";
+        }
+        std::cout << "\n";
+    }
+    return passed ? 0 : 1;
+}
+
+// ********************************************************************************************************************************
+// EOF
+// ********************************************************************************************************************************
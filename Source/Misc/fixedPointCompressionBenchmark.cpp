@@ -0,0 +1,114 @@
+// ********************************************************************************************************************************
+//
+// Compares the fixed point compression of an sc16 capture with converting it to fc32 and
+// compressing it with the PulseCompressor, for the 13 sample pulse of fromSkripsie by default.
+// Reports the accuracy of the fixed point output against the fc32 output and the throughput of
+// both.  Build it on its own with Processing/FixedPointCompression.cpp, Processing/PulseCompression.cpp,
+// Processing/MatchedFilterCache.cpp, Processing/Executor.cpp, Processing/DataCube.cpp,
+// Processing/Transpose.cpp, Utils/ComplexKernels.cpp, Utils/FFT.cpp, Utils/Waveforms.cpp and
+// Utils/WindowFunctions.cpp.
+//
+// ********************************************************************************************************************************
+//
+// Includes
+//
+// ********************************************************************************************************************************
+
+#include "../Processing/FixedPointCompression.h"
+#include "../Processing/PulseCompression.h"
+#include "../Utils/Waveforms.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// ********************************************************************************************************************************
+//
+// Function
+//
+// ********************************************************************************************************************************
+
+int main(int argc, char* argv[])
+{
+    // Capture of 2 s at 16 MS/s as the ADC delivers it.
+    double samplingFreq = 16e6;
+    double duration = 2;
+    int pulseSamples = 13;
+    int priSamples = 4267;
+    if (argc > 1) pulseSamples = std::atoi(argv[1]);
+    if (argc > 2) priSamples = std::atoi(argv[2]);
+
+    std::vector<std::complex<float>> pulse = generateLinearChirp(pulseSamples, samplingFreq / 2.1, 1, (unsigned)samplingFreq);
+    size_t captureSamples = (size_t)(duration * samplingFreq);
+    std::vector<std::complex<int16_t>> capture(captureSamples);
+    std::mt19937 generator(2021);
+    std::normal_distribution<float> noise(0, 0.05f);
+    auto quantise = [](float value) { return (int16_t)std::clamp(std::lround(value * 32767), -32768L, 32767L); };
+    for (size_t n = 0; n < captureSamples; n++)
+    {
+        // A target in every PRI.
+        std::complex<float> sample(noise(generator), noise(generator));
+        size_t delay = n % priSamples;
+        if (delay >= 1000 && delay < 1000 + (size_t)pulseSamples) sample += 0.5f * pulse[delay - 1000];
+        capture[n] = std::complex<int16_t>(quantise(sample.real()), quantise(sample.imag()));
+    }
+
+    auto time = [&](auto&& function)
+    {
+        double best = 1e9;
+        for (int run = 0; run < 3; run++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            function();
+            best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+        return best;
+    };
+    auto rate = [&](double seconds) { return captureSamples / seconds / 1e6; };
+
+    // The fc32 path: convert as UHD does and compress.
+    CompressionParameters parameters;
+    parameters.segmentSamples = priSamples;
+    PulseCompressor compressor(pulse, parameters);
+    std::vector<std::complex<float>> converted(captureSamples);
+    std::vector<std::complex<float>> reference(captureSamples);
+    double floatTime = time([&]()
+    {
+        for (size_t n = 0; n < captureSamples; n++) converted[n] = std::complex<float>(capture[n].real() / 32768.f, capture[n].imag() / 32768.f);
+        compressor.compressPRIs(converted, priSamples, reference);
+    });
+
+    FixedPointCompressor fixedPoint(pulse);
+    std::vector<std::complex<float>> output(captureSamples);
+    std::vector<std::complex<int32_t>> sums(captureSamples);
+    double fixedTime = time([&]() { fixedPoint.compressPRIs(capture, priSamples, output); });
+    double sumTime = time([&]() { fixedPoint.compressPRIs(capture, priSamples, sums); });
+
+    // Accuracy against the fc32 path.
+    double signal = 0;
+    double error = 0;
+    double maxError = 0;
+    double peak = 0;
+    for (size_t n = 0; n < captureSamples; n++)
+    {
+        signal += std::norm(reference[n]);
+        error += std::norm(output[n] - reference[n]);
+        maxError = std::max(maxError, (double)std::abs(output[n] - reference[n]));
+        peak = std::max(peak, (double)std::abs(reference[n]));
+    }
+
+    std::cout << pulseSamples << " sample pulse, PRIs of " << priSamples << " samples.\n";
+    std::cout << "fc32 (" << compressor.describe() << ", with the conversion): " << floatTime * 1e3 << " ms, " << rate(floatTime) << " MS/s\n";
+    std::cout << "sc16 (" << fixedPoint.describe() << ") to fc32: " << fixedTime * 1e3 << " ms, " << rate(fixedTime) << " MS/s\n";
+    std::cout << "sc16 to int32: " << sumTime * 1e3 << " ms, " << rate(sumTime) << " MS/s\n";
+    std::cout << "Error against fc32: " << 10 * std::log10(error / signal) << " dB of the output power, max " << 20 * std::log10(maxError / peak) << " dB of the peak.\n";
+    return 0;
+}
+
+// ********************************************************************************************************************************
+// EOF
+// ********************************************************************************************************************************
@@ -21,8 +21,14 @@
 #include <fstream>
 #include <cmath>
 
-//  Include xcorr file
-#include <fasttransforms.h>
+//  Processing
+#include "../Processing/DataCube.h"
+#include "../Processing/Synchronisation.h"
+#include "../Processing/PulseCompression.h"
+#include "../Processing/RangeDoppler.h"
+#include "../Processing/CFAR.h"
+#include "../Processing/Tracking.h"
+#include "../Processing/Executor.h"
 
 //  Function Definitions
 void TX_STR_Thread(uhd::tx_streamer::sptr TXS, std::vector<std::complex<float>*> TXPTR, size_t TXPS, uhd::tx_metadata_t TXMD, size_t TPS);
@@ -308,116 +314,77 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
 
     std::cout << "Processing..." << std::endl << "\n";
 
-    //  Remove first pulses since these are missed
-    int Offset = 300;
-    RX_Signal.erase(RX_Signal.begin(), RX_Signal.begin() + PRF_SAMPLES*Offset);
-
-    //  Extract a Pulse to sync
-    std::vector<std::complex<float>> SinglePulse(PRF_SAMPLES);
-    int PulseOffset = 0;
-    for (int n = 0; n < PRF_SAMPLES; n++)
-    {
-        SinglePulse[n] = RX_Signal[n + (int)PulseOffset * PRF_SAMPLES];
-    }
-
-    //  Signal to be correlated
-    std::vector<std::complex<float>> SignalCorr(PRF_SAMPLES, std::complex<float>(0, 0));
-
-    //  Add zeros to the signal so that a full correlation can be done
-    std::vector<std::complex<float>> SinglePulseZeros(PULSE_SAMPLES - 1, std::complex<float>(0, 0));
-    std::vector<std::complex<float>> Corr_zeros(PULSE_SAMPLES - 1, std::complex<float>(0, 0));
-    SinglePulseZeros.insert(SinglePulseZeros.end(), SinglePulse.begin(), SinglePulse.end());
-    SinglePulseZeros.insert(SinglePulseZeros.end(), Corr_zeros.begin(), Corr_zeros.end());
-
-    //  Implement xcorrelation
-    for (int n = 0; n < PRF_SAMPLES; n++)
-    {
-        for (int m = 0; m < PULSE_SAMPLES; m++)
-        {
-            SignalCorr[n] += TX_Signal_Pulse[m] * SinglePulseZeros[m + (PULSE_SAMPLES - 1) / 2 + n];
-        }
-    }
-
-    //  Find absolute value
-    std::vector<float> SignalCorrAbs(PRF_SAMPLES);
-    for (int k = 0; k < PRF_SAMPLES; k++)
-    {
-        SignalCorrAbs[k] = std::abs(SignalCorr[k]);
-    }
-
-    //  Find max value
-    float max = SignalCorrAbs[0];
-    int maxIndex = 0;
-    for (int k = 1; k < PRF_SAMPLES; k++)
-    {   
-        if (SignalCorrAbs[k] > max) { max = SignalCorrAbs[k]; maxIndex = k; }
-    }
-
-    //  Correct signal by factor
-    RX_Signal.erase(RX_Signal.begin(), RX_Signal.begin()+maxIndex/2);
+    //  The stages share one work stealing executor.  It keeps off the cores of the TX and two RX
+    //  streaming threads, and its workers are pinned to the cores after them
+    ExecutorParameters ExecutorSettings;
+    ExecutorSettings.reservedCores = 3;
+    ExecutorSettings.pinning = "Enabled";
+    Executor::configure(ExecutorSettings);
+
+    //  The first pulses are missed, the grid is found by averaging the FFT correlation of
+    //  the PRIs after them.  The capture is used from the first pulse on as a view
+    SyncParameters SyncSettings;
+    SyncSettings.skipPRIs = 300;
+    SyncSettings.pris = 32;
+    PulseGridSync Sync = synchronisePulseGrid(RX_Signal, TX_Signal_Pulse, PRF_SAMPLES, SyncSettings);
+    if (!Sync.found) std::cout << "Pulse grid not found, contrast " << Sync.contrast << " dB.\n";
+    else std::cout << "Pulses start at sample " << Sync.offset << " + " << Sync.fraction << ", contrast " << Sync.contrast << " dB over " << Sync.prisAveraged << " PRIs.\n";
 
     //-----------------------------------------------------------------------------------------------------------------------------------------------------------------
     //  Align into matrix
     //------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
     int Pulses = PRF - 1000;
-    std::vector<std::vector<std::complex<float>>> DataMatrix(PRF_SAMPLES, std::vector<std::complex<float>>(Pulses*CPI,(0,0)));
-
-    for (int i=0; i<Pulses*CPI; i++) 
-    {
-        for (int j = 0; j < PRF_SAMPLES; j++) 
-        {
-            DataMatrix[j][i] = RX_Signal[j + i*(PRF_SAMPLES)];
-        }
-    }
+    //  One aligned allocation, each pulse's range samples are contiguous
+    DataCube DataMatrix(PRF_SAMPLES, Pulses*CPI, 1, CubeLayout::PulseMajor);
+    DataMatrix.loadPRIs(Sync.apply(RX_Signal), PRF_SAMPLES);
 
     //-----------------------------------------------------------------------------------------------------------------------------------------------------------------
     //  Pulse Compression
     //------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-    //  Find conj of tx pulse to use as matched filter
-    std::vector<std::complex<float>> TX_Signal_Pulse_Conj(PULSE_SAMPLES);
-    for (int j = 0; j < PULSE_SAMPLES; j++) 
-    {
-        TX_Signal_Pulse_Conj[j] = std::conj(TX_Signal_Pulse[j]);
-    }
+    //  The matched filter is computed once and every pulse is compressed in place, the
+    //  edges are handled by the compressor so no zero padded copy is needed.  The block size
+    //  is timed on the first run and read from the plan file after that
+    MatchedFilterCache::shared().setPlanFile("FilterPlans.txt");
+    CompressionParameters CompressionSettings;
+    CompressionSettings.segmentSamples = PRF_SAMPLES;
+    CompressionSettings.planning = "Measure";
+    PulseCompressor Compressor(TX_Signal_Pulse, CompressionSettings);
+    Compressor.compress(DataMatrix);
 
-    //  Create empty array to convolute to
-    std::vector<std::vector<std::complex<float>>> DataMatrixFiltered(PRF_SAMPLES, std::vector<std::complex<float>>(Pulses*CPI, (0, 0)));
+    //-----------------------------------------------------------------------------------------------------------------------------------------------------------------
+    //  Range-Doppler
+    //------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-    //  Add the zeros to be able to convolute
-    std::vector<std::vector<std::complex<float>>> DataMatrixZeros(PRF_SAMPLES + 2*(PULSE_SAMPLES-1), std::vector<std::complex<float>>(Pulses*CPI, (0, 0)));
-    std::vector<std::complex<float>> Conv_zeros(PULSE_SAMPLES - 1, std::complex<float>(0, 0));
-    //  Add zeros to each pulse
-    for (int j=0; j<Pulses*CPI; j++) 
-    {
-        std::vector<std::complex<float>> NewData(PULSE_SAMPLES-1, std::complex<float>(0, 0));
-        std::vector<std::complex<float>> LoadedFromData(PRF_SAMPLES, std::complex<float>(0, 0));
-        for (int k = 0; k < PRF_SAMPLES; k++)
-        {
-            LoadedFromData[k] = DataMatrix[k][j];
-        }
-        NewData.insert(NewData.end(), LoadedFromData.begin(), LoadedFromData.end());
-        NewData.insert(NewData.end(), Conv_zeros.begin(), Conv_zeros.end());
-        //  Put into new matrix
-        for (int k = 0; k < PRF_SAMPLES + 2 * (PULSE_SAMPLES - 1); k++)
-        {
-            DataMatrixZeros[k][j] = NewData[k];
-        }
-    }
+    //  Each CPI is windowed in slow time and transformed per range bin, in dB
+    DopplerParameters DopplerSettings;
+    DopplerSettings.window = "Hamming";
+    DopplerProcessor Doppler(Pulses, DopplerSettings);
+    std::vector<RangeDopplerMap> RangeDopplerMaps = Doppler.processAll(DataMatrix);
+
+    //-----------------------------------------------------------------------------------------------------------------------------------------------------------------
+    //  Detection
+    //------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
-    //  Filter loop for each Pulse
-    for (int j=0; j<Pulses*CPI; j++) 
-    {   
-        //  Convolute each pulse
-        for (int n = 0; n < PRF_SAMPLES; n++)
-        {
-            for (int m = 0; m < PULSE_SAMPLES; m++)
-            {
-                DataMatrixFiltered[n][j] += TX_Signal_Pulse_Conj[m] * DataMatrixZeros[(m+1) + (PULSE_SAMPLES - 1) / 2 + n][j];
-            }
-        }
+    //  CA-CFAR over every map, the Doppler axis wraps.  The detections of every CPI update the
+    //  tracker at the time of its first pulse and the confirmed tracks are written to file
+    CFARParameters DetectionSettings;
+    DetectionSettings.pfa = 1e-6;
+    TrackerParameters TrackerSettings;
+    TrackerSettings.rangeBin = rangeBinMetres(fs);
+    if (!RangeDopplerMaps.empty()) TrackerSettings.velocityBin = velocityBinMetres(fc, PRF, RangeDopplerMaps.front().dopplerBins);
+    Tracker Tracks(TrackerSettings);
+    TrackWriter TrackFile("Tracks.trk");
+    for (size_t cpi = 0; cpi < RangeDopplerMaps.size(); cpi++)
+    {
+        std::vector<Detection> Detections = detectRangeDoppler(RangeDopplerMaps[cpi], DetectionSettings);
+        for (const Detection& detection : Detections)
+            std::cout << "CPI " << cpi << ": range bin " << detection.rangePosition << ", Doppler " << RangeDopplerMaps[cpi].dopplerFrequency(detection.doppler, PRF) << " Hz, SNR " << detection.snr << " dB\n";
+        Tracks.update(Detections, RangeDopplerMaps[cpi].firstPulse / PRF, RangeDopplerMaps[cpi].dopplerBins);
+        TrackFile.write(Tracks);
     }
+    std::cout << "Tracks: " << Tracks.describe() << "\n";
 
     //------------------------------------
     //  Write real component of data matrix to file
@@ -434,7 +401,7 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
     //{
     //    for (int s = 0; s < PRF_SAMPLES; s++)
     //    {
-    //        DataMatrixRealFile << std::real(DataMatrixFiltered[s][p]) << '\n';
+    //        DataMatrixRealFile << std::real(DataMatrix.at(s, p)) << '\n';
     //    }
     //}
     //DataMatrixRealFile.close();
@@ -454,12 +421,14 @@ int UHD_SAFE_MAIN(int argc, char* argv[])
     //{
     //    for (int s = 0; s < PRF_SAMPLES; s++)
     //    {
-    //        DataMatrixComplexFile << std::imag(DataMatrixFiltered[s][p]) << '\n';
+    //        DataMatrixComplexFile << std::imag(DataMatrix.at(s, p)) << '\n';
     //    }
     //}
     //DataMatrixComplexFile.close();
     //std::cout << " Done." << "\n";
     
+    std::cout << "\n" << "Processing time per stage on " << Executor::shared().threads() << " threads:\n" << Executor::shared().report();
+    std::cout << "Matched filters: " << MatchedFilterCache::shared().describe() << "\n";
     std::cout << "\n" << "Done." << "\n";
     return EXIT_SUCCESS;
 
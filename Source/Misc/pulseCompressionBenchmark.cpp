@@ -0,0 +1,96 @@
+// ********************************************************************************************************************************
+//
+// Checks the pulse compression engine against the original O(N.M) loop and times it on a
+// capture of the given length.  Build it on its own with Processing/PulseCompression.cpp,
+// Processing/MatchedFilterCache.cpp, Processing/Executor.cpp, Processing/DataCube.cpp,
+// Processing/Transpose.cpp, Utils/ComplexKernels.cpp, Utils/FFT.cpp, Utils/Waveforms.cpp and
+// Utils/WindowFunctions.cpp.
+//
+// ********************************************************************************************************************************
+//
+// Includes
+//
+// ********************************************************************************************************************************
+
+#include "../Processing/PulseCompression.h"
+#include "../Utils/Waveforms.h"
+#include <chrono>
+#include <complex>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// ********************************************************************************************************************************
+//
+// Function
+//
+// ********************************************************************************************************************************
+
+int main(int argc, char* argv[])
+{
+    // Capture of 2 s at 16 MS/s with the default pulse and PRI.
+    double samplingFreq = 16e6;
+    double duration = 2;
+    int pulseSamples = 241;
+    int priSamples = 4267;
+    if (argc > 1) pulseSamples = std::atoi(argv[1]) | 1;
+    if (argc > 2) priSamples = std::atoi(argv[2]);
+
+    std::vector<std::complex<float>> pulse = generateLinearChirp(pulseSamples, samplingFreq / 2.1, 1, (unsigned)samplingFreq);
+    size_t captureSamples = (size_t)(duration * samplingFreq);
+    std::vector<std::complex<float>> capture(captureSamples);
+    std::mt19937 generator(2021);
+    std::normal_distribution<float> noise(0, 0.1f);
+    for (std::complex<float>& sample : capture) sample = std::complex<float>(noise(generator), noise(generator));
+    // A target in every PRI.
+    for (size_t pri = 0; pri + priSamples <= captureSamples; pri += priSamples)
+        for (int n = 0; n < pulseSamples; n++) capture[pri + 1000 + n] += 0.5f * pulse[n];
+
+    // Correctness against the reference on the first PRIs.
+    CompressionParameters parameters;
+    parameters.segmentSamples = priSamples;
+    PulseCompressor compressor(pulse, parameters);
+    std::vector<std::complex<float>> output(captureSamples);
+    std::vector<std::complex<float>> reference(priSamples);
+    compressor.compressPRIs(capture, priSamples, output);
+    double maxError = 0;
+    double maxReference = 0;
+    for (int pri = 0; pri < 8; pri++)
+    {
+        pulseCompressionReference(pulse, std::span(capture).subspan(pri * priSamples, priSamples), reference);
+        for (int n = 0; n < priSamples; n++)
+        {
+            maxError = std::max(maxError, (double)std::abs(reference[n] - output[pri * priSamples + n]));
+            maxReference = std::max(maxReference, (double)std::abs(reference[n]));
+        }
+    }
+    std::cout << "Engine: " << compressor.describe() << "\n";
+    std::cout << "Max error relative to the reference peak: " << maxError / maxReference << "\n";
+
+    // Timing, per PRI and as a continuous stream.
+    auto time = [&](auto&& function)
+    {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    double priTime = time([&]() { compressor.compressPRIs(capture, priSamples, output); });
+    PulseCompressor stream(pulse);
+    double streamTime = time([&]() { stream.compress(capture, output); });
+    std::cout << "Per PRI: " << priTime << " s for " << duration << " s of data.\n";
+    std::cout << "Stream (" << stream.describe() << "): " << streamTime << " s for " << duration << " s of data.\n";
+
+    // The original loop, timed on a few PRIs and scaled to the capture.
+    int pris = 16;
+    double referenceTime = time([&]()
+    {
+        for (int pri = 0; pri < pris; pri++)
+            pulseCompressionReference(pulse, std::span(capture).subspan(pri * priSamples, priSamples), reference);
+    });
+    std::cout << "Reference loop (estimated): " << referenceTime * (captureSamples / priSamples) / pris << " s.\n";
+    return 0;
+}
+
+// ********************************************************************************************************************************
+// EOF
+// ********************************************************************************************************************************
@@ -0,0 +1,101 @@
+// ********************************************************************************************************************************
+//
+// Times the blocked transpose of the data cube against memcpy of the same number of bytes and
+// against the plain loop setLayout() used to run, on a capture of 2 s at 16 MS/s.  Build it
+// on its own with Processing/Transpose.cpp, Processing/Executor.cpp and Processing/DataCube.cpp.
+//
+// The bandwidth is the bytes read plus the bytes written per second.
+//
+// ********************************************************************************************************************************
+//
+// Includes
+//
+// ********************************************************************************************************************************
+
+#include "../Processing/Transpose.h"
+#include "../Processing/Executor.h"
+#include "../Processing/DataCube.h"
+#include <chrono>
+#include <complex>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// ********************************************************************************************************************************
+//
+// Function
+//
+// ********************************************************************************************************************************
+
+int main(int argc, char* argv[])
+{
+    // Capture of 2 s at 16 MS/s cut into PRIs, and a square cube for the in place transpose.
+    double samplingFreq = 16e6;
+    double duration = 2;
+    size_t priSamples = 4267;
+    size_t square = 4096;
+    if (argc > 1) priSamples = std::atoi(argv[1]);
+    if (argc > 2) square = std::atoi(argv[2]);
+    size_t pulses = (size_t)(duration * samplingFreq) / priSamples;
+    size_t samples = pulses * priSamples;
+    double bytes = 2.0 * samples * sizeof(std::complex<float>);
+
+    std::vector<std::complex<float>> input(samples);
+    std::vector<std::complex<float>> output(samples);
+    for (size_t n = 0; n < samples; n++) input[n] = std::complex<float>((float)n, -(float)n);
+
+    // Best of a few runs.
+    auto time = [&](auto&& function)
+    {
+        double best = 1e9;
+        for (int run = 0; run < 3; run++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            function();
+            best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+        return best;
+    };
+    auto report = [&](const std::string& name, double seconds, double reference)
+    {
+        std::cout << name << ": " << seconds * 1e3 << " ms, " << bytes / seconds / 1e9 << " GB/s";
+        if (reference > 0) std::cout << " (" << 100 * reference / seconds << " % of memcpy)";
+        std::cout << "\n";
+    };
+
+    std::cout << pulses << " PRIs of " << priSamples << " samples, " << bytes / 2 / (1 << 20) << " MiB, " << Executor::shared().threads() << " threads.\n";
+    double copy = time([&]() { std::memcpy(output.data(), input.data(), samples * sizeof(std::complex<float>)); });
+    report("memcpy", copy, 0);
+
+    // The loop setLayout() used to run, writing every sample to another line.
+    double plain = time([&]()
+    {
+        for (size_t pulse = 0; pulse < pulses; pulse++)
+            for (size_t range = 0; range < priSamples; range++) output[range * pulses + pulse] = input[pulse * priSamples + range];
+    });
+    report("Plain loop", plain, copy);
+
+    double single = time([&]() { transpose(input.data(), pulses, priSamples, priSamples, output.data(), pulses, 1); });
+    report("Blocked, 1 thread", single, copy);
+    double blocked = time([&]() { transpose(input.data(), pulses, priSamples, priSamples, output.data(), pulses); });
+    report("Blocked", blocked, copy);
+
+    // Check the last transpose.
+    size_t errors = 0;
+    for (size_t pulse = 0; pulse < pulses; pulse += 97)
+        for (size_t range = 0; range < priSamples; range += 13) errors += output[range * pulses + pulse] != input[pulse * priSamples + range];
+    std::cout << "Errors: " << errors << "\n";
+
+    // Square cube in place, as setLayout() does when the pulses equal the range bins.
+    DataCube cube(square, square, 1, CubeLayout::PulseMajor);
+    double squareBytes = 2.0 * square * square * sizeof(std::complex<float>);
+    double inPlace = time([&]() { cube.setLayout((cube.layout() == CubeLayout::PulseMajor) ? CubeLayout::RangeMajor : CubeLayout::PulseMajor); });
+    std::cout << "In place, " << square << " x " << square << ": " << inPlace * 1e3 << " ms, " << squareBytes / inPlace / 1e9 << " GB/s\n";
+
+    std::cout << "\n" << Executor::shared().report();
+    return 0;
+}
+
+// ********************************************************************************************************************************
+// EOF
+// ********************************************************************************************************************************
@@ -0,0 +1,193 @@
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include "Ambiguity.h"
+#include "../Utils/FFT.h"
+#include "../Utils/ComplexKernels.h"
+#include "Executor.h"
+#include <cmath>
+#include <numbers>
+#include <limits>
+#include <chrono>
+#include <fstream>
+#include <algorithm>
+
+// ================================================================================================================================================================================ //
+//  Surface.                                                                                                                                                                        //
+// ================================================================================================================================================================================ //
+
+AmbiguitySurface computeAmbiguity(std::span<const std::complex<float>> pulse, float samplingFreq, const AmbiguityParameters& parameters)
+{
+	auto startTime = std::chrono::steady_clock::now();
+	AmbiguitySurface surface;
+	int nSamples = (int)pulse.size();
+	if (!nSamples || samplingFreq <= 0) return surface;
+
+	// ------------- //
+	//  L A Y O U T  //
+	// ------------- //
+
+	// Linear (not circular) correlation needs 2N - 1 points.
+	const FFTPlan& plan = *sharedPlan(nextPowerOfTwo(2 * nSamples - 1));
+	size_t fftSize = plan.size();
+	int maxDelay = (parameters.maxDelay && (int)parameters.maxDelay < nSamples) ? (int)parameters.maxDelay : nSamples - 1;
+	surface.firstDelay = -maxDelay;
+	surface.delays = 2 * maxDelay + 1;
+	surface.dopplers = parameters.dopplerBins | 1;
+	surface.samplingFreq = samplingFreq;
+	float maxDoppler = (parameters.maxDoppler > 0) ? parameters.maxDoppler : samplingFreq / 4;
+	surface.dopplerAxis.resize(surface.dopplers);
+	for (unsigned k = 0; k < surface.dopplers; k++)
+		surface.dopplerAxis[k] = (surface.dopplers == 1) ? 0 : -maxDoppler + 2 * maxDoppler * k / (surface.dopplers - 1);
+	surface.magnitude.resize((size_t)surface.delays * surface.dopplers);
+
+	// The conjugate spectrum of the pulse is shared by all of the cuts.
+	std::vector<std::complex<float>> reference(fftSize);
+	std::copy(pulse.begin(), pulse.end(), reference.begin());
+	plan.forward(reference);
+	for (std::complex<float>& bin : reference) bin = std::conj(bin);
+	double energy = 0;
+	for (const std::complex<float>& sample : pulse) energy += std::norm(sample);
+	float normalisation = (energy > 0) ? (float)(1.0 / energy) : 0.f;
+
+	// --------------- //
+	//  W O R K E R S  //
+	// --------------- //
+
+	// Every chunk is a run of Doppler cuts, every thread has its own scratch buffer.
+	Executor& executor = Executor::shared();
+	std::vector<std::vector<std::complex<float>>> buffers(executor.threads());
+	executor.parallelFor("Ambiguity", surface.dopplers, 1, [&](size_t firstCut, size_t lastCut, unsigned thread)
+	{
+		std::vector<std::complex<float>>& scratch = buffers[thread];
+		scratch.resize(fftSize);
+		for (size_t k = firstCut; k < lastCut; k++)
+		{
+			// Doppler shift the pulse.
+			std::fill(scratch.begin(), scratch.end(), std::complex<float>(0, 0));
+			double phaseStep = 2 * std::numbers::pi * surface.dopplerAxis[k] / samplingFreq;
+			for (int n = 0; n < nSamples; n++)
+				scratch[n] = pulse[n] * std::complex<float>(std::polar(1.0, phaseStep * n));
+			// Correlate, a delay d ends up at index d mod fftSize.
+			plan.forward(scratch);
+			complexMultiply(scratch, reference, scratch);
+			plan.inverse(scratch);
+			float* cut = &surface.magnitude[(size_t)k * surface.delays];
+			for (int d = -maxDelay; d <= maxDelay; d++)
+				cut[d + maxDelay] = std::abs(scratch[(d + fftSize) % fftSize]) * normalisation;
+		}
+	}, parameters.threads);
+
+	// --------------- //
+	//  M E T R I C S  //
+	// --------------- //
+
+	AmbiguityMetrics& metrics = surface.metrics;
+	const float* zeroCut = &surface.magnitude[(size_t)(surface.dopplers / 2) * surface.delays];
+	int centre = maxDelay;
+	float peak = zeroCut[centre];
+	float halfPower = peak / std::sqrt(2.f);
+
+	// The mainlobe extends to the first null on either side.
+	int right = centre;
+	while (right + 1 < (int)surface.delays && zeroCut[right + 1] < zeroCut[right]) right++;
+	int left = centre;
+	while (left > 0 && zeroCut[left - 1] < zeroCut[left]) left--;
+	double mainlobeEnergy = 0;
+	double sidelobeEnergy = 0;
+	float sidelobePeak = 0;
+	for (int d = 0; d < (int)surface.delays; d++)
+	{
+		double power = (double)zeroCut[d] * zeroCut[d];
+		if (d >= left && d <= right) mainlobeEnergy += power;
+		else { sidelobeEnergy += power; sidelobePeak = std::max(sidelobePeak, zeroCut[d]); }
+	}
+	metrics.pslr = (sidelobePeak > 0) ? 20 * std::log10(sidelobePeak / peak) : -std::numeric_limits<float>::infinity();
+	metrics.islr = (sidelobeEnergy > 0) ? (float)(10 * std::log10(sidelobeEnergy / mainlobeEnergy)) : -std::numeric_limits<float>::infinity();
+	metrics.mainlobeNullWidth = (right - left) / samplingFreq;
+
+	// -3 dB points, interpolated between samples.
+	auto crossing = [&](const float* values, int from, int direction, int limit)
+	{
+		for (int n = from; n != limit; n += direction)
+		{
+			float next = values[n + direction];
+			if (next < halfPower) return n + direction * (values[n] - halfPower) / (values[n] - next);
+		}
+		return (float)limit;
+	};
+	float rightHalf = crossing(zeroCut, centre, 1, (int)surface.delays - 1);
+	float leftHalf = crossing(zeroCut, centre, -1, 0);
+	metrics.mainlobeWidth = (rightHalf - leftHalf) / samplingFreq;
+
+	// Doppler tolerance: where the peak over all delays drops by 3 dB.
+	std::vector<float> dopplerPeaks(surface.dopplers);
+	for (unsigned k = 0; k < surface.dopplers; k++)
+	{
+		const float* cut = &surface.magnitude[(size_t)k * surface.delays];
+		dopplerPeaks[k] = *std::max_element(cut, cut + surface.delays);
+	}
+	int zeroBin = surface.dopplers / 2;
+	float binSpacing = (surface.dopplers > 1) ? surface.dopplerAxis[1] - surface.dopplerAxis[0] : 0;
+	float upper = crossing(dopplerPeaks.data(), zeroBin, 1, surface.dopplers - 1);
+	float lower = crossing(dopplerPeaks.data(), zeroBin, -1, 0);
+	metrics.dopplerToleranceFound = std::any_of(dopplerPeaks.begin(), dopplerPeaks.end(), [&](float value) { return value < halfPower; });
+	metrics.dopplerTolerance = std::min(upper - zeroBin, zeroBin - lower) * binSpacing;
+
+	metrics.analysisTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	return surface;
+}
+
+// ================================================================================================================================================================================ //
+//  Export.                                                                                                                                                                         //
+// ================================================================================================================================================================================ //
+
+bool exportAmbiguity(const AmbiguitySurface& surface, const std::string& basePath, const std::string& description)
+{
+	std::ofstream surfaceFile(basePath + ".bin", std::ofstream::binary);
+	if (!surfaceFile) return false;
+	surfaceFile.write((const char*)surface.magnitude.data(), surface.magnitude.size() * sizeof(float));
+	if (!surfaceFile) return false;
+
+	const AmbiguityMetrics& metrics = surface.metrics;
+	std::ofstream noteFile(basePath + ".txt");
+	if (!noteFile) return false;
+	noteFile << "---------------------------------------------------------------------------------------\n";
+	noteFile << "|                                  Ambiguity                                          |\n";
+	noteFile << "---------------------------------------------------------------------------------------\n\n";
+	if (description.size()) noteFile << "Waveform: " << description << "\n";
+	noteFile << "Sampling frequency: " << surface.samplingFreq << " Hz\n";
+	noteFile << "Delays: " << surface.delays << " (" << surface.firstDelay << " to " << surface.firstDelay + (int)surface.delays - 1 << " samples)\n";
+	noteFile << "Doppler cuts: " << surface.dopplers << " (" << surface.dopplerAxis.front() << " to " << surface.dopplerAxis.back() << " Hz)\n\n";
+	noteFile << "PSLR: " << metrics.pslr << " dB\n";
+	noteFile << "ISLR: " << metrics.islr << " dB\n";
+	noteFile << "Mainlobe width (-3 dB): " << metrics.mainlobeWidth * 1e9 << " ns\n";
+	noteFile << "Mainlobe width (null to null): " << metrics.mainlobeNullWidth * 1e9 << " ns\n";
+	noteFile << "Doppler tolerance (-3 dB): " << (metrics.dopplerToleranceFound ? "" : "> ") << metrics.dopplerTolerance << " Hz\n";
+	noteFile << "Analysis time: " << metrics.analysisTime << " s\n\n";
+	noteFile << "The surface is stored as float32 |chi|, normalised to the pulse energy.\n";
+	noteFile << "Every Doppler cut is stored as a row of " << surface.delays << " delays, from the lowest Doppler shift up.\n";
+	return (bool)noteFile;
+}
+
+// ================================================================================================================================================================================ //
+//  Files.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+std::vector<std::complex<float>> readPulseFile(const std::string& path)
+{
+	std::vector<std::complex<float>> pulse;
+	std::ifstream file(path, std::ifstream::binary | std::ifstream::ate);
+	if (!file) return pulse;
+	std::streamsize bytes = file.tellg();
+	file.seekg(0);
+	pulse.resize(bytes / sizeof(std::complex<float>));
+	file.read((char*)pulse.data(), pulse.size() * sizeof(std::complex<float>));
+	if (!file) pulse.clear();
+	return pulse;
+}
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
@@ -0,0 +1,68 @@
+#pragma once
+
+/*
+* Delay-Doppler ambiguity analysis of a transmission pulse.  Every Doppler cut of the surface
+* is the FFT correlation of the Doppler shifted pulse with the pulse itself, and the cuts are
+* spread over all of the cores.  The zero Doppler cut gives the range sidelobe metrics.
+*/
+
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include <vector>
+#include <complex>
+#include <span>
+#include <string>
+
+// ================================================================================================================================================================================ //
+//  Types.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+struct AmbiguityParameters
+{
+	unsigned dopplerBins = 257;		// Doppler cuts, made odd so that there is a zero Doppler cut.
+	float maxDoppler = 0;			// Doppler span is -maxDoppler to maxDoppler [Hz], 0 uses a quarter of the sampling frequency.
+	unsigned maxDelay = 0;			// Delays kept in the surface are -maxDelay to maxDelay [samples], 0 keeps all of them.
+	unsigned threads = 0;			// Threads of the shared executor used, 0 uses all of them.
+};
+
+struct AmbiguityMetrics
+{
+	float pslr = 0;						// Peak sidelobe ratio of the zero Doppler cut [dB].
+	float islr = 0;						// Integrated sidelobe ratio of the zero Doppler cut [dB].
+	float mainlobeWidth = 0;			// -3 dB mainlobe width [s].
+	float mainlobeNullWidth = 0;		// Null to null mainlobe width [s].
+	float dopplerTolerance = 0;			// Doppler shift at which the correlation peak drops by 3 dB [Hz].
+	bool dopplerToleranceFound = false;	// False if the peak did not drop by 3 dB inside the analysed span.
+	double analysisTime = 0;			// Time taken to compute the surface [s].
+};
+
+struct AmbiguitySurface
+{
+	unsigned delays = 0;				// Delays per Doppler cut.
+	unsigned dopplers = 0;				// Doppler cuts.
+	int firstDelay = 0;					// Delay of the first column [samples].
+	float samplingFreq = 0;
+	std::vector<float> dopplerAxis;		// Doppler shift of every cut [Hz].
+	std::vector<float> magnitude;		// |chi(delay, doppler)| normalised to the pulse energy, one Doppler cut after the other.
+	AmbiguityMetrics metrics;
+};
+
+// ================================================================================================================================================================================ //
+//  Analysis.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+// Compute the ambiguity surface and metrics of the pulse.
+AmbiguitySurface computeAmbiguity(std::span<const std::complex<float>> pulse, float samplingFreq, const AmbiguityParameters& parameters = AmbiguityParameters());
+
+// Write the surface to <basePath>.bin (float32, one Doppler cut after the other) and the axes
+// and metrics to <basePath>.txt.  Returns false if a file could not be written.
+bool exportAmbiguity(const AmbiguitySurface& surface, const std::string& basePath, const std::string& description = "");
+
+// Read a pulse stored as raw fc32 samples (I Q I Q ...).
+std::vector<std::complex<float>> readPulseFile(const std::string& path);
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
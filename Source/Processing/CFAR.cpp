@@ -0,0 +1,450 @@
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include "CFAR.h"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+// ================================================================================================================================================================================ //
+//  Threshold scale.                                                                                                                                                                //
+// ================================================================================================================================================================================ //
+
+namespace
+{
+	// Sum over k < n of C(n + k - 1, k) (2 + T)^-(n + k), the term shared by the GO and SO Pfa.
+	double sideSum(unsigned n, double T)
+	{
+		double sum = 0;
+		for (unsigned k = 0; k < n; k++)
+		{
+			double logBinomial = std::lgamma((double)n + k) - std::lgamma((double)k + 1) - std::lgamma((double)n);
+			sum += std::exp(logBinomial - (n + k) * std::log(2 + T));
+		}
+		return sum;
+	}
+
+	// Pfa of the method for a threshold scale T, decreasing in T.
+	double pfaOf(const std::string& method, unsigned cells, unsigned rank, double T)
+	{
+		if (method == "GO") return 2 * std::pow(1 + T, -(double)cells) - 2 * sideSum(cells, T);
+		if (method == "SO") return 2 * sideSum(cells, T);
+		if (method == "OS")
+		{
+			double logPfa = 0;
+			for (unsigned i = 0; i < rank; i++) logPfa += std::log((double)(cells - i) / (cells - i + T));
+			return std::exp(logPfa);
+		}
+		return std::pow(1 + T, -(double)cells);
+	}
+
+	const float infinity = std::numeric_limits<float>::infinity();
+}
+
+double cfarScale(const std::string& method, unsigned cells, double pfa, unsigned rank)
+{
+	if (cells == 0 || pfa <= 0 || pfa >= 1) return std::numeric_limits<double>::infinity();
+	if (method == "CA") return std::pow(pfa, -1.0 / cells) - 1;
+	if (method == "OS") rank = std::clamp(rank, 1u, cells);
+	else if (method != "GO" && method != "SO") throw std::invalid_argument("CFAR method '" + method + "' is not supported.");
+
+	// Bisection in log T, there is no closed form.
+	double low = 0;
+	double high = 1;
+	while (pfaOf(method, cells, rank, high) > pfa && high < 1e12) high *= 2;
+	for (int iteration = 0; iteration < 200 && high - low > 1e-12 * high; iteration++)
+	{
+		double middle = (low > 0) ? std::sqrt(low * high) : high / 2;
+		if (pfaOf(method, cells, rank, middle) > pfa) low = middle;
+		else high = middle;
+	}
+	return high;
+}
+
+// ================================================================================================================================================================================ //
+//  Helpers.                                                                                                                                                                        //
+// ================================================================================================================================================================================ //
+
+namespace
+{
+	// Training cells kept sorted as the window slides, so the ordered statistic is a lookup.
+	// Every step removes and inserts a few cells instead of sorting the window again.
+	class RunningSelection
+	{
+	public:
+		void insert(float value) { m_sorted.insert(m_sorted.begin() + bound(value, true), value); }
+		void remove(float value)
+		{
+			size_t position = bound(value, false);
+			if (position < m_sorted.size() && m_sorted[position] == value) m_sorted.erase(m_sorted.begin() + position);
+		}
+		// Swap a cell of the window for a new one, moving only the cells between the two.
+		void replace(float out, float in)
+		{
+			float* sorted = m_sorted.data();
+			size_t from = bound(out, false);
+			size_t to = bound(in, true);
+			if (to > from) { std::copy(sorted + from + 1, sorted + to, sorted + from); sorted[to - 1] = in; }
+			else { std::copy_backward(sorted + to, sorted + from, sorted + from + 1); sorted[to] = in; }
+		}
+		void clear() { m_sorted.clear(); }
+		size_t size() const { return m_sorted.size(); }
+		// The rank-th smallest cell, 1 based.
+		float select(size_t rank) const { return m_sorted[std::clamp<size_t>(rank, 1, m_sorted.size()) - 1]; }
+	private:
+		std::vector<float> m_sorted;
+
+		// Binary search without branches on the comparisons, noise is random and mispredicts every
+		// other step of std::lower_bound.  First position after the cells below value (or not
+		// above it, for upper).
+		size_t bound(float value, bool upper) const
+		{
+			if (m_sorted.empty()) return 0;
+			const float* sorted = m_sorted.data();
+			size_t low = 0;
+			size_t count = m_sorted.size();
+			while (count > 1)
+			{
+				size_t half = count / 2;
+				float cell = sorted[low + half];
+				low = (upper ? cell <= value : cell < value) ? low + half : low;
+				count -= half;
+			}
+			return low + (upper ? sorted[low] <= value : sorted[low] < value);
+		}
+	};
+
+	// Offset of the peak of a parabola through three log power samples, in cells.
+	float interpolatePeak(float before, float peak, float after)
+	{
+		float left = 10.f * std::log10(before + 1e-30f);
+		float centre = 10.f * std::log10(peak + 1e-30f);
+		float right = 10.f * std::log10(after + 1e-30f);
+		float curvature = left - 2 * centre + right;
+		if (curvature >= 0) return 0;
+		return std::clamp(0.5f * (left - right) / curvature, -0.5f, 0.5f);
+	}
+
+	unsigned osRank(const CFARParameters& parameters, size_t cells)
+	{
+		return (unsigned)std::clamp<long long>(std::llround(parameters.osRank * cells), 1, (long long)cells);
+	}
+}
+
+// ================================================================================================================================================================================ //
+//  Range.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+std::vector<Detection> detectRange(std::span<const float> power, const CFARParameters& parameters)
+{
+	const long long n = (long long)power.size();
+	const long long g = parameters.guardCells;
+	const long long t = std::max(1u, parameters.trainingCells);
+	const long long w = g + t;
+	const std::string& method = parameters.method;
+
+	// Prefix sums in double, so the window sums do not lose the weak cells next to strong ones.
+	std::vector<double> prefix(n + 1, 0.0);
+	for (long long i = 0; i < n; i++) prefix[i + 1] = prefix[i] + power[i];
+	std::vector<float> threshold(n, infinity);
+	std::vector<float> noise(n, 0.f);
+
+	// ----------------- //
+	//  I N T E R I O R  //
+	// ----------------- //
+
+	// Cells with the full window on both sides.  The loops are branch free so that they vectorise.
+	long long first = w;
+	long long last = std::max(w, n - w);
+	if (method == "CA")
+	{
+		const double scale = cfarScale("CA", (unsigned)(2 * t), parameters.pfa);
+		for (long long i = first; i < last; i++)
+		{
+			double sum = (prefix[i - g] - prefix[i - w]) + (prefix[i + w + 1] - prefix[i + g + 1]);
+			threshold[i] = (float)(scale * sum);
+			noise[i] = (float)(sum / (2 * t));
+		}
+	}
+	else if (method == "GO" || method == "SO")
+	{
+		const double scale = cfarScale(method, (unsigned)t, parameters.pfa);
+		const bool greatest = (method == "GO");
+		for (long long i = first; i < last; i++)
+		{
+			double lag = prefix[i - g] - prefix[i - w];
+			double lead = prefix[i + w + 1] - prefix[i + g + 1];
+			double sum = greatest ? std::max(lag, lead) : std::min(lag, lead);
+			threshold[i] = (float)(scale * sum);
+			noise[i] = (float)(sum / t);
+		}
+	}
+	else if (method == "OS")
+	{
+		const unsigned rank = osRank(parameters, 2 * t);
+		const double scale = cfarScale("OS", (unsigned)(2 * t), parameters.pfa, rank);
+		RunningSelection window;
+		for (long long i = first; i < last; i++)
+		{
+			if (i == first)
+			{
+				for (long long k = i - w; k < i - g; k++) window.insert(power[k]);
+				for (long long k = i + g + 1; k <= i + w; k++) window.insert(power[k]);
+			}
+			else
+			{
+				// The far lagging cell leaves and the nearest guard cell joins the lagging side,
+				// the nearest leading cell becomes a guard cell and a new far leading cell joins.
+				window.replace(power[i - w - 1], power[i - g - 1]);
+				window.replace(power[i + g], power[i + w]);
+			}
+			float statistic = window.select(rank);
+			threshold[i] = (float)(scale * statistic);
+			noise[i] = statistic;
+		}
+	}
+	else throw std::invalid_argument("CFAR method '" + method + "' is not supported.");
+
+	// ----------- //
+	//  E D G E S  //
+	// ----------- //
+
+	const double sideScale = cfarScale("CA", (unsigned)t, parameters.pfa);
+	for (long long i = 0; i < n; i++)
+	{
+		if (i >= first && i < last) { i = last - 1; continue; }
+		bool lagFits = (i >= w);
+		bool leadFits = (i + w < n);
+		if (!lagFits && !leadFits) continue;
+		double sum = lagFits ? prefix[i - g] - prefix[i - w] : prefix[i + w + 1] - prefix[i + g + 1];
+		threshold[i] = (float)(sideScale * sum);
+		noise[i] = (float)(sum / t);
+	}
+
+	// --------------------- //
+	//  D E T E C T I O N S  //
+	// --------------------- //
+
+	std::vector<unsigned char> hits(n);
+	for (long long i = 0; i < n; i++) hits[i] = power[i] > threshold[i];
+	std::vector<Detection> detections;
+	for (long long i = 0; i < n; i++)
+	{
+		if (!hits[i]) continue;
+		float before = (i > 0) ? power[i - 1] : 0.f;
+		float after = (i + 1 < n) ? power[i + 1] : 0.f;
+		// Plateaus report their first cell.
+		if (parameters.peaksOnly && (before >= power[i] || after > power[i])) continue;
+		Detection detection;
+		detection.range = (size_t)i;
+		detection.rangePosition = i + ((i > 0 && i + 1 < n) ? interpolatePeak(before, power[i], after) : 0.f);
+		detection.power = power[i];
+		detection.snr = 10.f * std::log10(power[i] / std::max(noise[i], 1e-30f));
+		detections.push_back(detection);
+	}
+	return detections;
+}
+
+// ================================================================================================================================================================================ //
+//  Range-Doppler.                                                                                                                                                                  //
+// ================================================================================================================================================================================ //
+
+std::vector<Detection> detectRangeDoppler(const RangeDopplerMap& map, const CFARParameters& parameters)
+{
+	const long long rows = (long long)map.rangeBins;
+	const long long dopplers = (long long)map.dopplerBins;
+	if (!rows || !dopplers) return {};
+	const std::string& method = parameters.method;
+	if (method != "CA" && method != "GO" && method != "SO" && method != "OS") throw std::invalid_argument("CFAR method '" + method + "' is not supported.");
+
+	// The Doppler window cannot be wider than the map.
+	const long long g = parameters.guardCells;
+	const long long wr = g + std::max(1u, parameters.trainingCells);
+	const long long wd = std::min<long long>(parameters.dopplerGuardCells + parameters.dopplerTrainingCells, (dopplers - 1) / 2);
+	const long long gd = std::min<long long>(parameters.dopplerGuardCells, wd);
+	const long long width = 2 * wd + 1;
+	const long long guardWidth = 2 * gd + 1;
+
+	// Power with the Doppler axis extended by wd cells on either side, so windows wrap.
+	const long long extended = dopplers + 2 * wd;
+	std::vector<float> power(rows * extended);
+	for (long long r = 0; r < rows; r++)
+		for (long long c = 0; c < extended; c++)
+		{
+			float value = map.values[r * dopplers + ((c - wd) % dopplers + dopplers) % dopplers];
+			power[r * extended + c] = map.decibels ? std::pow(10.f, value / 10.f) : value * value;
+		}
+
+	// Summed area table, rect() sums rows [r0, r1) and extended columns [c0, c1).
+	const long long stride = extended + 1;
+	std::vector<double> table((rows + 1) * stride, 0.0);
+	for (long long r = 0; r < rows; r++)
+	{
+		double rowSum = 0;
+		for (long long c = 0; c < extended; c++)
+		{
+			rowSum += power[r * extended + c];
+			table[(r + 1) * stride + c + 1] = table[r * stride + c + 1] + rowSum;
+		}
+	}
+	auto rect = [&](long long r0, long long r1, long long c0, long long c1)
+	{
+		return table[r1 * stride + c1] - table[r0 * stride + c1] - table[r1 * stride + c0] + table[r0 * stride + c0];
+	};
+
+	std::vector<float> threshold(rows * dopplers, infinity);
+	std::vector<float> noise(rows * dopplers, 0.f);
+	const long long fullCells = (2 * wr + 1) * width - (2 * g + 1) * guardWidth;
+	const long long halfCells = wr * width - g * guardWidth;
+
+	// ----------------- //
+	//  I N T E R I O R  //
+	// ----------------- //
+
+	// Rows with the full window in range.  Doppler bin d has its window at extended columns
+	// [d, d + width) and its guard at [d + wd - gd, d + wd + gd].  The method is resolved before
+	// the loops, so the loop over the Doppler bins is branch free and vectorises.
+	if (method == "CA" || method == "GO" || method == "SO")
+	{
+		// Rows are independent, chunks of them go to the executor threads.
+		const bool average = (method == "CA");
+		const bool greatest = (method == "GO");
+		const double scale = average ? cfarScale("CA", (unsigned)fullCells, parameters.pfa) : cfarScale(method, (unsigned)halfCells, parameters.pfa);
+		Executor& executor = Executor::shared();
+		size_t interior = (size_t)std::max(0LL, rows - 2 * wr);
+		executor.parallelFor("CFAR", interior, executor.grainFor(dopplers * (2 * sizeof(float) + 4 * sizeof(double))), [&](size_t first, size_t last, unsigned)
+		{
+			for (long long r = wr + (long long)first; r < wr + (long long)last; r++)
+			{
+				float* rowThreshold = &threshold[r * dopplers];
+				float* rowNoise = &noise[r * dopplers];
+				if (average)
+				{
+					for (long long d = 0; d < dopplers; d++)
+					{
+						double sum = rect(r - wr, r + wr + 1, d, d + width) - rect(r - g, r + g + 1, d + wd - gd, d + wd + gd + 1);
+						rowThreshold[d] = (float)(scale * sum);
+						rowNoise[d] = (float)(sum / fullCells);
+					}
+				}
+				else
+				{
+					for (long long d = 0; d < dopplers; d++)
+					{
+						double lag = rect(r - wr, r, d, d + width) - rect(r - g, r, d + wd - gd, d + wd + gd + 1);
+						double lead = rect(r + 1, r + wr + 1, d, d + width) - rect(r + 1, r + g + 1, d + wd - gd, d + wd + gd + 1);
+						double sum = greatest ? std::max(lag, lead) : std::min(lag, lead);
+						rowThreshold[d] = (float)(scale * sum);
+						rowNoise[d] = (float)(sum / halfCells);
+					}
+				}
+			}
+		}, parameters.threads);
+	}
+	else
+	{
+		// The window slides along range, so every Doppler column is a work item with its own
+		// sorted window.
+		const unsigned rank = osRank(parameters, fullCells);
+		const double scale = cfarScale("OS", (unsigned)fullCells, parameters.pfa, rank);
+		auto cell = [&](long long r, long long c) { return power[r * extended + c]; };
+		Executor& executor = Executor::shared();
+		std::vector<RunningSelection> windows(executor.threads());
+		executor.parallelFor("CFAR (OS)", (size_t)dopplers, 1, [&](size_t first, size_t last, unsigned thread)
+		{
+			RunningSelection& window = windows[thread];
+			for (long long d = (long long)first; d < (long long)last; d++)
+			{
+				window.clear();
+				for (long long r = wr; r < rows - wr; r++)
+				{
+					if (r == wr)
+					{
+						for (long long k = r - wr; k <= r + wr; k++)
+							for (long long c = d; c < d + width; c++)
+								if (std::abs(k - r) > g || std::abs(c - d - wd) > gd) window.insert(cell(k, c));
+					}
+					else
+					{
+						// The far lagging row leaves and a far leading row joins, the nearest lagging
+						// guard row becomes training and the nearest leading row becomes a guard row.
+						for (long long c = d; c < d + width; c++) window.replace(cell(r - wr - 1, c), cell(r + wr, c));
+						for (long long c = d + wd - gd; c <= d + wd + gd; c++) window.replace(cell(r + g, c), cell(r - g - 1, c));
+					}
+					float statistic = window.select(rank);
+					threshold[r * dopplers + d] = (float)(scale * statistic);
+					noise[r * dopplers + d] = statistic;
+				}
+			}
+		}, parameters.threads);
+	}
+
+	// ----------- //
+	//  E D G E S  //
+	// ----------- //
+
+	// Rows near the ends of the range axis average the rows that fit.
+	for (long long r = 0; r < rows; r++)
+	{
+		if (r >= wr && r < rows - wr) continue;
+		long long r0 = std::max(0LL, r - wr);
+		long long r1 = std::min(rows, r + wr + 1);
+		long long g0 = std::max(0LL, r - g);
+		long long g1 = std::min(rows, r + g + 1);
+		long long cells = (r1 - r0) * width - (g1 - g0) * guardWidth;
+		if (cells <= 0) continue;
+		double scale = cfarScale("CA", (unsigned)cells, parameters.pfa);
+		for (long long d = 0; d < dopplers; d++)
+		{
+			double sum = rect(r0, r1, d, d + width) - rect(g0, g1, d + wd - gd, d + wd + gd + 1);
+			threshold[r * dopplers + d] = (float)(scale * sum);
+			noise[r * dopplers + d] = (float)(sum / cells);
+		}
+	}
+
+	// --------------------- //
+	//  D E T E C T I O N S  //
+	// --------------------- //
+
+	auto at = [&](long long r, long long d) { return power[r * extended + ((d % dopplers + dopplers) % dopplers) + wd]; };
+	std::vector<Detection> detections;
+	for (long long r = 0; r < rows; r++)
+	{
+		for (long long d = 0; d < dopplers; d++)
+		{
+			float value = at(r, d);
+			if (!(value > threshold[r * dopplers + d])) continue;
+			if (parameters.peaksOnly)
+			{
+				// Neighbours before the cell have to be lower, after it not higher, so plateaus
+				// report one cell.
+				bool peak = true;
+				for (long long dr = -1; dr <= 1 && peak; dr++)
+					for (long long dd = -1; dd <= 1 && peak; dd++)
+					{
+						if ((!dr && !dd) || r + dr < 0 || r + dr >= rows) continue;
+						float neighbour = at(r + dr, d + dd);
+						bool before = (dr < 0) || (dr == 0 && dd < 0);
+						if (before ? neighbour >= value : neighbour > value) peak = false;
+					}
+				if (!peak) continue;
+			}
+			Detection detection;
+			detection.range = (size_t)r;
+			detection.doppler = (size_t)d;
+			detection.rangePosition = r + ((r > 0 && r + 1 < rows) ? interpolatePeak(at(r - 1, d), value, at(r + 1, d)) : 0.f);
+			detection.dopplerPosition = d + interpolatePeak(at(r, d - 1), value, at(r, d + 1));
+			detection.power = value;
+			detection.snr = 10.f * std::log10(value / std::max(noise[r * dopplers + d], 1e-30f));
+			detections.push_back(detection);
+		}
+	}
+	return detections;
+}
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
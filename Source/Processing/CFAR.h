@@ -0,0 +1,68 @@
+#pragma once
+
+/*
+* Constant false alarm rate (CFAR) detection on compressed data, along range or over a
+* range-Doppler map.  The noise around every cell under test is estimated from training cells
+* outside of a guard region, by cell averaging (CA), the greatest-of or smallest-of the two
+* range sides (GO, SO) or an ordered statistic (OS).  The threshold scale follows from the Pfa
+* for square law detected noise.  Detections are returned as a compact list.
+*/
+
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include <vector>
+#include <span>
+#include <string>
+#include "RangeDoppler.h"
+#include "Executor.h"
+
+// ================================================================================================================================================================================ //
+//  Types.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+struct CFARParameters
+{
+	std::string method = "CA";			// "CA", "GO", "SO" or "OS".
+	unsigned guardCells = 2;			// Guard cells on either side of the cell under test, in range.
+	unsigned trainingCells = 16;		// Training cells on either side, in range.
+	unsigned dopplerGuardCells = 1;		// Guard cells on either side in Doppler, for maps.
+	unsigned dopplerTrainingCells = 4;	// Training cells on either side in Doppler, for maps.
+	double pfa = 1e-6;					// Probability of false alarm per cell.
+	float osRank = 0.75f;				// OS: rank of the training cell used as the noise, as a fraction of the training cells.
+	bool peaksOnly = true;				// Only report detections that are local maxima, one per target.
+	unsigned threads = 0;				// Threads of the shared executor used for maps, 0 uses all of them.
+};
+
+struct Detection
+{
+	size_t range = 0;					// Range bin.
+	size_t doppler = 0;					// Doppler bin, 0 for detection along range.
+	float rangePosition = 0;			// Range bin interpolated between the neighbouring cells.
+	float dopplerPosition = 0;			// Doppler bin interpolated between the neighbouring cells.
+	float power = 0;					// Power of the cell.
+	float snr = 0;						// Power over the noise estimate [dB].
+};
+
+// ================================================================================================================================================================================ //
+//  Detection.                                                                                                                                                                      //
+// ================================================================================================================================================================================ //
+
+// Detect along a line of square law detected (power) samples, e.g. one compressed pulse.  Cells
+// without a full window on both sides are tested with cell averaging on the side that fits.
+std::vector<Detection> detectRange(std::span<const float> power, const CFARParameters& parameters = CFARParameters());
+
+// Detect over a range-Doppler map, dB or magnitude.  The Doppler axis wraps around, range does
+// not, and cells without a full window in range are tested with cell averaging on what fits.
+// GO and SO compare the nearer and further range halves of the training window.
+std::vector<Detection> detectRangeDoppler(const RangeDopplerMap& map, const CFARParameters& parameters = CFARParameters());
+
+// The factor the noise estimate (a sum of cells for CA, GO and SO, a single cell for OS) is
+// multiplied with to get the threshold for the Pfa.  cells is the number of training cells
+// (per side for GO and SO).
+double cfarScale(const std::string& method, unsigned cells, double pfa, unsigned rank = 0);
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
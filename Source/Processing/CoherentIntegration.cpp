@@ -0,0 +1,104 @@
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include "CoherentIntegration.h"
+#include <algorithm>
+#include <stdexcept>
+
+// ================================================================================================================================================================================ //
+//  Setup.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+namespace
+{
+	// Samples rounded up to whole alignment blocks, so the kernels never run past the end.
+	size_t paddedSize(size_t floats, size_t alignment)
+	{
+		size_t block = alignment / sizeof(float);
+		return ((floats + block - 1) / block) * block;
+	}
+}
+
+CoherentIntegrator::CoherentIntegrator(size_t priSamples, size_t pris, bool variance, const std::string& file)
+	: m_priSamples(priSamples), m_pris(pris), m_variance(variance)
+{
+	if (!priSamples || !pris) throw std::invalid_argument("Coherent integration needs a PRI and a number of PRIs.");
+	size_t sumSize = paddedSize(2 * priSamples, alignment);
+	m_sum.reset(static_cast<float*>(::operator new(sumSize * sizeof(float), std::align_val_t(alignment))));
+	std::fill_n(m_sum.get(), sumSize, 0.f);
+	if (m_variance)
+	{
+		size_t powerSize = paddedSize(priSamples, alignment);
+		m_power.reset(static_cast<float*>(::operator new(powerSize * sizeof(float), std::align_val_t(alignment))));
+		std::fill_n(m_power.get(), powerSize, 0.f);
+	}
+	m_record.resize(2 * priSamples + (m_variance ? priSamples : 0));
+	m_file.open(file, std::ofstream::binary);
+	m_open = m_file.is_open();
+}
+
+// ================================================================================================================================================================================ //
+//  Integration.                                                                                                                                                                    //
+// ================================================================================================================================================================================ //
+
+void CoherentIntegrator::push(std::span<const std::complex<float>> samples)
+{
+	const float* input = reinterpret_cast<const float*>(samples.data());
+	size_t remaining = samples.size();
+	while (remaining)
+	{
+		// Up to the end of the current PRI.
+		size_t count = std::min(remaining, m_priSamples - m_position);
+		float* sum = m_sum.get() + 2 * m_position;
+		for (size_t i = 0; i < 2 * count; i++) sum[i] += input[i];
+		if (m_variance)
+		{
+			float* power = m_power.get() + m_position;
+			for (size_t i = 0; i < count; i++) power[i] += input[2 * i] * input[2 * i] + input[2 * i + 1] * input[2 * i + 1];
+		}
+		input += 2 * count;
+		remaining -= count;
+		m_position += count;
+
+		if (m_position == m_priSamples)
+		{
+			m_position = 0;
+			if (++m_count == m_pris) writeRecord();
+		}
+	}
+}
+
+void CoherentIntegrator::writeRecord()
+{
+	const float scale = 1.f / m_pris;
+	const size_t floats = 2 * m_priSamples;
+	float* sum = m_sum.get();
+	for (size_t i = 0; i < floats; i++) m_record[i] = sum[i] * scale;
+	if (m_variance)
+	{
+		// E|x|^2 - |E x|^2 per range bin, rounding can leave it just below zero.
+		float* power = m_power.get();
+		float* variance = m_record.data() + floats;
+		for (size_t i = 0; i < m_priSamples; i++)
+		{
+			float re = m_record[2 * i];
+			float im = m_record[2 * i + 1];
+			variance[i] = std::max(0.f, power[i] * scale - (re * re + im * im));
+		}
+		std::fill_n(power, m_priSamples, 0.f);
+	}
+	std::fill_n(sum, floats, 0.f);
+	if (m_open) m_file.write((const char*)m_record.data(), m_record.size() * sizeof(float));
+	m_records++;
+	m_count = 0;
+}
+
+void CoherentIntegrator::finish()
+{
+	if (m_file.is_open()) m_file.close();
+}
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
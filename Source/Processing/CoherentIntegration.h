@@ -0,0 +1,75 @@
+#pragma once
+
+/*
+* Coherent integration of PRIs while capturing.  Every N consecutive PRIs are summed sample by
+* sample into one accumulator and only their average is written, optionally with the variance
+* of every range bin over the N PRIs.  The output rate drops N-fold and the SNR of a target
+* that stays in its range bin improves by up to 10 log10(N) dB.
+*
+* The file holds one record per N PRIs: the average PRI (fc32, I Q I Q) followed by the
+* variance of every sample (f32) when it is enabled.
+*/
+
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include <vector>
+#include <complex>
+#include <span>
+#include <string>
+#include <fstream>
+#include <memory>
+#include <new>
+
+// ================================================================================================================================================================================ //
+//  Integrator.                                                                                                                                                                     //
+// ================================================================================================================================================================================ //
+
+class CoherentIntegrator
+{
+public:
+
+	// Alignment of the accumulators [bytes].
+	static const size_t alignment = 64;
+
+	CoherentIntegrator(size_t priSamples, size_t pris, bool variance, const std::string& file);
+
+	bool isOpen() const { return m_open; }
+	size_t priSamples() const { return m_priSamples; }
+	size_t pris() const { return m_pris; }
+
+	// Called by the RX thread with every buffer, in order.  The first sample of the stream is the
+	// first sample of a PRI.
+	void push(std::span<const std::complex<float>> samples);
+	// Close the file.  PRIs of an incomplete group at the end are not written.
+	void finish();
+
+	size_t records() const { return m_records; }
+	size_t samplesDiscarded() const { return m_count * m_priSamples + m_position; }
+
+private:
+
+	struct AlignedDelete
+	{
+		void operator()(float* data) const { ::operator delete(data, std::align_val_t(alignment)); }
+	};
+
+	size_t m_priSamples;
+	size_t m_pris;
+	bool m_variance;
+	std::unique_ptr<float[], AlignedDelete> m_sum;		// Sum of the PRIs, I Q interleaved.
+	std::unique_ptr<float[], AlignedDelete> m_power;	// Sum of |x|^2, when the variance is kept.
+	size_t m_position = 0;								// Sample of the current PRI.
+	size_t m_count = 0;									// PRIs summed in the current group.
+	size_t m_records = 0;
+	std::vector<float> m_record;
+	std::ofstream m_file;
+	bool m_open = false;
+
+	void writeRecord();
+};
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
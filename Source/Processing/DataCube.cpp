@@ -0,0 +1,104 @@
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include "DataCube.h"
+#include "Transpose.h"
+#include <algorithm>
+#include <string>
+
+// ================================================================================================================================================================================ //
+//  Storage.                                                                                                                                                                        //
+// ================================================================================================================================================================================ //
+
+DataCube::DataCube(size_t rangeBins, size_t pulses, size_t channels, CubeLayout layout)
+	: m_rangeBins(rangeBins), m_pulses(pulses), m_channels(channels), m_layout(layout)
+{
+	allocate();
+	clear();
+}
+
+DataCube::DataCube(const DataCube& other)
+	: m_rangeBins(other.m_rangeBins), m_pulses(other.m_pulses), m_channels(other.m_channels), m_layout(other.m_layout)
+{
+	allocate();
+	if (m_data) std::copy_n(other.m_data.get(), storageSize(), m_data.get());
+}
+
+DataCube& DataCube::operator=(const DataCube& other)
+{
+	if (this != &other) *this = DataCube(other);
+	return *this;
+}
+
+void DataCube::allocate()
+{
+	// Lines are padded to a whole number of alignment blocks.
+	const size_t samplesPerBlock = alignment / sizeof(std::complex<float>);
+	m_lineStride = ((lineLength() + samplesPerBlock - 1) / samplesPerBlock) * samplesPerBlock;
+	m_data.reset();
+	if (!storageSize()) return;
+	m_data.reset(static_cast<std::complex<float>*>(::operator new(storageSize() * sizeof(std::complex<float>), std::align_val_t(alignment))));
+}
+
+void DataCube::clear()
+{
+	if (m_data) std::fill_n(m_data.get(), storageSize(), std::complex<float>(0, 0));
+}
+
+// ================================================================================================================================================================================ //
+//  Layout.                                                                                                                                                                         //
+// ================================================================================================================================================================================ //
+
+void DataCube::setLayout(CubeLayout layout)
+{
+	if (layout == m_layout) return;
+
+	// Every channel is a matrix of lines, the lines of one layout are the columns of the other.
+	// A square cube keeps its stride and is transposed in place.
+	if (m_rangeBins == m_pulses)
+	{
+		for (size_t channel = 0; channel < m_channels; channel++) transposeSquare(line(0, channel).data(), m_rangeBins, m_lineStride);
+		m_layout = layout;
+		return;
+	}
+	DataCube reordered(m_rangeBins, m_pulses, m_channels, layout);
+	for (size_t channel = 0; channel < m_channels; channel++)
+		transpose(line(0, channel).data(), lines(), lineLength(), m_lineStride, reordered.line(0, channel).data(), reordered.m_lineStride);
+	*this = std::move(reordered);
+}
+
+// ================================================================================================================================================================================ //
+//  Loading.                                                                                                                                                                        //
+// ================================================================================================================================================================================ //
+
+size_t DataCube::loadPRIs(std::span<const std::complex<float>> capture, size_t priSamples, size_t channel)
+{
+	if (channel >= m_channels) throw std::out_of_range("Data cube has no channel " + std::to_string(channel) + ".");
+	size_t samples = std::min(priSamples, m_rangeBins);
+	size_t loaded = 0;
+
+	// Range major: the whole PRIs of the capture are a matrix that is transposed into the cube.
+	size_t first = 0;
+	if (m_layout == CubeLayout::RangeMajor && samples && capture.size() >= samples)
+	{
+		first = std::min(m_pulses, (capture.size() - samples) / priSamples + 1);
+		transpose(capture.data(), first, samples, priSamples, line(0, channel).data(), m_lineStride);
+		for (size_t range = samples; range < m_rangeBins; range++) std::fill_n(line(range, channel).data(), first, std::complex<float>(0, 0));
+		loaded = first;
+	}
+	for (size_t pulse = first; pulse < m_pulses; pulse++)
+	{
+		StridedView<std::complex<float>> destination = rangeLine(pulse, channel);
+		size_t begin = pulse * priSamples;
+		size_t count = (begin < capture.size()) ? std::min(samples, capture.size() - begin) : 0;
+		if (count == samples) loaded++;
+		for (size_t range = 0; range < count; range++) destination[range] = capture[begin + range];
+		for (size_t range = count; range < m_rangeBins; range++) destination[range] = std::complex<float>(0, 0);
+	}
+	return loaded;
+}
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
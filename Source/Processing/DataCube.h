@@ -0,0 +1,126 @@
+#pragma once
+
+/*
+* Radar data cube of channels x pulses x range bins in one aligned allocation.  The layout is
+* explicit: pulse major keeps the range samples of a pulse together (fast time, as received),
+* range major keeps the pulses of a range bin together (slow time, for Doppler processing).
+* Lines are padded to the alignment so that every range line or Doppler column starts aligned.
+*/
+
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include <complex>
+#include <span>
+#include <memory>
+#include <new>
+#include <stdexcept>
+
+// ================================================================================================================================================================================ //
+//  Views.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+// A line through the cube, which is contiguous when the stride is 1.
+template <typename T>
+struct StridedView
+{
+	T* data = nullptr;
+	size_t count = 0;
+	size_t stride = 1;
+
+	T& operator[](size_t index) const { return data[index * stride]; }
+	size_t size() const { return count; }
+	bool contiguous() const { return stride == 1; }
+	// Only valid for contiguous views.
+	std::span<T> span() const { return { data, count }; }
+};
+
+// ================================================================================================================================================================================ //
+//  Cube.                                                                                                                                                                           //
+// ================================================================================================================================================================================ //
+
+enum class CubeLayout
+{
+	PulseMajor,		// [channel][pulse][range], range lines are contiguous.
+	RangeMajor		// [channel][range][pulse], Doppler columns are contiguous.
+};
+
+class DataCube
+{
+public:
+
+	// Alignment of the allocation and of every line [bytes].
+	static const size_t alignment = 64;
+
+	DataCube() = default;
+	DataCube(size_t rangeBins, size_t pulses, size_t channels = 1, CubeLayout layout = CubeLayout::PulseMajor);
+	DataCube(const DataCube& other);
+	DataCube& operator=(const DataCube& other);
+	DataCube(DataCube&& other) noexcept = default;
+	DataCube& operator=(DataCube&& other) noexcept = default;
+
+	size_t rangeBins() const { return m_rangeBins; }
+	size_t pulses() const { return m_pulses; }
+	size_t channels() const { return m_channels; }
+	CubeLayout layout() const { return m_layout; }
+	bool empty() const { return !m_data; }
+
+	// Samples between the starts of consecutive lines, the line length padded to the alignment.
+	size_t lineStride() const { return m_lineStride; }
+	// Number of lines in a channel, pulses for pulse major and range bins for range major.
+	size_t lines() const { return (m_layout == CubeLayout::PulseMajor) ? m_pulses : m_rangeBins; }
+	// Samples in a line, range bins for pulse major and pulses for range major.
+	size_t lineLength() const { return (m_layout == CubeLayout::PulseMajor) ? m_rangeBins : m_pulses; }
+	// Line of the channel in the storage order, contiguous whatever the layout.
+	std::span<std::complex<float>> line(size_t index, size_t channel = 0) { return { m_data.get() + (channel * lines() + index) * m_lineStride, lineLength() }; }
+	std::span<const std::complex<float>> line(size_t index, size_t channel = 0) const { return { m_data.get() + (channel * lines() + index) * m_lineStride, lineLength() }; }
+
+	std::complex<float>& at(size_t range, size_t pulse, size_t channel = 0) { return m_data[offset(range, pulse, channel)]; }
+	const std::complex<float>& at(size_t range, size_t pulse, size_t channel = 0) const { return m_data[offset(range, pulse, channel)]; }
+
+	// Fast time samples of one pulse.
+	StridedView<std::complex<float>> rangeLine(size_t pulse, size_t channel = 0) { return { &at(0, pulse, channel), m_rangeBins, (m_layout == CubeLayout::PulseMajor) ? 1 : m_lineStride }; }
+	StridedView<const std::complex<float>> rangeLine(size_t pulse, size_t channel = 0) const { return { &at(0, pulse, channel), m_rangeBins, (m_layout == CubeLayout::PulseMajor) ? 1 : m_lineStride }; }
+	// Slow time samples of one range bin.
+	StridedView<std::complex<float>> dopplerColumn(size_t range, size_t channel = 0) { return { &at(range, 0, channel), m_pulses, (m_layout == CubeLayout::RangeMajor) ? 1 : m_lineStride }; }
+	StridedView<const std::complex<float>> dopplerColumn(size_t range, size_t channel = 0) const { return { &at(range, 0, channel), m_pulses, (m_layout == CubeLayout::RangeMajor) ? 1 : m_lineStride }; }
+
+	// Reorder the samples to the layout with the blocked transpose, in place when the cube has as
+	// many pulses as range bins.
+	void setLayout(CubeLayout layout);
+
+	// Fill the channel with back to back PRIs of a capture, starting at the first sample.  A
+	// range major cube is filled with the blocked transpose.  Returns the number of pulses
+	// loaded, pulses missing at the end of the capture are zeroed.
+	size_t loadPRIs(std::span<const std::complex<float>> capture, size_t priSamples, size_t channel = 0);
+
+	// Set every sample, including the padding, to zero.
+	void clear();
+
+private:
+
+	struct AlignedDelete
+	{
+		void operator()(std::complex<float>* data) const { ::operator delete(data, std::align_val_t(alignment)); }
+	};
+
+	size_t m_rangeBins = 0;
+	size_t m_pulses = 0;
+	size_t m_channels = 0;
+	CubeLayout m_layout = CubeLayout::PulseMajor;
+	size_t m_lineStride = 0;
+	std::unique_ptr<std::complex<float>[], AlignedDelete> m_data;
+
+	size_t offset(size_t range, size_t pulse, size_t channel) const
+	{
+		if (m_layout == CubeLayout::PulseMajor) return (channel * m_pulses + pulse) * m_lineStride + range;
+		return (channel * m_rangeBins + range) * m_lineStride + pulse;
+	}
+	size_t storageSize() const { return m_channels * lines() * m_lineStride; }
+	void allocate();
+};
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
@@ -0,0 +1,130 @@
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include "Dechirp.h"
+#include "../Utils/ComplexKernels.h"
+#include "../Utils/WindowFunctions.h"
+#include <cmath>
+#include <numbers>
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+// ================================================================================================================================================================================ //
+//  Setup.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+double beatFrequency(double sweepRate, double range)
+{
+	const double c = 299792458;
+	return sweepRate * 2 * range / c;
+}
+
+size_t dechirpDecimation(double samplingFreq, double maxBeat, size_t alignSamples)
+{
+	// The beats are complex, from -maxBeat to maxBeat.
+	size_t largest = (maxBeat > 0) ? (size_t)std::floor(samplingFreq / (2 * 1.25 * maxBeat)) : alignSamples;
+	largest = std::max<size_t>(largest, 1);
+	if (!alignSamples) return largest;
+	largest = std::min(largest, alignSamples);
+	while (alignSamples % largest) largest--;
+	return largest;
+}
+
+// ================================================================================================================================================================================ //
+//  Stage.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+DechirpStage::DechirpStage(std::span<const std::complex<float>> reference, size_t decimation, const DechirpParameters& parameters)
+	: m_reference(reference.begin(), reference.end()), m_decimation(decimation)
+{
+	if (reference.empty() || !decimation) throw std::invalid_argument("Dechirping needs a reference ramp and a decimation.");
+	if (!parameters.tapsPerOutput || parameters.passband <= 0 || parameters.passband > 1) throw std::invalid_argument("The dechirp low pass needs taps and a passband up to the decimated Nyquist frequency.");
+
+	m_phase = parameters.referenceOffset % m_reference.size();
+
+	// Windowed sinc low pass with unity gain at DC, cutoff in cycles per input sample.
+	m_tapCount = parameters.tapsPerOutput * m_decimation + 1;
+	const std::vector<float>& window = getWindow(parameters.window, (int)m_tapCount, WindowParameters());
+	const double cutoff = parameters.passband * 0.5 / m_decimation;
+	const double centre = (m_tapCount - 1) / 2.0;
+	std::vector<double> taps(m_tapCount);
+	double sum = 0;
+	for (size_t k = 0; k < m_tapCount; k++)
+	{
+		double x = 2 * cutoff * (k - centre);
+		taps[k] = 2 * cutoff * ((x == 0) ? 1 : std::sin(std::numbers::pi * x) / (std::numbers::pi * x)) * window[k];
+		sum += taps[k];
+	}
+
+	// Interleaved for the I and Q of the samples, with zeros up to a multiple of 4 floats so the
+	// dot product runs in four independent sums.
+	size_t padded = m_tapCount + (m_tapCount % 2);
+	m_taps.assign(2 * padded, 0.f);
+	for (size_t k = 0; k < m_tapCount; k++) m_taps[2 * k] = m_taps[2 * k + 1] = (float)(taps[k] / sum);
+
+	// Half a filter of zeros before the stream centres output n on input n * decimation.
+	m_mixed.assign((m_tapCount - 1) / 2, std::complex<float>(0, 0));
+}
+
+void DechirpStage::process(std::span<const std::complex<float>> input, std::vector<std::complex<float>>& output)
+{
+	output.clear();
+	m_samplesIn += input.size();
+
+	// ----------- //
+	//  M I X E R  //
+	// ----------- //
+
+	// In runs up to the end of the reference period.
+	size_t start = m_mixed.size();
+	m_mixed.resize(start + input.size());
+	for (size_t done = 0; done < input.size();)
+	{
+		size_t run = std::min(input.size() - done, m_reference.size() - m_phase);
+		complexConjugateMultiply(input.subspan(done, run), std::span<const std::complex<float>>(m_reference).subspan(m_phase, run), std::span(m_mixed).subspan(start + done, run));
+		done += run;
+		m_phase = (m_phase + run) % m_reference.size();
+	}
+
+	// --------------------- //
+	//  D E C I M A T I O N  //
+	// --------------------- //
+
+	// The full FIR is evaluated at every kept output only, the outputs in between are skipped.
+	const size_t padded = m_taps.size() / 2;
+	const float* taps = m_taps.data();
+	output.reserve((m_mixed.size() - std::min(m_mixed.size(), m_next)) / m_decimation + 1);
+	while (m_next + padded <= m_mixed.size())
+	{
+		const float* x = (const float*)(m_mixed.data() + m_next);
+		float sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+		for (size_t k = 0; k < m_taps.size(); k += 4)
+		{
+			sum0 += taps[k] * x[k];
+			sum1 += taps[k + 1] * x[k + 1];
+			sum2 += taps[k + 2] * x[k + 2];
+			sum3 += taps[k + 3] * x[k + 3];
+		}
+		output.emplace_back(sum0 + sum2, sum1 + sum3);
+		m_next += m_decimation;
+	}
+	m_samplesOut += output.size();
+
+	// Keep the samples the next outputs still need.
+	size_t used = std::min(m_next, m_mixed.size());
+	m_mixed.erase(m_mixed.begin(), m_mixed.begin() + used);
+	m_next -= used;
+}
+
+std::string DechirpStage::describe() const
+{
+	std::ostringstream text;
+	text << "decimation " << m_decimation << ", " << m_tapCount << " taps, " << periodSamples() << " samples per sweep";
+	return text.str();
+}
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
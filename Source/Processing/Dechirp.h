@@ -0,0 +1,79 @@
+#pragma once
+
+/*
+* Stretch processing of an FMCW stream while capturing.  The received samples are mixed with the
+* conjugate of the transmitted ramp, which turns the echo of every range into a tone at its beat
+* frequency, sweep rate times delay.  Only the beats up to the maximum range are of interest, so
+* the mixed stream is low pass filtered and decimated to that bandwidth before it is stored or
+* transformed, a small fraction of the samples of the wideband stream.  The low pass is a direct
+* form windowed sinc FIR that is only evaluated at the kept outputs, not a polyphase filter.
+*/
+
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include <vector>
+#include <complex>
+#include <span>
+#include <string>
+
+// ================================================================================================================================================================================ //
+//  Setup.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+struct DechirpParameters
+{
+	size_t tapsPerOutput = 8;			// Low pass taps per decimated sample, the filter has tapsPerOutput * decimation + 1.
+	float passband = 0.8f;				// Cutoff of the low pass as a fraction of the decimated Nyquist frequency.
+	std::string window = "Blackman";	// Window of the low pass.
+	size_t referenceOffset = 0;			// Sample of the ramp at the start of the stream.
+};
+
+// Beat frequency [Hz] of an echo from range [m] for a ramp sweeping sweepRate [Hz/s].
+double beatFrequency(double sweepRate, double range);
+
+// The largest decimation that keeps beats up to maxBeat [Hz] with 25 % margin, and that divides
+// alignSamples (the samples of one sweep) so every sweep gives a whole number of samples.
+size_t dechirpDecimation(double samplingFreq, double maxBeat, size_t alignSamples);
+
+// ================================================================================================================================================================================ //
+//  Stage.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+class DechirpStage
+{
+public:
+
+	// The reference is one period of the transmitted ramp, it repeats for the whole stream.
+	DechirpStage(std::span<const std::complex<float>> reference, size_t decimation, const DechirpParameters& parameters = DechirpParameters());
+
+	// The decimated beat samples of the input replace the contents of output.  Output sample n
+	// is centred on input sample n * decimation.
+	void process(std::span<const std::complex<float>> input, std::vector<std::complex<float>>& output);
+
+	size_t decimation() const { return m_decimation; }
+	// Decimated samples per period of the ramp.
+	size_t periodSamples() const { return m_reference.size() / m_decimation; }
+	size_t taps() const { return m_tapCount; }
+	size_t samplesIn() const { return m_samplesIn; }
+	size_t samplesOut() const { return m_samplesOut; }
+	// E.g. "decimation 40, 321 taps, 600 samples per sweep".
+	std::string describe() const;
+
+private:
+
+	std::vector<std::complex<float>> m_reference;
+	size_t m_decimation;
+	size_t m_tapCount;
+	std::vector<float> m_taps;						// Every tap twice, for the I and Q of a sample, padded to a multiple of 4.
+	std::vector<std::complex<float>> m_mixed;		// Mixed samples the filter has not passed yet.
+	size_t m_phase = 0;								// Sample of the reference of the next input sample.
+	size_t m_next = 0;								// First mixed sample of the next output.
+	size_t m_samplesIn = 0;
+	size_t m_samplesOut = 0;
+};
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
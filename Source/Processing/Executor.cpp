@@ -0,0 +1,400 @@
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include "Executor.h"
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <iomanip>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <fstream>
+#include <filesystem>
+#include <map>
+#endif
+
+// ================================================================================================================================================================================ //
+//  System.                                                                                                                                                                         //
+// ================================================================================================================================================================================ //
+
+namespace
+{
+	double seconds(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	unsigned long long packRange(size_t begin, size_t end) { return ((unsigned long long)begin << 32) | (unsigned long long)end; }
+	size_t rangeBegin(unsigned long long range) { return (size_t)(range >> 32); }
+	size_t rangeEnd(unsigned long long range) { return (size_t)(range & 0xffffffffull); }
+
+	// Pin the calling thread to one logical core.
+	bool pinThread(unsigned core)
+	{
+#ifdef _WIN32
+		if (core >= 8 * sizeof(DWORD_PTR)) return false;
+		return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << core) != 0;
+#else
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(core, &set);
+		return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#endif
+	}
+
+	// The first logical core of every physical core, in order, so that threads pinned to them do
+	// not share a core with an SMT sibling.  Every logical core when the system does not say.
+	std::vector<unsigned> physicalCoreList()
+	{
+		std::vector<unsigned> cores;
+#ifdef _WIN32
+		DWORD bytes = 0;
+		GetLogicalProcessorInformation(nullptr, &bytes);
+		std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> information(bytes / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+		if (information.size() && GetLogicalProcessorInformation(information.data(), &bytes))
+			for (const SYSTEM_LOGICAL_PROCESSOR_INFORMATION& entry : information)
+				if (entry.Relationship == RelationProcessorCore && entry.ProcessorMask)
+				{
+					unsigned first = 0;
+					while (!(entry.ProcessorMask & ((ULONG_PTR)1 << first))) first++;
+					cores.push_back(first);
+				}
+#else
+		// Logical cores with the same package and core id are SMT siblings.
+		std::map<std::pair<int, int>, unsigned> firstOfCore;
+		std::error_code error;
+		for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator("/sys/devices/system/cpu", error))
+		{
+			std::string name = entry.path().filename().string();
+			if (name.size() < 4 || name.compare(0, 3, "cpu") || name.find_first_not_of("0123456789", 3) != std::string::npos) continue;
+			int package = -1, core = -1;
+			std::ifstream(entry.path() / "topology" / "physical_package_id") >> package;
+			std::ifstream(entry.path() / "topology" / "core_id") >> core;
+			if (package < 0 || core < 0) continue;
+			unsigned cpu = (unsigned)std::stoul(name.substr(3));
+			auto found = firstOfCore.emplace(std::make_pair(package, core), cpu);
+			if (!found.second) found.first->second = std::min(found.first->second, cpu);
+		}
+		for (const auto& core : firstOfCore) cores.push_back(core.second);
+#endif
+		std::sort(cores.begin(), cores.end());
+		if (cores.empty())
+			for (unsigned cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); cpu++) cores.push_back(cpu);
+		return cores;
+	}
+
+	// Set on the threads while they run a chunk, so nested loops run in place.
+	thread_local bool insideChunk = false;
+	thread_local unsigned chunkThread = 0;
+
+	std::unique_ptr<Executor>& sharedExecutor()
+	{
+		static std::unique_ptr<Executor> executor;
+		return executor;
+	}
+	std::mutex sharedMutex;
+}
+
+unsigned physicalCores()
+{
+	return (unsigned)physicalCoreList().size();
+}
+
+size_t level2CacheBytes()
+{
+	const size_t fallback = 1 << 20;
+#ifdef _WIN32
+	DWORD bytes = 0;
+	GetLogicalProcessorInformation(nullptr, &bytes);
+	std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> information(bytes / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+	if (information.empty() || !GetLogicalProcessorInformation(information.data(), &bytes)) return fallback;
+	for (const SYSTEM_LOGICAL_PROCESSOR_INFORMATION& entry : information)
+		if (entry.Relationship == RelationCache && entry.Cache.Level == 2 && entry.Cache.Size) return entry.Cache.Size;
+	return fallback;
+#elif defined(_SC_LEVEL2_CACHE_SIZE)
+	long size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+	return (size > 0) ? (size_t)size : fallback;
+#else
+	return fallback;
+#endif
+}
+
+// ================================================================================================================================================================================ //
+//  Setup.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+Executor::Executor(const ExecutorParameters& parameters)
+{
+	std::vector<unsigned> physical = physicalCoreList();
+	unsigned cores = (unsigned)physical.size();
+	unsigned available = (cores > parameters.reservedCores) ? cores - parameters.reservedCores : 1u;
+	m_threads = std::max(1u, parameters.threads ? parameters.threads : available);
+	m_cacheBytes = parameters.cacheBytes ? parameters.cacheBytes : level2CacheBytes();
+	m_pinned = parameters.pinning == "Enabled";
+	m_slots.reset(new Slot[m_threads]);
+
+	// The caller is thread 0 and is never pinned, worker n goes on the n-th physical core after
+	// the reserved ones, on the first of its logical cores.
+	for (unsigned t = 1; t < m_threads; t++)
+	{
+		unsigned core = physical[(parameters.reservedCores + t) % physical.size()];
+		m_workers.emplace_back([this, t, core]()
+		{
+			if (m_pinned) pinThread(core);
+			work(t);
+		});
+	}
+}
+
+Executor::~Executor()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_start.notify_all();
+	for (std::thread& worker : m_workers) worker.join();
+}
+
+Executor& Executor::shared()
+{
+	std::lock_guard<std::mutex> lock(sharedMutex);
+	std::unique_ptr<Executor>& executor = sharedExecutor();
+	if (!executor) executor = std::make_unique<Executor>();
+	return *executor;
+}
+
+void Executor::configure(const ExecutorParameters& parameters)
+{
+	std::lock_guard<std::mutex> lock(sharedMutex);
+	sharedExecutor() = std::make_unique<Executor>(parameters);
+}
+
+size_t Executor::grainFor(size_t bytesPerItem) const
+{
+	return std::max<size_t>(1, (m_cacheBytes / 2) / std::max<size_t>(1, bytesPerItem));
+}
+
+// ================================================================================================================================================================================ //
+//  Loops.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+void Executor::parallelFor(const std::string& name, size_t count, size_t grain, const Body& body, unsigned maxThreads)
+{
+	if (!count) return;
+	grain = std::max<size_t>(1, grain);
+	// The chunk indices have to fit in half of a range.
+	grain = std::max(grain, (count >> 32) + 1);
+	size_t chunks = (count + grain - 1) / grain;
+	if (insideChunk)
+	{
+		body(0, count, chunkThread);
+		return;
+	}
+
+	// A loop on one thread runs in place, so callers that have their own threads, e.g. the
+	// streaming compression, do not wait on each other.
+	auto start = std::chrono::steady_clock::now();
+	unsigned limit = maxThreads ? std::min(maxThreads, m_threads) : m_threads;
+	unsigned participants = (unsigned)std::min<size_t>(limit, chunks);
+	if (participants <= 1)
+	{
+		insideChunk = true;
+		chunkThread = 0;
+		try { body(0, count, 0); }
+		catch (...) { insideChunk = false; throw; }
+		insideChunk = false;
+		double elapsed = seconds(start);
+		std::lock_guard<std::mutex> lock(m_timingMutex);
+		TaskTiming& timing = m_timings[name];
+		timing.calls++;
+		timing.items += count;
+		timing.chunks++;
+		timing.threads = 1;
+		timing.wallSeconds += elapsed;
+		timing.busySeconds += elapsed;
+		return;
+	}
+
+	std::lock_guard<std::mutex> submit(m_submit);
+	start = std::chrono::steady_clock::now();
+	for (unsigned t = 0; t < m_threads; t++)
+	{
+		size_t begin = (t < participants) ? chunks * t / participants : 0;
+		size_t end = (t < participants) ? chunks * (t + 1) / participants : 0;
+		m_slots[t].range.store(packRange(begin, end));
+		m_slots[t].chunks = 0;
+		m_slots[t].steals = 0;
+		m_slots[t].busySeconds = 0;
+	}
+	m_body = &body;
+	m_count = count;
+	m_grain = grain;
+	m_error = nullptr;
+	m_failed = false;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_participants = participants;
+		m_running = participants - 1;
+		m_generation++;
+	}
+	m_start.notify_all();
+	participate(0);
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_done.wait(lock, [this]() { return m_running == 0; });
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_timingMutex);
+		TaskTiming& timing = m_timings[name];
+		timing.calls++;
+		timing.items += count;
+		timing.threads = participants;
+		timing.wallSeconds += seconds(start);
+		for (unsigned t = 0; t < participants; t++)
+		{
+			timing.chunks += m_slots[t].chunks;
+			timing.steals += m_slots[t].steals;
+			timing.busySeconds += m_slots[t].busySeconds;
+		}
+	}
+	m_body = nullptr;
+	if (m_error) std::rethrow_exception(m_error);
+}
+
+void Executor::work(unsigned thread)
+{
+	unsigned long long generation = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_start.wait(lock, [&]() { return m_stop || m_generation != generation; });
+			if (m_stop) return;
+			generation = m_generation;
+			if (thread >= m_participants) continue;
+		}
+		participate(thread);
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (--m_running) continue;
+		}
+		m_done.notify_all();
+	}
+}
+
+void Executor::participate(unsigned thread)
+{
+	auto start = std::chrono::steady_clock::now();
+	insideChunk = true;
+	chunkThread = thread;
+	size_t chunk;
+	do
+	{
+		while (take(thread, chunk)) run(thread, chunk);
+	} while (steal(thread));
+	insideChunk = false;
+	m_slots[thread].busySeconds = seconds(start);
+}
+
+bool Executor::take(unsigned thread, size_t& chunk)
+{
+	// The owner takes from the front, thieves from the back.
+	std::atomic<unsigned long long>& range = m_slots[thread].range;
+	unsigned long long current = range.load();
+	while (rangeBegin(current) < rangeEnd(current))
+	{
+		if (range.compare_exchange_weak(current, packRange(rangeBegin(current) + 1, rangeEnd(current))))
+		{
+			chunk = rangeBegin(current);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool Executor::steal(unsigned thread)
+{
+	while (true)
+	{
+		// The share with the most chunks left.
+		unsigned victim = thread;
+		size_t most = 0;
+		unsigned long long seen = 0;
+		for (unsigned t = 0; t < m_threads; t++)
+		{
+			unsigned long long range = m_slots[t].range.load();
+			size_t left = (rangeEnd(range) > rangeBegin(range)) ? rangeEnd(range) - rangeBegin(range) : 0;
+			if (t != thread && left > most) { victim = t; most = left; seen = range; }
+		}
+		if (!most) return false;
+
+		// Take the far half, the victim keeps the chunk it is about to take.
+		size_t taken = most / 2 + (most == 1);
+		size_t split = rangeEnd(seen) - taken;
+		if (!m_slots[victim].range.compare_exchange_strong(seen, packRange(rangeBegin(seen), split))) continue;
+		m_slots[thread].range.store(packRange(split, rangeEnd(seen)));
+		m_slots[thread].steals++;
+		return true;
+	}
+}
+
+void Executor::run(unsigned thread, size_t chunk)
+{
+	m_slots[thread].chunks++;
+	if (m_failed) return;
+	size_t begin = chunk * m_grain;
+	try
+	{
+		(*m_body)(begin, std::min(m_count, begin + m_grain), thread);
+	}
+	catch (...)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_error) m_error = std::current_exception();
+		m_failed = true;
+	}
+}
+
+// ================================================================================================================================================================================ //
+//  Timing.                                                                                                                                                                         //
+// ================================================================================================================================================================================ //
+
+std::map<std::string, TaskTiming> Executor::timings() const
+{
+	std::lock_guard<std::mutex> lock(m_timingMutex);
+	return m_timings;
+}
+
+void Executor::resetTimings()
+{
+	std::lock_guard<std::mutex> lock(m_timingMutex);
+	m_timings.clear();
+}
+
+std::string Executor::report() const
+{
+	std::ostringstream text;
+	text << std::fixed;
+	for (const auto& [name, timing] : timings())
+	{
+		text << name << ": " << timing.calls << " calls, " << timing.items << " items in " << timing.chunks << " chunks, " << timing.steals << " steals, "
+			 << std::setprecision(2) << 1e3 * timing.wallSeconds << " ms wall, " << 1e3 * timing.busySeconds << " ms busy on " << timing.threads << " threads ("
+			 << std::setprecision(0) << 100 * timing.efficiency() << " %)\n";
+	}
+	return text.str();
+}
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
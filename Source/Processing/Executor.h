@@ -0,0 +1,145 @@
+#pragma once
+
+/*
+* Work stealing executor for the processing stages.  A loop over items is cut into chunks and
+* every thread starts on its own share of them.  A thread that runs out takes the far half of
+* the share of the busiest thread, so uneven chunks do not leave threads idle.  The threads
+* are started once and wait between loops.  Chunks are sized to the L2 cache by grainFor(), and
+* every named loop keeps its timing.
+*
+* The threads can be kept off the cores of the live RX and TX threads: reservedCores are not
+* counted when the threads are chosen, and pinning puts the workers on the cores after them.
+*/
+
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include <vector>
+#include <string>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <map>
+
+// ================================================================================================================================================================================ //
+//  Types.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+struct ExecutorParameters
+{
+	unsigned threads = 0;				// Threads including the caller, 0 uses the physical cores that are not reserved.
+	unsigned reservedCores = 0;			// Cores left for the RX and TX threads, the first ones.
+	std::string pinning = "Disabled";	// "Enabled" pins worker n to the core after the reserved ones and the caller.
+	size_t cacheBytes = 0;				// L2 cache per core [bytes], 0 asks the system.
+};
+
+struct TaskTiming
+{
+	size_t calls = 0;
+	size_t items = 0;
+	size_t chunks = 0;
+	size_t steals = 0;
+	double wallSeconds = 0;				// Time from the start to the end of the loops.
+	double busySeconds = 0;				// Time spent by all of the threads together.
+	unsigned threads = 0;				// Threads of the last call.
+
+	// Busy time over wall time times the threads, 1 when no thread waited.
+	double efficiency() const { return (wallSeconds > 0 && threads) ? busySeconds / (wallSeconds * threads) : 0; }
+};
+
+// ================================================================================================================================================================================ //
+//  Executor.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+class Executor
+{
+public:
+
+	// body(begin, end, thread) processes items [begin, end).  thread is below threads() and
+	// only one chunk runs on a thread at a time, so it can index per thread scratch.
+	using Body = std::function<void(size_t begin, size_t end, unsigned thread)>;
+
+	explicit Executor(const ExecutorParameters& parameters = ExecutorParameters());
+	~Executor();
+	Executor(const Executor&) = delete;
+	Executor& operator=(const Executor&) = delete;
+
+	// The executor the stages use.  configure() replaces it and may only be called while it is
+	// not running a loop, e.g. before processing starts.
+	static Executor& shared();
+	static void configure(const ExecutorParameters& parameters);
+
+	unsigned threads() const { return m_threads; }
+	size_t cacheBytes() const { return m_cacheBytes; }
+	bool pinned() const { return m_pinned; }
+
+	// Items per chunk so that the data a chunk touches fills about half of the L2 cache.
+	size_t grainFor(size_t bytesPerItem) const;
+
+	// Run body over [0, count) in chunks of grain items on up to maxThreads threads (0 for all of
+	// them) and return once every chunk is done.  The caller is one of the threads.  A loop on
+	// one thread, or started from inside a chunk, runs on the calling thread.  Loops on more
+	// threads from different callers run one after the other.  The first exception a chunk
+	// throws is rethrown here, the chunks after it are skipped.
+	void parallelFor(const std::string& name, size_t count, size_t grain, const Body& body, unsigned maxThreads = 0);
+
+	std::map<std::string, TaskTiming> timings() const;
+	void resetTimings();
+	// One line per loop with its calls, wall and busy time and efficiency.
+	std::string report() const;
+
+private:
+
+	struct alignas(64) Slot
+	{
+		std::atomic<unsigned long long> range{ 0 };	// First chunk in the high half, end in the low half.
+		size_t chunks = 0;
+		size_t steals = 0;
+		double busySeconds = 0;
+	};
+
+	unsigned m_threads = 1;
+	size_t m_cacheBytes = 0;
+	bool m_pinned = false;
+	std::vector<std::thread> m_workers;
+	std::unique_ptr<Slot[]> m_slots;
+
+	// The current loop.
+	const Body* m_body = nullptr;
+	size_t m_count = 0;
+	size_t m_grain = 1;
+	unsigned m_participants = 0;
+	std::exception_ptr m_error;
+	std::atomic<bool> m_failed{ false };
+
+	std::mutex m_submit;								// One loop at a time.
+	std::mutex m_mutex;
+	std::condition_variable m_start;
+	std::condition_variable m_done;
+	unsigned long long m_generation = 0;
+	unsigned m_running = 0;								// Workers still in the current loop.
+	bool m_stop = false;
+
+	mutable std::mutex m_timingMutex;
+	std::map<std::string, TaskTiming> m_timings;
+
+	void work(unsigned thread);
+	void participate(unsigned thread);
+	bool take(unsigned thread, size_t& chunk);
+	bool steal(unsigned thread);
+	void run(unsigned thread, size_t chunk);
+};
+
+// Physical cores and the L2 cache per core [bytes] of this machine, with fallbacks of the
+// logical cores and 1 MiB when the system does not say.
+unsigned physicalCores();
+size_t level2CacheBytes();
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
@@ -0,0 +1,207 @@
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include "FixedPointCompression.h"
+#include "MatchedFilterCache.h"
+#include "Executor.h"
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <sstream>
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define FIXED_POINT_SSE2
+#endif
+
+// ================================================================================================================================================================================ //
+//  Outputs.                                                                                                                                                                        //
+// ================================================================================================================================================================================ //
+
+namespace
+{
+	// Two 16 bit values packed as the halves of a madd operand, low half first.
+	int32_t packPair(int16_t low, int16_t high)
+	{
+		return (int32_t)(((uint32_t)(uint16_t)high << 16) | (uint16_t)low);
+	}
+
+	void store(std::complex<int32_t>* output, int32_t re, int32_t im, float) { *output = std::complex<int32_t>(re, im); }
+	void store(std::complex<float>* output, int32_t re, int32_t im, float scale) { *output = std::complex<float>(re * scale, im * scale); }
+
+#ifdef FIXED_POINT_SSE2
+	// Interleave the real and imaginary sums of four outputs.
+	void store4(std::complex<int32_t>* output, __m128i re, __m128i im, __m128)
+	{
+		_mm_storeu_si128((__m128i*)output, _mm_unpacklo_epi32(re, im));
+		_mm_storeu_si128((__m128i*)(output + 2), _mm_unpackhi_epi32(re, im));
+	}
+	void store4(std::complex<float>* output, __m128i re, __m128i im, __m128 scale)
+	{
+		__m128 real = _mm_mul_ps(_mm_cvtepi32_ps(re), scale);
+		__m128 imag = _mm_mul_ps(_mm_cvtepi32_ps(im), scale);
+		_mm_storeu_ps((float*)output, _mm_unpacklo_ps(real, imag));
+		_mm_storeu_ps((float*)(output + 2), _mm_unpackhi_ps(real, imag));
+	}
+#endif
+}
+
+// ================================================================================================================================================================================ //
+//  Compressor.                                                                                                                                                                     //
+// ================================================================================================================================================================================ //
+
+FixedPointCompressor::FixedPointCompressor(std::span<const std::complex<float>> pulse, const FixedPointParameters& parameters)
+	: m_threads(parameters.threads)
+{
+	if (pulse.empty()) throw std::invalid_argument("Pulse compression needs a pulse.");
+	const std::vector<std::complex<float>>& taps = MatchedFilterCache::shared().filter(pulse, 0, parameters.window, parameters.windowParameters)->taps;
+	const size_t pulseSamples = taps.size();
+
+	// Every part of an output sums 2 M products of a tap and a sample of up to 32768, so the
+	// taps are scaled to keep that below 2^31.
+	double largest = 0;
+	for (const std::complex<float>& tap : taps) largest = std::max({ largest, (double)std::abs(tap.real()), (double)std::abs(tap.imag()) });
+	if (largest == 0) throw std::invalid_argument("Pulse compression needs a pulse that is not zero.");
+	double limit = std::min(32767.0, std::floor(2147483647.0 / (2.0 * pulseSamples * 32768.0)));
+	if (limit < 1) throw std::invalid_argument("The pulse is too long for the fixed point compression.");
+	double scale = limit / largest;
+
+	m_taps.resize(pulseSamples);
+	m_realTaps.resize(pulseSamples);
+	m_imagTaps.resize(pulseSamples);
+	for (size_t m = 0; m < pulseSamples; m++)
+	{
+		int16_t re = (int16_t)std::lround(taps[m].real() * scale);
+		int16_t im = (int16_t)std::lround(taps[m].imag() * scale);
+		m_taps[m] = std::complex<int16_t>(re, im);
+		m_realTaps[m] = packPair(re, (int16_t)-im);
+		m_imagTaps[m] = packPair(im, re);
+	}
+	m_tapBits = (unsigned)std::ceil(std::log2(limit + 1)) + 1;
+	m_outputScale = (float)(1.0 / (scale * 32768.0));
+
+	// The alignment of the PulseCompressor, a pulse starting at sample k peaks at k + (M - 1) / 2 - 1.
+	m_offset = 1 + (long long)(pulseSamples - 1) / 2 - (long long)(pulseSamples - 1);
+}
+
+std::string FixedPointCompressor::describe() const
+{
+	std::ostringstream description;
+	description << "fixed point direct, " << m_taps.size() << " taps of " << m_tapBits << " bits";
+#ifdef FIXED_POINT_SSE2
+	description << ", SSE2";
+#endif
+	return description.str();
+}
+
+template <typename Output>
+void FixedPointCompressor::compressRange(std::span<const std::complex<int16_t>> input, Output* output, size_t begin, size_t end) const
+{
+	const long long length = (long long)input.size();
+	const long long pulseSamples = (long long)m_taps.size();
+
+	// Outputs with every tap inside of the input.
+	long long first = std::clamp(-m_offset, (long long)begin, (long long)end);
+	long long last = std::clamp(length - m_offset - pulseSamples + 1, first, (long long)end);
+
+	// Edges, summed one output at a time over the taps that overlap the input.
+	auto single = [&](long long n)
+	{
+		long long start = std::max(0LL, -(n + m_offset));
+		long long stop = std::min(pulseSamples, length - (n + m_offset));
+		int32_t re = 0;
+		int32_t im = 0;
+		for (long long m = start; m < stop; m++)
+		{
+			std::complex<int16_t> tap = m_taps[m];
+			std::complex<int16_t> sample = input[n + m + m_offset];
+			re += (int32_t)tap.real() * sample.real() - (int32_t)tap.imag() * sample.imag();
+			im += (int32_t)tap.real() * sample.imag() + (int32_t)tap.imag() * sample.real();
+		}
+		store(output + n, re, im, m_outputScale);
+	};
+	for (long long n = (long long)begin; n < first; n++) single(n);
+
+	long long n = first;
+#ifdef FIXED_POINT_SSE2
+	// Eight outputs at a time, a madd of four samples with a tap pair gives the real (or the
+	// imaginary) part of the product for four outputs.
+	const __m128 scale = _mm_set1_ps(m_outputScale);
+	const int16_t* samples = (const int16_t*)input.data();
+	for (; n + 8 <= last; n += 8)
+	{
+		__m128i re0 = _mm_setzero_si128();
+		__m128i im0 = _mm_setzero_si128();
+		__m128i re1 = _mm_setzero_si128();
+		__m128i im1 = _mm_setzero_si128();
+		const int16_t* window = samples + 2 * (n + m_offset);
+		for (long long m = 0; m < pulseSamples; m++)
+		{
+			__m128i realTap = _mm_set1_epi32(m_realTaps[m]);
+			__m128i imagTap = _mm_set1_epi32(m_imagTaps[m]);
+			__m128i x0 = _mm_loadu_si128((const __m128i*)(window + 2 * m));
+			__m128i x1 = _mm_loadu_si128((const __m128i*)(window + 2 * m + 8));
+			re0 = _mm_add_epi32(re0, _mm_madd_epi16(x0, realTap));
+			im0 = _mm_add_epi32(im0, _mm_madd_epi16(x0, imagTap));
+			re1 = _mm_add_epi32(re1, _mm_madd_epi16(x1, realTap));
+			im1 = _mm_add_epi32(im1, _mm_madd_epi16(x1, imagTap));
+		}
+		store4(output + n, re0, im0, scale);
+		store4(output + n + 4, re1, im1, scale);
+	}
+#endif
+	for (; n < (long long)end; n++) single(n);
+}
+
+template <typename Output>
+void FixedPointCompressor::compressAll(std::span<const std::complex<int16_t>> input, std::span<Output> output) const
+{
+	if (output.size() < input.size()) throw std::invalid_argument("Pulse compression output is shorter than the input.");
+	Executor& executor = Executor::shared();
+	executor.parallelFor("Compression (sc16)", input.size(), executor.grainFor(sizeof(std::complex<int16_t>) + sizeof(Output)), [&](size_t first, size_t last, unsigned)
+	{
+		compressRange(input, output.data(), first, last);
+	}, m_threads);
+}
+
+template <typename Output>
+void FixedPointCompressor::compressAllPRIs(std::span<const std::complex<int16_t>> input, size_t priSamples, std::span<Output> output) const
+{
+	if (output.size() < input.size()) throw std::invalid_argument("Pulse compression output is shorter than the input.");
+	if (priSamples == 0) throw std::invalid_argument("Pulse compression needs a PRI length.");
+	size_t pris = (input.size() + priSamples - 1) / priSamples;
+	Executor& executor = Executor::shared();
+	executor.parallelFor("Compression (sc16 PRIs)", pris, executor.grainFor(priSamples * (sizeof(std::complex<int16_t>) + sizeof(Output))), [&](size_t first, size_t last, unsigned)
+	{
+		for (size_t pri = first; pri < last; pri++)
+		{
+			size_t begin = pri * priSamples;
+			size_t count = std::min(priSamples, input.size() - begin);
+			compressRange(input.subspan(begin, count), output.data() + begin, 0, count);
+		}
+	}, m_threads);
+}
+
+void FixedPointCompressor::compress(std::span<const std::complex<int16_t>> input, std::span<std::complex<int32_t>> output) const
+{
+	compressAll(input, output);
+}
+
+void FixedPointCompressor::compress(std::span<const std::complex<int16_t>> input, std::span<std::complex<float>> output) const
+{
+	compressAll(input, output);
+}
+
+void FixedPointCompressor::compressPRIs(std::span<const std::complex<int16_t>> input, size_t priSamples, std::span<std::complex<int32_t>> output) const
+{
+	compressAllPRIs(input, priSamples, output);
+}
+
+void FixedPointCompressor::compressPRIs(std::span<const std::complex<int16_t>> input, size_t priSamples, std::span<std::complex<float>> output) const
+{
+	compressAllPRIs(input, priSamples, output);
+}
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
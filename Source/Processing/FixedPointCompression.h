@@ -0,0 +1,84 @@
+#pragma once
+
+/*
+* Pulse compression of sc16 captures in fixed point, without converting them to fc32 first.
+* The taps are quantised to 16 bits and every output is summed in 32 bits, eight outputs at a
+* time with SSE2 where it is available.  The taps are scaled so that no sum can overflow, even
+* for full scale input, which leaves fewer bits for the taps of longer pulses: this path is for
+* short pulses, where the direct convolution is cheaper than the FFT blocks anyway.  The sums
+* are only scaled at the end, to int32 or to the fc32 output of the PulseCompressor.
+*/
+
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include <vector>
+#include <complex>
+#include <span>
+#include <string>
+#include <cstdint>
+#include "../Utils/WindowFunctions.h"
+
+// ================================================================================================================================================================================ //
+//  Types.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+struct FixedPointParameters
+{
+	std::string window = "None";		// Window on the taps, see windowTypes().
+	WindowParameters windowParameters;
+	unsigned threads = 0;				// Threads of the shared executor used, 0 uses all of them.
+};
+
+// ================================================================================================================================================================================ //
+//  Compressor.                                                                                                                                                                     //
+// ================================================================================================================================================================================ //
+
+class FixedPointCompressor
+{
+public:
+
+	// Quantise the matched filter of the transmitted pulse.  The filter is the one of the
+	// PulseCompressor, including its output alignment.
+	explicit FixedPointCompressor(std::span<const std::complex<float>> pulse, const FixedPointParameters& parameters = FixedPointParameters());
+
+	size_t pulseSamples() const { return m_taps.size(); }
+	// Bits of the largest tap, including the sign.
+	unsigned tapBits() const { return m_tapBits; }
+	// Scale from the int32 outputs to the fc32 outputs, for input read as sample / 32768.
+	float outputScale() const { return m_outputScale; }
+	// E.g. "fixed point direct, 13 taps of 12 bits, SSE2".
+	std::string describe() const;
+
+	// Compress the input as one continuous segment, with zeros outside of it.  The output has the
+	// same length as the input.
+	void compress(std::span<const std::complex<int16_t>> input, std::span<std::complex<int32_t>> output) const;
+	void compress(std::span<const std::complex<int16_t>> input, std::span<std::complex<float>> output) const;
+
+	// Compress every PRI of a capture on its own, as PulseCompressor::compressPRIs() does.
+	void compressPRIs(std::span<const std::complex<int16_t>> input, size_t priSamples, std::span<std::complex<int32_t>> output) const;
+	void compressPRIs(std::span<const std::complex<int16_t>> input, size_t priSamples, std::span<std::complex<float>> output) const;
+
+private:
+
+	std::vector<std::complex<int16_t>> m_taps;	// Quantised, conjugated pulse.
+	std::vector<int32_t> m_realTaps;			// Tap pairs (re, -im) for the real part of a madd, one per tap.
+	std::vector<int32_t> m_imagTaps;			// Tap pairs (im, re) for the imaginary part.
+	long long m_offset = 0;						// Output n starts at input n + m_offset.
+	unsigned m_tapBits = 0;
+	float m_outputScale = 1;
+	unsigned m_threads = 0;
+
+	// Compress outputs [begin, end) of the segment.
+	template <typename Output>
+	void compressRange(std::span<const std::complex<int16_t>> input, Output* output, size_t begin, size_t end) const;
+	template <typename Output>
+	void compressAll(std::span<const std::complex<int16_t>> input, std::span<Output> output) const;
+	template <typename Output>
+	void compressAllPRIs(std::span<const std::complex<int16_t>> input, size_t priSamples, std::span<Output> output) const;
+};
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
@@ -0,0 +1,188 @@
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include "MTI.h"
+#include <stdexcept>
+
+// ================================================================================================================================================================================ //
+//  Taps.                                                                                                                                                                           //
+// ================================================================================================================================================================================ //
+
+std::vector<std::complex<float>> mtiTaps(const MTIParameters& parameters)
+{
+	if (parameters.canceller == "FIR")
+	{
+		if (parameters.taps.empty()) throw std::invalid_argument("The MTI FIR needs taps.");
+		return parameters.taps;
+	}
+
+	// "<N>-pulse", the taps of (1 - z^-1)^(N - 1).
+	size_t pulses = 0;
+	size_t suffix = parameters.canceller.find("-pulse");
+	if (suffix != std::string::npos && suffix > 0 && suffix + 6 == parameters.canceller.size())
+	{
+		try { pulses = std::stoul(parameters.canceller.substr(0, suffix)); }
+		catch (const std::exception&) { pulses = 0; }
+	}
+	if (pulses < 2 || pulses > 16) throw std::invalid_argument("MTI canceller '" + parameters.canceller + "' is not supported.");
+	std::vector<std::complex<float>> taps(pulses);
+	double coefficient = 1;
+	for (size_t k = 0; k < pulses; k++)
+	{
+		taps[k] = std::complex<float>((float)((k % 2) ? -coefficient : coefficient), 0.f);
+		coefficient = coefficient * (pulses - 1 - k) / (k + 1);
+	}
+	return taps;
+}
+
+// ================================================================================================================================================================================ //
+//  Kernels.                                                                                                                                                                        //
+// ================================================================================================================================================================================ //
+
+namespace
+{
+	// y += tap x over n complex samples, as interleaved floats so that the loops vectorise.
+	void accumulate(std::complex<float>* y, const std::complex<float>* x, size_t n, std::complex<float> tap, bool realTap)
+	{
+		float* out = reinterpret_cast<float*>(y);
+		const float* in = reinterpret_cast<const float*>(x);
+		const float re = tap.real();
+		const float im = tap.imag();
+		if (realTap)
+		{
+			for (size_t i = 0; i < 2 * n; i++) out[i] += re * in[i];
+			return;
+		}
+		for (size_t i = 0; i < n; i++)
+		{
+			float a = in[2 * i];
+			float b = in[2 * i + 1];
+			out[2 * i] += re * a - im * b;
+			out[2 * i + 1] += re * b + im * a;
+		}
+	}
+
+	// y = tap x over n complex samples, y may be x.
+	void scale(std::complex<float>* y, const std::complex<float>* x, size_t n, std::complex<float> tap, bool realTap)
+	{
+		float* out = reinterpret_cast<float*>(y);
+		const float* in = reinterpret_cast<const float*>(x);
+		const float re = tap.real();
+		const float im = tap.imag();
+		if (realTap)
+		{
+			for (size_t i = 0; i < 2 * n; i++) out[i] = re * in[i];
+			return;
+		}
+		for (size_t i = 0; i < n; i++)
+		{
+			float a = in[2 * i];
+			float b = in[2 * i + 1];
+			out[2 * i] = re * a - im * b;
+			out[2 * i + 1] = re * b + im * a;
+		}
+	}
+
+	// One slow time line, filtered from a copy so that the output can overwrite the input.
+	void filterLine(std::span<std::complex<float>> line, const std::vector<std::complex<float>>& taps, bool realTaps, std::vector<std::complex<float>>& scratch)
+	{
+		const size_t pulses = line.size();
+		const size_t history = taps.size() - 1;
+		if (pulses <= history) { std::fill(line.begin(), line.end(), std::complex<float>(0, 0)); return; }
+		scratch.assign(line.begin(), line.end());
+		const size_t count = pulses - history;
+		scale(line.data() + history, scratch.data() + history, count, taps[0], realTaps);
+		for (size_t k = 1; k < taps.size(); k++) accumulate(line.data() + history, scratch.data() + history - k, count, taps[k], realTaps);
+		std::fill_n(line.begin(), history, std::complex<float>(0, 0));
+	}
+}
+
+// ================================================================================================================================================================================ //
+//  Filter.                                                                                                                                                                         //
+// ================================================================================================================================================================================ //
+
+MTIFilter::MTIFilter(const MTIParameters& parameters)
+	: m_taps(mtiTaps(parameters)),
+	  m_threads(parameters.threads)
+{
+	for (const std::complex<float>& tap : m_taps) m_realTaps = m_realTaps && tap.imag() == 0;
+}
+
+void MTIFilter::apply(std::span<std::complex<float>> pulses) const
+{
+	std::vector<std::complex<float>> scratch;
+	filterLine(pulses, m_taps, m_realTaps, scratch);
+}
+
+void MTIFilter::apply(DataCube& cube) const
+{
+	if (cube.empty()) return;
+	const size_t history = transientPulses();
+	const size_t rangeBins = cube.rangeBins();
+	const size_t pulses = cube.pulses();
+
+	// Range major: every chunk is whole Doppler columns.  Pulse major: every chunk is slices of
+	// the range bins, run over the pulses from the last one back, so pulse p is overwritten only
+	// after the pulses after it have used it.
+	const bool rangeMajor = (cube.layout() == CubeLayout::RangeMajor);
+	const size_t slice = 64;
+	const size_t slices = (rangeBins + slice - 1) / slice;
+	const size_t items = rangeMajor ? rangeBins : slices;
+
+	Executor& executor = Executor::shared();
+	std::vector<std::vector<std::complex<float>>> scratch(executor.threads());
+	size_t grain = executor.grainFor((rangeMajor ? 1 : slice) * pulses * sizeof(std::complex<float>));
+	executor.parallelFor("MTI", items * cube.channels(), grain, [&](size_t first, size_t last, unsigned thread)
+	{
+		for (size_t item = first; item < last; item++)
+		{
+			size_t channel = item / items;
+			if (rangeMajor)
+			{
+				filterLine(cube.line(item % items, channel), m_taps, m_realTaps, scratch[thread]);
+				continue;
+			}
+			size_t begin = (item % items) * slice;
+			size_t count = std::min(slice, rangeBins - begin);
+			for (size_t pulse = pulses; pulse-- > history;)
+			{
+				std::complex<float>* output = cube.line(pulse, channel).data() + begin;
+				// Tap 0 scales the pulse in place, the older pulses are added to it.
+				scale(output, output, count, m_taps[0], m_realTaps);
+				for (size_t k = 1; k < m_taps.size(); k++) accumulate(output, cube.line(pulse - k, channel).data() + begin, count, m_taps[k], m_realTaps);
+			}
+			for (size_t pulse = 0; pulse < std::min(history, pulses); pulse++) std::fill_n(cube.line(pulse, channel).data() + begin, count, std::complex<float>(0, 0));
+		}
+	}, m_threads);
+}
+
+// ================================================================================================================================================================================ //
+//  Streaming.                                                                                                                                                                      //
+// ================================================================================================================================================================================ //
+
+MTIStream::MTIStream(const MTIFilter& filter, size_t priSamples)
+	: m_filter(filter), m_priSamples(priSamples), m_history(filter.transientPulses() * priSamples, std::complex<float>(0, 0))
+{
+}
+
+void MTIStream::process(std::span<const std::complex<float>> input, std::span<std::complex<float>> output)
+{
+	if (output.size() < input.size()) throw std::invalid_argument("MTI output is shorter than the input.");
+	const std::vector<std::complex<float>>& taps = m_filter.taps();
+	const size_t history = m_history.size();
+	const size_t count = input.size();
+
+	// The kept PRIs followed by the new samples, so every tap is one contiguous run.
+	m_scratch.resize(history + count);
+	std::copy(m_history.begin(), m_history.end(), m_scratch.begin());
+	std::copy(input.begin(), input.end(), m_scratch.begin() + history);
+	scale(output.data(), m_scratch.data() + history, count, taps[0], m_filter.realTaps());
+	for (size_t k = 1; k < taps.size(); k++) accumulate(output.data(), m_scratch.data() + history - k * m_priSamples, count, taps[k], m_filter.realTaps());
+	std::copy(m_scratch.end() - history, m_scratch.end(), m_history.begin());
+	m_processed += count;
+}
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
@@ -0,0 +1,96 @@
+#pragma once
+
+/*
+* Moving target indication (MTI).  Stationary clutter is the same from pulse to pulse, so a
+* filter across the pulses of every range bin (slow time) with a null at zero Doppler cancels
+* it.  The filters are the N-pulse binomial cancellers, 2-pulse being x[p] - x[p - 1], or any
+* slow time FIR.  The filter runs over compressed pulses in a data cube, in either layout, or
+* over a continuous stream of PRIs while capturing.
+*/
+
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include <vector>
+#include <complex>
+#include <span>
+#include <string>
+#include <algorithm>
+#include "DataCube.h"
+#include "Executor.h"
+
+// ================================================================================================================================================================================ //
+//  Types.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+struct MTIParameters
+{
+	std::string canceller = "2-pulse";			// "<N>-pulse" for a binomial canceller, e.g. "3-pulse", or "FIR".
+	std::vector<std::complex<float>> taps;		// FIR: y[p] = sum taps[k] x[p - k].
+	unsigned threads = 0;						// Threads of the shared executor used, 0 uses all of them.
+};
+
+// Slow time taps of the canceller, (-1)^k C(N - 1, k) for the N-pulse cancellers.
+std::vector<std::complex<float>> mtiTaps(const MTIParameters& parameters);
+
+// ================================================================================================================================================================================ //
+//  Filter.                                                                                                                                                                         //
+// ================================================================================================================================================================================ //
+
+class MTIFilter
+{
+public:
+
+	explicit MTIFilter(const MTIParameters& parameters = MTIParameters());
+
+	const std::vector<std::complex<float>>& taps() const { return m_taps; }
+	bool realTaps() const { return m_realTaps; }
+	// Pulses at the start without a full history, which are zeroed.
+	size_t transientPulses() const { return m_taps.size() - 1; }
+
+	// Filter every range bin of the cube in place, the pulses keep their index.  Pulse major
+	// cubes are filtered a range line at a time from the last pulse back, range major cubes a
+	// Doppler column at a time, so the memory is always read in order.
+	void apply(DataCube& cube) const;
+
+	// Filter one slow time line in place.
+	void apply(std::span<std::complex<float>> pulses) const;
+
+private:
+
+	std::vector<std::complex<float>> m_taps;
+	bool m_realTaps = true;			// The binomial taps are real, which halves the work.
+	unsigned m_threads = 0;
+};
+
+// ================================================================================================================================================================================ //
+//  Streaming.                                                                                                                                                                      //
+// ================================================================================================================================================================================ //
+
+// The filter on a continuous stream of back to back PRIs, output[n] = sum taps[k] input[n - k PRI].
+// The PRIs before the stream are taken as zero.  Samples are pushed in order in blocks of any
+// length, the last PRIs are kept between blocks.
+class MTIStream
+{
+public:
+
+	MTIStream(const MTIFilter& filter, size_t priSamples);
+
+	// Output has the length of the input.
+	void process(std::span<const std::complex<float>> input, std::span<std::complex<float>> output);
+	// Samples processed so far that did not have a full history.
+	size_t transientSamples() const { return std::min(m_processed, m_history.size()); }
+
+private:
+
+	MTIFilter m_filter;
+	size_t m_priSamples;
+	std::vector<std::complex<float>> m_history;		// The last (taps - 1) PRIs of input.
+	std::vector<std::complex<float>> m_scratch;
+	size_t m_processed = 0;
+};
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
@@ -0,0 +1,158 @@
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include "MatchedFilterCache.h"
+#include <sstream>
+#include <fstream>
+#include <stdexcept>
+
+// ================================================================================================================================================================================ //
+//  Filters.                                                                                                                                                                        //
+// ================================================================================================================================================================================ //
+
+std::string MatchedFilterKey::describe() const
+{
+	std::ostringstream description;
+	description << std::hex << waveform << std::dec << "|" << pulseSamples << "|" << blockSize << "|" << window;
+	return description.str();
+}
+
+uint64_t hashSamples(std::span<const std::complex<float>> samples)
+{
+	uint64_t hash = 14695981039346656037ull;
+	const unsigned char* bytes = (const unsigned char*)samples.data();
+	for (size_t n = 0; n < samples.size_bytes(); n++)
+	{
+		hash ^= bytes[n];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+std::shared_ptr<const MatchedFilter> makeMatchedFilter(std::span<const std::complex<float>> pulse, size_t blockSize, const std::string& window, const WindowParameters& windowParameters)
+{
+	if (pulse.empty()) throw std::invalid_argument("A matched filter needs a pulse.");
+	if (blockSize && blockSize < pulse.size()) throw std::invalid_argument("The FFT blocks are shorter than the pulse.");
+	size_t pulseSamples = pulse.size();
+
+	auto filter = std::make_shared<MatchedFilter>();
+	const std::vector<float>& weights = getWindow(window, (int)pulseSamples, windowParameters);
+	filter->taps.resize(pulseSamples);
+	for (size_t m = 0; m < pulseSamples; m++) filter->taps[m] = std::conj(pulse[m]) * weights[m];
+	if (!blockSize) return filter;
+
+	// Spectrum of the time reversed taps, so the blocks are a convolution.
+	filter->plan = sharedPlan(blockSize);
+	filter->spectrum.assign(blockSize, std::complex<float>(0, 0));
+	for (size_t k = 0; k < pulseSamples; k++) filter->spectrum[k] = filter->taps[pulseSamples - 1 - k];
+	filter->plan->forward(filter->spectrum);
+	return filter;
+}
+
+// ================================================================================================================================================================================ //
+//  Cache.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+MatchedFilterCache& MatchedFilterCache::shared()
+{
+	static MatchedFilterCache cache;
+	return cache;
+}
+
+std::shared_ptr<const MatchedFilter> MatchedFilterCache::filter(std::span<const std::complex<float>> pulse, size_t blockSize, const std::string& window, const WindowParameters& windowParameters)
+{
+	MatchedFilterKey key;
+	key.waveform = hashSamples(pulse);
+	key.pulseSamples = pulse.size();
+	key.blockSize = blockSize;
+	key.window = describeWindow(window, windowParameters);
+	std::string description = key.describe();
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto entry = m_filters.find(description);
+		if (entry != m_filters.end())
+		{
+			m_hits++;
+			return entry->second;
+		}
+	}
+
+	// Built outside of the lock, so other compressors are not held up by the transform.  When
+	// two threads build the same filter the first one is kept.
+	std::shared_ptr<const MatchedFilter> built = makeMatchedFilter(pulse, blockSize, window, windowParameters);
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_misses++;
+	auto [entry, inserted] = m_filters.emplace(description, built);
+	if (!inserted) return entry->second;
+	m_insertionOrder.push_back(description);
+	if (m_insertionOrder.size() > m_maxFilters)
+	{
+		m_filters.erase(m_insertionOrder.front());
+		m_insertionOrder.pop_front();
+	}
+	return built;
+}
+
+// ================================================================================================================================================================================ //
+//  Block sizes.                                                                                                                                                                    //
+// ================================================================================================================================================================================ //
+
+bool MatchedFilterCache::findBlockSize(size_t pulseSamples, size_t segmentSamples, bool allowDirect, size_t& blockSize) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto entry = m_blockSizes.find({ pulseSamples, segmentSamples, allowDirect });
+	if (entry == m_blockSizes.end()) return false;
+	blockSize = entry->second;
+	return true;
+}
+
+void MatchedFilterCache::storeBlockSize(size_t pulseSamples, size_t segmentSamples, bool allowDirect, size_t blockSize)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_blockSizes[{ pulseSamples, segmentSamples, allowDirect }] = blockSize;
+	savePlans();
+}
+
+void MatchedFilterCache::setPlanFile(const std::string& file)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_planFile = file;
+	if (m_planFile.empty()) return;
+
+	// Lines that do not parse, or sizes that are not a power of two, are skipped.
+	std::ifstream plans(m_planFile);
+	std::string line;
+	while (std::getline(plans, line))
+	{
+		if (line.empty() || line[0] == '#') continue;
+		std::istringstream fields(line);
+		size_t pulseSamples, segmentSamples, blockSize;
+		bool allowDirect;
+		if (!(fields >> pulseSamples >> segmentSamples >> allowDirect >> blockSize)) continue;
+		if ((blockSize & (blockSize - 1)) || (blockSize && blockSize < pulseSamples) || (!blockSize && !allowDirect)) continue;
+		m_blockSizes[{ pulseSamples, segmentSamples, allowDirect }] = blockSize;
+	}
+}
+
+void MatchedFilterCache::savePlans() const
+{
+	if (m_planFile.empty()) return;
+	std::ofstream plans(m_planFile);
+	if (!plans) return;
+	plans << "# Pulse samples, segment samples, direct allowed, fastest block size (0 is direct).\n";
+	for (const auto& [key, blockSize] : m_blockSizes)
+		plans << std::get<0>(key) << " " << std::get<1>(key) << " " << std::get<2>(key) << " " << blockSize << "\n";
+}
+
+std::string MatchedFilterCache::describe() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	std::ostringstream description;
+	description << m_filters.size() << " filters, " << m_hits << " hits, " << m_misses << " misses, " << m_blockSizes.size() << " measured block sizes";
+	return description.str();
+}
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
@@ -0,0 +1,103 @@
+#pragma once
+
+/*
+* Matched filters shared by every compressor in the process.  The taps and the spectrum of a
+* filter only depend on the transmitted pulse, the FFT size and the window on the taps, so a
+* filter is built once and every compressor with the same key (and every thread) uses it,
+* together with the shared FFT plan of its size.  The block sizes chosen by timing them are
+* kept as well, and can be persisted to a file so they are only measured once per machine.
+*/
+
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include <vector>
+#include <complex>
+#include <span>
+#include <string>
+#include <map>
+#include <deque>
+#include <tuple>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include "../Utils/FFT.h"
+#include "../Utils/WindowFunctions.h"
+
+// ================================================================================================================================================================================ //
+//  Types.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+// Every parameter that determines a matched filter.
+struct MatchedFilterKey
+{
+	uint64_t waveform = 0;				// Hash of the pulse samples, see hashSamples().
+	size_t pulseSamples = 0;
+	size_t blockSize = 0;				// FFT size of the overlap-save blocks, 0 for the direct taps only.
+	std::string window = "None";		// Window on the taps, as given by describeWindow().
+
+	// Canonical text description, used as the cache key.
+	std::string describe() const;
+};
+
+struct MatchedFilter
+{
+	std::vector<std::complex<float>> taps;		// Conjugated and windowed pulse, the direct taps.
+	std::vector<std::complex<float>> spectrum;	// Spectrum of the time reversed taps, one block long.  Empty for the direct taps.
+	std::shared_ptr<const FFTPlan> plan;		// Empty for the direct taps.
+};
+
+// 64 bit FNV-1a hash of the bytes of the samples.
+uint64_t hashSamples(std::span<const std::complex<float>> samples);
+
+// Build the filter of the pulse without caching it, blockSize 0 for the direct taps only.
+std::shared_ptr<const MatchedFilter> makeMatchedFilter(std::span<const std::complex<float>> pulse, size_t blockSize, const std::string& window = "None", const WindowParameters& windowParameters = WindowParameters());
+
+// ================================================================================================================================================================================ //
+//  Cache.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+class MatchedFilterCache
+{
+public:
+
+	// The cache all of the compressors use.
+	static MatchedFilterCache& shared();
+
+	// The filter of the pulse, built on the first request and shared after that.
+	std::shared_ptr<const MatchedFilter> filter(std::span<const std::complex<float>> pulse, size_t blockSize, const std::string& window = "None", const WindowParameters& windowParameters = WindowParameters());
+
+	// The measured block size for the pulse and segment length (0 for a continuous stream), 0
+	// when the direct taps were fastest.  False when it has not been measured.
+	bool findBlockSize(size_t pulseSamples, size_t segmentSamples, bool allowDirect, size_t& blockSize) const;
+	void storeBlockSize(size_t pulseSamples, size_t segmentSamples, bool allowDirect, size_t blockSize);
+
+	// The file the measured block sizes are kept in between sessions, read when it is set.
+	// Persisting is disabled while it is empty.
+	void setPlanFile(const std::string& file);
+
+	// E.g. "3 filters, 12 hits, 3 misses, 2 measured block sizes".
+	std::string describe() const;
+
+private:
+
+	// Max filters kept.  The oldest are dropped first, compressors still using them keep them.
+	static const size_t m_maxFilters = 16;
+
+	mutable std::mutex m_mutex;
+	std::map<std::string, std::shared_ptr<const MatchedFilter>> m_filters;
+	std::deque<std::string> m_insertionOrder;
+	std::map<std::tuple<size_t, size_t, bool>, size_t> m_blockSizes;
+	std::string m_planFile;
+	size_t m_hits = 0;
+	size_t m_misses = 0;
+
+	// File layout: a comment line, then one line per block size of pulse samples, segment
+	// samples, direct allowed and block size.
+	void savePlans() const;
+};
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
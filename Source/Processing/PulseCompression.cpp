@@ -0,0 +1,302 @@
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include "PulseCompression.h"
+#include "../Utils/ComplexKernels.h"
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <sstream>
+#include <chrono>
+
+// ================================================================================================================================================================================ //
+//  Block size.                                                                                                                                                                     //
+// ================================================================================================================================================================================ //
+
+namespace
+{
+	// Largest FFT considered for the blocks, larger blocks no longer fit in the cache.
+	const size_t maxBlockSize = (size_t)1 << 18;
+
+	// Time of one unit of the block cost in complex multiply-adds of the direct convolution.  The
+	// butterflies load, twiddle and store more than a tap does, measured at 1.5 to 3 times a tap
+	// for 16 to 2048 point blocks, so without it the direct taps lose to blocks they beat.
+	const double fftCostPerTap = 2.0;
+
+	// Cost of filtering one block, in direct taps: two transforms of L/2 log2(L) butterflies
+	// each, the spectral product and copying the block in and out.
+	double blockCost(size_t blockSize)
+	{
+		return fftCostPerTap * (blockSize * std::log2((double)blockSize) + 2.0 * blockSize);
+	}
+
+	// Largest block worth considering, one that holds the whole segment.
+	size_t largestBlockSize(size_t pulse, size_t segmentSamples)
+	{
+		size_t largest = segmentSamples ? std::min(maxBlockSize, nextPowerOfTwo(segmentSamples + pulse - 1)) : maxBlockSize;
+		return std::max(largest, nextPowerOfTwo(2 * pulse));
+	}
+}
+
+size_t chooseBlockSize(size_t pulseSamples, size_t segmentSamples, bool& direct)
+{
+	size_t pulse = std::max<size_t>(pulseSamples, 1);
+	size_t largest = largestBlockSize(pulse, segmentSamples);
+
+	// Cost per output sample, for a continuous stream, or per segment.
+	size_t best = 0;
+	double bestCost = 0;
+	for (size_t blockSize = nextPowerOfTwo(2 * pulse); blockSize <= largest; blockSize *= 2)
+	{
+		size_t step = blockSize - pulse + 1;
+		double cost = segmentSamples ? std::ceil((double)segmentSamples / step) * blockCost(blockSize) : blockCost(blockSize) / step;
+		if (!best || cost < bestCost) { best = blockSize; bestCost = cost; }
+	}
+	double directCost = segmentSamples ? (double)segmentSamples * pulse : (double)pulse;
+	direct = directCost <= bestCost;
+	return best;
+}
+
+// ================================================================================================================================================================================ //
+//  Compressor.                                                                                                                                                                     //
+// ================================================================================================================================================================================ //
+
+PulseCompressor::PulseCompressor(std::span<const std::complex<float>> pulse, const CompressionParameters& parameters)
+	: PulseCompressor(MatchedFilterCache::shared().filter(pulse, planBlockSize(pulse, parameters), parameters.window, parameters.windowParameters), parameters.threads)
+{
+}
+
+PulseCompressor::PulseCompressor(std::shared_ptr<const MatchedFilter> filter, unsigned threads)
+	: m_filter(std::move(filter)),
+	  m_threads(threads)
+{
+	// The original loop correlates the PRI with the conjugated pulse, offset so that a pulse
+	// starting at sample k peaks at k + (M - 1) / 2 - 1.
+	m_shift = 1 + (m_filter->taps.size() - 1) / 2;
+}
+
+size_t PulseCompressor::planBlockSize(std::span<const std::complex<float>> pulse, const CompressionParameters& parameters)
+{
+	if (pulse.empty()) throw std::invalid_argument("Pulse compression needs a pulse.");
+	if (parameters.planning != "Estimate" && parameters.planning != "Measure") throw std::invalid_argument("Unknown pulse compression planning \"" + parameters.planning + "\".");
+	size_t pulseSamples = pulse.size();
+	if (parameters.blockSize) return nextPowerOfTwo(std::max(parameters.blockSize, pulseSamples));
+
+	bool direct;
+	size_t blockSize = chooseBlockSize(pulseSamples, parameters.segmentSamples, direct);
+	if (parameters.planning == "Estimate") return (direct && parameters.allowDirect) ? 0 : blockSize;
+
+	MatchedFilterCache& cache = MatchedFilterCache::shared();
+	if (cache.findBlockSize(pulseSamples, parameters.segmentSamples, parameters.allowDirect, blockSize)) return blockSize;
+	blockSize = measureBlockSize(pulse, parameters);
+	cache.storeBlockSize(pulseSamples, parameters.segmentSamples, parameters.allowDirect, blockSize);
+	return blockSize;
+}
+
+size_t PulseCompressor::measureBlockSize(std::span<const std::complex<float>> pulse, const CompressionParameters& parameters)
+{
+	// Every size filters the same outputs, a segment or enough of a stream for the largest block.
+	size_t pulseSamples = pulse.size();
+	size_t largest = largestBlockSize(pulseSamples, parameters.segmentSamples);
+	size_t length = parameters.segmentSamples ? parameters.segmentSamples : 2 * largest;
+	std::vector<std::complex<float>> input(length), output(length), scratch;
+	uint32_t state = 1;
+	for (std::complex<float>& sample : input)
+	{
+		state = state * 1664525u + 1013904223u;
+		sample = std::complex<float>((float)(state >> 16) / 65536.f - 0.5f, (float)(state & 0xffff) / 65536.f - 0.5f);
+	}
+
+	// The direct taps are only timed when the cost model puts them within a factor of four of
+	// the blocks, they are far too slow to time otherwise.
+	std::vector<size_t> candidates;
+	for (size_t blockSize = nextPowerOfTwo(2 * pulseSamples); blockSize <= largest; blockSize *= 2) candidates.push_back(blockSize);
+	bool direct;
+	size_t estimate = chooseBlockSize(pulseSamples, parameters.segmentSamples, direct);
+	double blocks = std::ceil((double)length / (estimate - pulseSamples + 1)) * blockCost(estimate);
+	if (parameters.allowDirect && (double)length * pulseSamples <= 4 * blocks) candidates.push_back(0);
+
+	// Best of three runs, after one to warm the cache.
+	size_t best = estimate;
+	double bestSeconds = 0;
+	for (size_t blockSize : candidates)
+	{
+		PulseCompressor candidate(makeMatchedFilter(pulse, blockSize), 1);
+		double seconds = 0;
+		for (int run = 0; run < 4; run++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			candidate.compressRange(input, output, 0, length, scratch);
+			double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			if (run == 1 || (run > 1 && elapsed < seconds)) seconds = elapsed;
+		}
+		if (bestSeconds == 0 || seconds < bestSeconds) { best = blockSize; bestSeconds = seconds; }
+	}
+	return best;
+}
+
+std::string PulseCompressor::describe() const
+{
+	std::ostringstream description;
+	if (isDirect()) description << "direct";
+	else description << "overlap-save, " << blockSize() << " point blocks";
+	return description.str();
+}
+
+void PulseCompressor::compressRange(std::span<const std::complex<float>> input, std::span<std::complex<float>> output, size_t begin, size_t end, std::vector<std::complex<float>>& scratch) const
+{
+	const long long length = (long long)input.size();
+	const long long pulseSamples = (long long)m_filter->taps.size();
+
+	// ------------- //
+	//  D I R E C T  //
+	// ------------- //
+
+	if (isDirect())
+	{
+		long long offset = (long long)m_shift - (pulseSamples - 1);
+		for (size_t n = begin; n < end; n++)
+		{
+			// Only the taps that overlap the input.
+			long long first = std::max(0LL, -((long long)n + offset));
+			long long last = std::min(pulseSamples, length - ((long long)n + offset));
+			float sumRe = 0;
+			float sumIm = 0;
+			for (long long m = first; m < last; m++)
+			{
+				std::complex<float> tap = m_filter->taps[m];
+				std::complex<float> sample = input[n + m + offset];
+				sumRe += tap.real() * sample.real() - tap.imag() * sample.imag();
+				sumIm += tap.real() * sample.imag() + tap.imag() * sample.real();
+			}
+			output[n] = std::complex<float>(sumRe, sumIm);
+		}
+		return;
+	}
+
+	// ------------------------- //
+	//  O V E R L A P - S A V E  //
+	// ------------------------- //
+
+	// Every block yields step outputs, the first pulseSamples - 1 samples of the block wrap
+	// around and are discarded.
+	const size_t blockSize = m_filter->plan->size();
+	const size_t step = blockSize - (size_t)pulseSamples + 1;
+	const ComplexKernels& kernels = complexKernels();
+	scratch.resize(blockSize);
+	for (size_t n0 = begin; n0 < end; n0 += step)
+	{
+		long long first = (long long)(n0 + m_shift) - (pulseSamples - 1);
+		for (size_t i = 0; i < blockSize; i++)
+		{
+			long long index = first + (long long)i;
+			scratch[i] = (index >= 0 && index < length) ? input[index] : std::complex<float>(0, 0);
+		}
+		m_filter->plan->forward(scratch);
+		kernels.multiply(scratch.data(), m_filter->spectrum.data(), scratch.data(), blockSize);
+		m_filter->plan->inverse(scratch);
+		size_t count = std::min(step, end - n0);
+		std::copy_n(scratch.begin() + (pulseSamples - 1), count, output.begin() + n0);
+	}
+}
+
+void PulseCompressor::compress(std::span<const std::complex<float>> input, std::span<std::complex<float>> output) const
+{
+	if (output.size() < input.size()) throw std::invalid_argument("Pulse compression output is shorter than the input.");
+	size_t length = input.size();
+
+	// The output is split into chunks of whole blocks, as many as fit in the cache with their input.
+	Executor& executor = Executor::shared();
+	size_t step = isDirect() ? 4096 : blockSize() - pulseSamples() + 1;
+	size_t steps = (length + step - 1) / step;
+	std::vector<std::vector<std::complex<float>>> scratch(executor.threads());
+	executor.parallelFor("Compression", steps, executor.grainFor(2 * step * sizeof(std::complex<float>)), [&](size_t first, size_t last, unsigned thread)
+	{
+		compressRange(input, output, first * step, std::min(length, last * step), scratch[thread]);
+	}, m_threads);
+}
+
+void PulseCompressor::compressPRIs(std::span<const std::complex<float>> input, size_t priSamples, std::span<std::complex<float>> output) const
+{
+	if (output.size() < input.size()) throw std::invalid_argument("Pulse compression output is shorter than the input.");
+	if (priSamples == 0) throw std::invalid_argument("Pulse compression needs a PRI length.");
+	size_t pris = (input.size() + priSamples - 1) / priSamples;
+
+	// Chunks of whole PRIs, as many as fit in the cache with their output.
+	Executor& executor = Executor::shared();
+	std::vector<std::vector<std::complex<float>>> scratch(executor.threads());
+	executor.parallelFor("Compression (PRIs)", pris, executor.grainFor(2 * priSamples * sizeof(std::complex<float>)), [&](size_t first, size_t last, unsigned thread)
+	{
+		for (size_t pri = first; pri < last; pri++)
+		{
+			size_t begin = pri * priSamples;
+			size_t count = std::min(priSamples, input.size() - begin);
+			compressRange(input.subspan(begin, count), output.subspan(begin, count), 0, count, scratch[thread]);
+		}
+	}, m_threads);
+}
+
+void PulseCompressor::compress(DataCube& cube) const
+{
+	size_t pulses = cube.pulses() * cube.channels();
+	Executor& executor = Executor::shared();
+	struct Buffers
+	{
+		std::vector<std::complex<float>> scratch;
+		std::vector<std::complex<float>> input;
+		std::vector<std::complex<float>> output;
+	};
+	std::vector<Buffers> buffers(executor.threads());
+	executor.parallelFor("Compression (cube)", pulses, executor.grainFor(2 * cube.rangeBins() * sizeof(std::complex<float>)), [&](size_t first, size_t last, unsigned thread)
+	{
+		std::vector<std::complex<float>>& scratch = buffers[thread].scratch;
+		std::vector<std::complex<float>>& input = buffers[thread].input;
+		std::vector<std::complex<float>>& output = buffers[thread].output;
+		input.resize(cube.rangeBins());
+		output.resize(cube.rangeBins());
+		for (size_t index = first; index < last; index++)
+		{
+			StridedView<std::complex<float>> line = cube.rangeLine(index % cube.pulses(), index / cube.pulses());
+			for (size_t n = 0; n < line.size(); n++) input[n] = line[n];
+			if (line.contiguous()) compressRange(input, line.span(), 0, line.size(), scratch);
+			else
+			{
+				compressRange(input, output, 0, line.size(), scratch);
+				for (size_t n = 0; n < line.size(); n++) line[n] = output[n];
+			}
+		}
+	}, m_threads);
+}
+
+// ================================================================================================================================================================================ //
+//  Reference.                                                                                                                                                                      //
+// ================================================================================================================================================================================ //
+
+void pulseCompressionReference(std::span<const std::complex<float>> pulse, std::span<const std::complex<float>> pri, std::span<std::complex<float>> output)
+{
+	int PULSE_SAMPLES = (int)pulse.size();
+	int PRF_SAMPLES = (int)pri.size();
+
+	//  Find conj of tx pulse to use as matched filter
+	std::vector<std::complex<float>> TX_Signal_Pulse_Conj(PULSE_SAMPLES);
+	for (int j = 0; j < PULSE_SAMPLES; j++)
+		TX_Signal_Pulse_Conj[j] = std::conj(pulse[j]);
+
+	//  Add the zeros to be able to convolute.  One extra zero keeps a single sample pulse in bounds.
+	std::vector<std::complex<float>> DataZeros(PRF_SAMPLES + 2 * (PULSE_SAMPLES - 1) + 1, std::complex<float>(0, 0));
+	std::copy(pri.begin(), pri.end(), DataZeros.begin() + (PULSE_SAMPLES - 1));
+
+	//  Convolute the pulse
+	for (int n = 0; n < PRF_SAMPLES; n++)
+	{
+		std::complex<float> sum(0, 0);
+		for (int m = 0; m < PULSE_SAMPLES; m++)
+			sum += TX_Signal_Pulse_Conj[m] * DataZeros[(m + 1) + (PULSE_SAMPLES - 1) / 2 + n];
+		output[n] = sum;
+	}
+}
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
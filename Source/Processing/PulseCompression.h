@@ -0,0 +1,102 @@
+#pragma once
+
+/*
+* Pulse compression (matched filtering) of received data.  The spectrum of the matched filter
+* is computed once and the data is filtered with overlap-save FFT blocks, or with a direct
+* convolution when the pulse is so short that it is cheaper.  The output is aligned exactly as
+* the original skripsie loop, which is kept as pulseCompressionReference().
+*/
+
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include <vector>
+#include <complex>
+#include <span>
+#include <string>
+#include <memory>
+#include "../Utils/FFT.h"
+#include "../Utils/WindowFunctions.h"
+#include "DataCube.h"
+#include "Executor.h"
+#include "MatchedFilterCache.h"
+
+// ================================================================================================================================================================================ //
+//  Types.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+struct CompressionParameters
+{
+	size_t segmentSamples = 0;		// Length of the segments compressed separately (the PRI), 0 for a continuous stream.
+	size_t blockSize = 0;			// FFT size of the overlap-save blocks, 0 chooses the cheapest for the pulse and segment.
+	bool allowDirect = true;		// Use direct convolution when it is cheaper than the FFT blocks.
+	std::string planning = "Estimate";	// "Estimate" chooses the block size from the cost model, "Measure" times the sizes once and keeps the fastest.
+	std::string window = "None";	// Window on the taps, lowers the range sidelobes for some loss of SNR, see windowTypes().
+	WindowParameters windowParameters;
+	unsigned threads = 0;			// Threads of the shared executor used, 0 uses all of them.
+};
+
+// ================================================================================================================================================================================ //
+//  Compressor.                                                                                                                                                                     //
+// ================================================================================================================================================================================ //
+
+class PulseCompressor
+{
+public:
+
+	// Get the matched filter of the transmitted pulse from the shared cache, it is only computed
+	// by the first compressor of the pulse, block size and window.
+	explicit PulseCompressor(std::span<const std::complex<float>> pulse, const CompressionParameters& parameters = CompressionParameters());
+
+	size_t pulseSamples() const { return m_filter->taps.size(); }
+	size_t blockSize() const { return m_filter->plan ? m_filter->plan->size() : 0; }
+	bool isDirect() const { return !m_filter->plan; }
+	// E.g. "overlap-save, 4096 point blocks" or "direct".
+	std::string describe() const;
+
+	// Compress the input as one continuous segment, with zeros outside of it.  The output has the
+	// same length as the input.  Long inputs are split over the threads.
+	void compress(std::span<const std::complex<float>> input, std::span<std::complex<float>> output) const;
+
+	// Compress every PRI of a capture on its own, as the processing has always done.  A partial
+	// PRI at the end is compressed as well.  The PRIs are split over the threads.
+	void compressPRIs(std::span<const std::complex<float>> input, size_t priSamples, std::span<std::complex<float>> output) const;
+
+	// Compress every pulse of the cube in place, in either layout.  The pulses are split over the
+	// threads, each of which only keeps a copy of the pulse it is working on.
+	void compress(DataCube& cube) const;
+
+private:
+
+	std::shared_ptr<const MatchedFilter> m_filter;	// Shared with the other compressors of the pulse.
+	size_t m_shift = 0;								// Output n is sample n + m_shift of the full convolution.
+	unsigned m_threads = 0;
+
+	PulseCompressor(std::shared_ptr<const MatchedFilter> filter, unsigned threads);
+
+	// The block size the parameters ask for, 0 for the direct convolution.  Measured sizes are
+	// kept in the cache.
+	static size_t planBlockSize(std::span<const std::complex<float>> pulse, const CompressionParameters& parameters);
+	// Time every block size on one thread and return the fastest.
+	static size_t measureBlockSize(std::span<const std::complex<float>> pulse, const CompressionParameters& parameters);
+
+	// Compress outputs [begin, end) of the segment.  scratch holds one block.
+	void compressRange(std::span<const std::complex<float>> input, std::span<std::complex<float>> output, size_t begin, size_t end, std::vector<std::complex<float>>& scratch) const;
+};
+
+// The FFT size with the lowest cost per output for the pulse and segment length (0 for a
+// continuous stream), and whether the direct convolution would be cheaper still.
+size_t chooseBlockSize(size_t pulseSamples, size_t segmentSamples, bool& direct);
+
+// ================================================================================================================================================================================ //
+//  Reference.                                                                                                                                                                      //
+// ================================================================================================================================================================================ //
+
+// The original O(N.M) matched filter of the skripsie code for one PRI, including its zero padding
+// and output alignment.  Kept to check the compressor against.
+void pulseCompressionReference(std::span<const std::complex<float>> pulse, std::span<const std::complex<float>> pri, std::span<std::complex<float>> output);
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
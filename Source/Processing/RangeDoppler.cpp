@@ -0,0 +1,123 @@
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include "RangeDoppler.h"
+#include "../Utils/ComplexKernels.h"
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+// ================================================================================================================================================================================ //
+//  Processor.                                                                                                                                                                      //
+// ================================================================================================================================================================================ //
+
+namespace
+{
+	// Range bins gathered together from a pulse major cube, so that every pulse is read a
+	// cache line at a time instead of one sample at a time.
+	const size_t rangeBlock = 16;
+}
+
+DopplerProcessor::DopplerProcessor(size_t pulsesPerCPI, const DopplerParameters& parameters)
+	: m_pulsesPerCPI(pulsesPerCPI),
+	  m_plan(sharedPlan(nextPowerOfTwo(std::max(parameters.fftSize, std::max<size_t>(pulsesPerCPI, 1))))),
+	  m_window(getWindow(parameters.window, (int)pulsesPerCPI, parameters.windowParameters)),
+	  m_decibels(parameters.decibels),
+	  m_threads(parameters.threads)
+{
+	if (pulsesPerCPI == 0) throw std::invalid_argument("A CPI needs at least one pulse.");
+}
+
+void DopplerProcessor::processRange(const DataCube& cube, size_t channel, RangeDopplerMap& map, size_t begin, size_t end, std::vector<std::complex<float>>& scratch) const
+{
+	const size_t fftSize = m_plan->size();
+	const size_t half = fftSize / 2;
+	const ComplexKernels& kernels = complexKernels();
+	scratch.resize(rangeBlock * fftSize);
+	for (size_t blockStart = begin; blockStart < end; blockStart += rangeBlock)
+	{
+		size_t blockSize = std::min(rangeBlock, end - blockStart);
+
+		// Gather the windowed slow time samples of the block, zero padded to the FFT size.
+		std::fill(scratch.begin(), scratch.end(), std::complex<float>(0, 0));
+		for (size_t pulse = 0; pulse < m_pulsesPerCPI; pulse++)
+		{
+			float weight = m_window[pulse];
+			for (size_t r = 0; r < blockSize; r++)
+				scratch[r * fftSize + pulse] = cube.at(blockStart + r, map.firstPulse + pulse, channel) * weight;
+		}
+
+		// Transform and store the shifted magnitudes.
+		for (size_t r = 0; r < blockSize; r++)
+		{
+			std::span<std::complex<float>> column(scratch.data() + r * fftSize, fftSize);
+			m_plan->forward(column);
+			float* row = &map.values[(blockStart + r) * fftSize];
+			if (m_decibels)
+			{
+				kernels.magnitudeSquared(column.data() + half, row, fftSize - half);
+				kernels.magnitudeSquared(column.data(), row + fftSize - half, half);
+				for (size_t doppler = 0; doppler < fftSize; doppler++) row[doppler] = 10.f * std::log10(row[doppler] + 1e-30f);
+			}
+			else
+			{
+				kernels.magnitude(column.data() + half, row, fftSize - half);
+				kernels.magnitude(column.data(), row + fftSize - half, half);
+			}
+		}
+	}
+}
+
+RangeDopplerMap DopplerProcessor::process(const DataCube& cube, size_t cpi, size_t channel) const
+{
+	if ((cpi + 1) * m_pulsesPerCPI > cube.pulses()) throw std::out_of_range("CPI " + std::to_string(cpi) + " is not in the data cube.");
+	RangeDopplerMap map;
+	map.rangeBins = cube.rangeBins();
+	map.dopplerBins = m_plan->size();
+	map.firstPulse = cpi * m_pulsesPerCPI;
+	map.decibels = m_decibels;
+	map.values.resize(map.rangeBins * map.dopplerBins);
+
+	// Range bins are split over the threads in whole blocks.
+	Executor& executor = Executor::shared();
+	size_t blocks = (map.rangeBins + rangeBlock - 1) / rangeBlock;
+	std::vector<std::vector<std::complex<float>>> scratch(executor.threads());
+	executor.parallelFor("Doppler", blocks, executor.grainFor(rangeBlock * (m_pulsesPerCPI + map.dopplerBins) * sizeof(std::complex<float>)), [&](size_t first, size_t last, unsigned thread)
+	{
+		processRange(cube, channel, map, first * rangeBlock, std::min(map.rangeBins, last * rangeBlock), scratch[thread]);
+	}, m_threads);
+	return map;
+}
+
+std::vector<RangeDopplerMap> DopplerProcessor::processAll(const DataCube& cube, size_t channel) const
+{
+	std::vector<RangeDopplerMap> maps(cpis(cube));
+	for (size_t cpi = 0; cpi < maps.size(); cpi++)
+	{
+		maps[cpi].rangeBins = cube.rangeBins();
+		maps[cpi].dopplerBins = m_plan->size();
+		maps[cpi].firstPulse = cpi * m_pulsesPerCPI;
+		maps[cpi].decibels = m_decibels;
+		maps[cpi].values.resize(cube.rangeBins() * m_plan->size());
+	}
+
+	// Every block of range bins of every CPI is a work item, so all of the CPIs are one loop.
+	Executor& executor = Executor::shared();
+	size_t blocks = (cube.rangeBins() + rangeBlock - 1) / rangeBlock;
+	size_t items = blocks * maps.size();
+	std::vector<std::vector<std::complex<float>>> scratch(executor.threads());
+	executor.parallelFor("Doppler", items, executor.grainFor(rangeBlock * (m_pulsesPerCPI + m_plan->size()) * sizeof(std::complex<float>)), [&](size_t first, size_t last, unsigned thread)
+	{
+		for (size_t item = first; item < last; item++)
+		{
+			size_t block = item % blocks;
+			processRange(cube, channel, maps[item / blocks], block * rangeBlock, std::min(cube.rangeBins(), (block + 1) * rangeBlock), scratch[thread]);
+		}
+	}, m_threads);
+	return maps;
+}
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
@@ -0,0 +1,86 @@
+#pragma once
+
+/*
+* Range-Doppler processing of compressed pulses.  The pulses of a data cube are grouped into
+* coherent processing intervals (CPIs), and every range bin of a CPI is windowed in slow time
+* and transformed with an FFT.  Blocks of range bins are spread over the executor threads.
+*/
+
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include <vector>
+#include <complex>
+#include <string>
+#include "DataCube.h"
+#include "Executor.h"
+#include "../Utils/FFT.h"
+#include "../Utils/WindowFunctions.h"
+
+// ================================================================================================================================================================================ //
+//  Types.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+struct DopplerParameters
+{
+	size_t fftSize = 0;					// Slow time FFT size, zero padded, 0 is the next power of two of the CPI.
+	std::string window = "Hamming";		// Slow time window, see windowTypes().
+	WindowParameters windowParameters;
+	bool decibels = true;				// Store 20 log10 |X| instead of |X|.
+	unsigned threads = 0;				// Threads of the shared executor used, 0 uses all of them.
+};
+
+// Magnitude map of one CPI, one row of Doppler bins per range bin.  The FFT output is shifted
+// so that zero Doppler is bin dopplerBins / 2.
+struct RangeDopplerMap
+{
+	size_t rangeBins = 0;
+	size_t dopplerBins = 0;
+	size_t firstPulse = 0;				// First pulse of the CPI in the cube.
+	bool decibels = true;
+	std::vector<float> values;			// values[range * dopplerBins + doppler].
+
+	float& at(size_t range, size_t doppler) { return values[range * dopplerBins + doppler]; }
+	float at(size_t range, size_t doppler) const { return values[range * dopplerBins + doppler]; }
+	// Doppler frequency of a bin for the given PRF [Hz].
+	float dopplerFrequency(size_t doppler, float prf) const { return ((float)doppler - (float)(dopplerBins / 2)) * prf / dopplerBins; }
+};
+
+// ================================================================================================================================================================================ //
+//  Processor.                                                                                                                                                                      //
+// ================================================================================================================================================================================ //
+
+class DopplerProcessor
+{
+public:
+
+	// The window table and FFT plan are prepared once for the CPI length.
+	DopplerProcessor(size_t pulsesPerCPI, const DopplerParameters& parameters = DopplerParameters());
+
+	size_t pulsesPerCPI() const { return m_pulsesPerCPI; }
+	size_t dopplerBins() const { return m_plan->size(); }
+	// Number of whole CPIs in the cube.
+	size_t cpis(const DataCube& cube) const { return cube.pulses() / m_pulsesPerCPI; }
+
+	// Map of a single CPI.
+	RangeDopplerMap process(const DataCube& cube, size_t cpi, size_t channel = 0) const;
+	// Maps of every whole CPI in the cube, all of them processed in one pass over the threads.
+	std::vector<RangeDopplerMap> processAll(const DataCube& cube, size_t channel = 0) const;
+
+private:
+
+	size_t m_pulsesPerCPI;
+	std::shared_ptr<const FFTPlan> m_plan;
+	std::vector<float> m_window;		// Slow time weights, one per pulse of the CPI.
+	bool m_decibels;
+	unsigned m_threads;
+
+	// Transform range bins [begin, end) of the CPI into the map.  scratch holds the slow time
+	// samples of a block of range bins.
+	void processRange(const DataCube& cube, size_t channel, RangeDopplerMap& map, size_t begin, size_t end, std::vector<std::complex<float>>& scratch) const;
+};
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
@@ -0,0 +1,98 @@
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include "RangeGate.h"
+#include <cmath>
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+#include <stdexcept>
+
+// ================================================================================================================================================================================ //
+//  Gate.                                                                                                                                                                           //
+// ================================================================================================================================================================================ //
+
+std::string RangeGate::describe() const
+{
+	std::ostringstream text;
+	text << "samples " << first << " - " << first + count - 1 << " of " << priSamples << " (" << std::fixed << std::setprecision(1) << 100 * fraction() << " %)";
+	return text.str();
+}
+
+RangeGate rangeGateFromRanges(double minRange, double maxRange, double samplingFreq, size_t priSamples, size_t pulseSamples)
+{
+	// The echo of range R starts 2 R / c after the pulse.
+	const double c = 299792458;
+	if (samplingFreq <= 0 || maxRange < minRange) throw std::invalid_argument("A range gate needs a sampling frequency and a window.");
+	RangeGate gate;
+	gate.priSamples = priSamples;
+	size_t first = (size_t)std::floor(std::max(0.0, 2 * minRange * samplingFreq / c));
+	size_t end = (size_t)std::ceil(2 * maxRange * samplingFreq / c) + pulseSamples;
+	gate.first = std::min(first, priSamples);
+	gate.count = std::min(end, priSamples) - gate.first;
+	return gate;
+}
+
+// ================================================================================================================================================================================ //
+//  Stage.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+RangeGateStage::RangeGateStage(const RangeGate& gate, std::span<const std::complex<float>> pulse, const SyncParameters& sync)
+	: m_gate(gate), m_pulse(pulse.begin(), pulse.end()), m_syncParameters(sync)
+{
+	if (!m_gate.valid()) throw std::invalid_argument("The range gate does not fit in the PRI.");
+	m_gridKnown = m_pulse.empty();
+	if (m_gridKnown) m_sync.offset = m_gate.gridOffset;
+}
+
+void RangeGateStage::process(std::span<const std::complex<float>> input, std::vector<std::complex<float>>& output)
+{
+	output.clear();
+	if (m_gridKnown) { gate(input, output); return; }
+
+	// Hold the stream back until there are enough PRIs to synchronise on.
+	m_held.insert(m_held.end(), input.begin(), input.end());
+	size_t needed = (m_syncParameters.skipPRIs + m_syncParameters.pris) * m_gate.priSamples + m_pulse.size();
+	if (m_held.size() >= needed) synchronise(output);
+}
+
+void RangeGateStage::finish(std::vector<std::complex<float>>& output)
+{
+	output.clear();
+	if (!m_gridKnown && m_held.size() >= m_gate.priSamples + m_pulse.size()) synchronise(output);
+}
+
+void RangeGateStage::synchronise(std::vector<std::complex<float>>& output)
+{
+	m_sync = synchronisePulseGrid(m_held, m_pulse, m_gate.priSamples, m_syncParameters);
+	if (!m_sync.found) m_sync.offset = m_gate.gridOffset;
+	m_gridKnown = true;
+	gate(m_held, output);
+	m_held.clear();
+	m_held.shrink_to_fit();
+}
+
+void RangeGateStage::gate(std::span<const std::complex<float>> input, std::vector<std::complex<float>>& output)
+{
+	// Whole runs of kept samples are copied, the position in the PRI is tracked from the grid.
+	const size_t pri = m_gate.priSamples;
+	const size_t offset = m_sync.offset % pri;
+	size_t index = 0;
+	while (index < input.size())
+	{
+		size_t position = m_position + index;
+		size_t phase = (position + pri - offset) % pri;
+		if (position < m_sync.offset) { index += std::min(input.size() - index, m_sync.offset - position); continue; }
+		if (phase < m_gate.first) { index += std::min(input.size() - index, m_gate.first - phase); continue; }
+		if (phase >= m_gate.first + m_gate.count) { index += std::min(input.size() - index, pri - phase); continue; }
+		size_t run = std::min(input.size() - index, m_gate.first + m_gate.count - phase);
+		output.insert(output.end(), input.begin() + index, input.begin() + index + run);
+		index += run;
+	}
+	m_position += input.size();
+}
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
@@ -0,0 +1,84 @@
+#pragma once
+
+/*
+* Range gating while capturing.  Only a window of samples of every PRI is kept, e.g. from the
+* end of the transmit pulse to the maximum range, so the samples of ranges that are not of
+* interest are never stored or processed.  The PRI grid is found by synchronising to the pulse
+* on the first PRIs of the stream, or given as an offset.
+*/
+
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include <vector>
+#include <complex>
+#include <span>
+#include <string>
+#include "Synchronisation.h"
+
+// ================================================================================================================================================================================ //
+//  Gate.                                                                                                                                                                           //
+// ================================================================================================================================================================================ //
+
+struct RangeGate
+{
+	size_t priSamples = 0;
+	size_t first = 0;				// First sample kept, counted from the start of the pulse.
+	size_t count = 0;				// Samples kept of every PRI.
+	size_t gridOffset = 0;			// Sample of the stream where a PRI starts, when it is not synchronised.
+
+	bool valid() const { return priSamples && count && first + count <= priSamples; }
+	// Fraction of the samples that is kept.
+	double fraction() const { return priSamples ? (double)count / priSamples : 0; }
+	// E.g. "samples 241 - 1399 of 2400 (48.3 %)".
+	std::string describe() const;
+};
+
+// The gate that keeps the echoes from minRange to maxRange [m].  The whole echo of a pulse at
+// maxRange is kept, so the gated samples can still be compressed without losing a range.
+RangeGate rangeGateFromRanges(double minRange, double maxRange, double samplingFreq, size_t priSamples, size_t pulseSamples);
+
+// ================================================================================================================================================================================ //
+//  Stage.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+class RangeGateStage
+{
+public:
+
+	// Without a pulse the grid starts at gate.gridOffset.  With a pulse, the first PRIs are held
+	// back until the grid is synchronised, and the gate falls back to gridOffset if the pulse is
+	// not found.
+	RangeGateStage(const RangeGate& gate, std::span<const std::complex<float>> pulse = {}, const SyncParameters& sync = SyncParameters());
+
+	// The kept samples of the input, in order, replace the contents of output.  Samples before
+	// the first PRI of the grid are not kept.
+	void process(std::span<const std::complex<float>> input, std::vector<std::complex<float>>& output);
+	// The kept samples of a stream that ended before the grid was synchronised, synchronised on
+	// the PRIs that did arrive.
+	void finish(std::vector<std::complex<float>>& output);
+
+	const RangeGate& gate() const { return m_gate; }
+	bool gridKnown() const { return m_gridKnown; }
+	// The synchronisation result, not found when the gate was given an offset.
+	const PulseGridSync& sync() const { return m_sync; }
+	size_t samplesIn() const { return m_position; }
+
+private:
+
+	RangeGate m_gate;
+	std::vector<std::complex<float>> m_pulse;
+	SyncParameters m_syncParameters;
+	PulseGridSync m_sync;
+	bool m_gridKnown = false;
+	std::vector<std::complex<float>> m_held;		// Stream held back until the grid is known.
+	size_t m_position = 0;							// Samples of the stream gated so far.
+
+	void synchronise(std::vector<std::complex<float>>& output);
+	void gate(std::span<const std::complex<float>> input, std::vector<std::complex<float>>& output);
+};
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
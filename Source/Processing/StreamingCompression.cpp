@@ -0,0 +1,161 @@
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include "StreamingCompression.h"
+#include "Executor.h"
+#include <algorithm>
+
+// ================================================================================================================================================================================ //
+//  Setup.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+namespace
+{
+	CompressionParameters streamParameters(unsigned threads)
+	{
+		// A batch is one continuous segment, split over the threads of the executor.
+		CompressionParameters parameters;
+		parameters.segmentSamples = 0;
+		parameters.threads = threads;
+		return parameters;
+	}
+}
+
+StreamingCompressor::StreamingCompressor(std::span<const std::complex<float>> pulse, size_t priSamples, const std::string& file, const StreamingParameters& parameters)
+	: m_compressor(pulse, streamParameters(parameters.threads)), m_context(pulse.size()), m_maxPending(std::max<size_t>(1, parameters.maxPendingBatches))
+{
+	size_t pri = std::max<size_t>(1, priSamples);
+	m_batchSamples = std::max<size_t>(1, (parameters.batchSamples + pri - 1) / pri) * pri;
+	if (parameters.mti != "Disabled")
+	{
+		MTIParameters mti;
+		mti.canceller = parameters.mti;
+		m_mti = std::make_unique<MTIStream>(MTIFilter(mti), pri);
+	}
+	m_file.open(file, std::ofstream::binary);
+	m_open = m_file.is_open();
+	m_threads = parameters.threads;
+	m_worker = std::thread([this]() { work(); });
+}
+
+StreamingCompressor::~StreamingCompressor()
+{
+	finish();
+}
+
+unsigned StreamingCompressor::threads() const
+{
+	unsigned available = Executor::shared().threads();
+	return m_threads ? std::min(m_threads, available) : available;
+}
+
+// ================================================================================================================================================================================ //
+//  RX thread.                                                                                                                                                                      //
+// ================================================================================================================================================================================ //
+
+void StreamingCompressor::push(std::span<const std::complex<float>> samples)
+{
+	if (m_finished) return;
+	m_stream.insert(m_stream.end(), samples.begin(), samples.end());
+	// A batch is queued once the context after it has arrived as well.
+	while (m_stream.size() >= m_streamLeading + m_batchSamples + m_context) queueBatch(m_batchSamples, m_context);
+}
+
+void StreamingCompressor::queueBatch(size_t samples, size_t trailing)
+{
+	Batch batch;
+	batch.samples = samples;
+	batch.leading = m_streamLeading;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_pending >= m_maxPending) batch.dropped = true;
+		else
+		{
+			m_pending++;
+			if (!m_freeBuffers.empty()) { batch.input = std::move(m_freeBuffers.back()); m_freeBuffers.pop_back(); }
+		}
+	}
+	if (batch.dropped) m_samplesDropped += samples;
+	else batch.input.assign(m_stream.begin(), m_stream.begin() + m_streamLeading + samples + trailing);
+
+	// The end of the batch is the leading context of the next one.
+	size_t leading = std::min(m_context, m_streamLeading + samples);
+	m_stream.erase(m_stream.begin(), m_stream.begin() + (m_streamLeading + samples - leading));
+	m_streamLeading = leading;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_queue.push_back(std::move(batch));
+	}
+	m_queueSignal.notify_one();
+}
+
+void StreamingCompressor::finish()
+{
+	if (m_finished) return;
+	if (m_stream.size() > m_streamLeading) queueBatch(m_stream.size() - m_streamLeading, 0);
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_finishing = true;
+	}
+	m_queueSignal.notify_all();
+	if (m_worker.joinable()) m_worker.join();
+	m_file.close();
+	m_stream.clear();
+	m_finished = true;
+}
+
+// ================================================================================================================================================================================ //
+//  Worker.                                                                                                                                                                         //
+// ================================================================================================================================================================================ //
+
+void StreamingCompressor::work()
+{
+	std::vector<std::complex<float>> output;
+	while (true)
+	{
+		Batch batch;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_queueSignal.wait(lock, [this]() { return !m_queue.empty() || m_finishing; });
+			if (m_queue.empty()) return;
+			batch = std::move(m_queue.front());
+			m_queue.pop_front();
+		}
+
+		std::span<const std::complex<float>> result;
+		if (batch.dropped)
+		{
+			output.assign(batch.samples, std::complex<float>(0, 0));
+			result = output;
+		}
+		else
+		{
+			// The batch is split over the threads of the executor.
+			output.resize(batch.input.size());
+			m_compressor.compress(batch.input, output);
+			result = std::span<const std::complex<float>>(output).subspan(batch.leading, batch.samples);
+		}
+
+		if (m_mti)
+		{
+			m_cancelled.resize(result.size());
+			m_mti->process(result, m_cancelled);
+			result = m_cancelled;
+		}
+		if (m_open) m_file.write((const char*)result.data(), result.size() * sizeof(std::complex<float>));
+		m_samplesWritten += result.size();
+
+		if (!batch.dropped)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_pending--;
+			m_freeBuffers.push_back(std::move(batch.input));
+		}
+	}
+}
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
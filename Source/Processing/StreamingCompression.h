@@ -0,0 +1,111 @@
+#pragma once
+
+/*
+* Pulse compression while the capture is running.  The RX thread hands every received buffer
+* to the compressor, which collects the samples into batches and hands them to a worker thread,
+* so the RX thread only copies.  The worker compresses every batch on the shared executor, so it
+* runs with the threads, reserved cores and pinning the executor was configured with.  The capture is compressed as one continuous stream,
+* every batch is given the samples around it, so the output is the same as compressing the
+* whole file afterwards and lines up with the raw samples, one range line per PRI.  An MTI
+* canceller can run on the compressed stream, in which case only the cancelled samples are written.
+*/
+
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include <vector>
+#include <complex>
+#include <span>
+#include <string>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include "PulseCompression.h"
+#include "MTI.h"
+
+// ================================================================================================================================================================================ //
+//  Types.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+struct StreamingParameters
+{
+	size_t batchSamples = (size_t)1 << 18;	// Samples compressed per batch, rounded up to whole PRIs.
+	size_t maxPendingBatches = 16;			// Batches waiting for the worker before new ones are dropped.
+	unsigned threads = 0;					// Threads of the shared executor used per batch, 0 uses all of them.
+	std::string mti = "Disabled";			// MTI canceller run on the compressed PRIs before writing, e.g. "2-pulse", see MTIParameters.
+};
+
+// ================================================================================================================================================================================ //
+//  Compressor.                                                                                                                                                                     //
+// ================================================================================================================================================================================ //
+
+class StreamingCompressor
+{
+public:
+
+	// Open the output file and start the worker.
+	StreamingCompressor(std::span<const std::complex<float>> pulse, size_t priSamples, const std::string& file, const StreamingParameters& parameters = StreamingParameters());
+	// Finishes the stream if finish() was not called.
+	~StreamingCompressor();
+
+	StreamingCompressor(const StreamingCompressor&) = delete;
+	StreamingCompressor& operator=(const StreamingCompressor&) = delete;
+
+	bool isOpen() const { return m_open; }
+	// Called by the RX thread with every buffer, in order.  Never waits for the worker, when it
+	// falls behind the batch is dropped and zeros are written in its place.
+	void push(std::span<const std::complex<float>> samples);
+	// Compress what is left, wait for the worker and close the file.
+	void finish();
+
+	size_t samplesWritten() const { return m_samplesWritten; }
+	size_t samplesDropped() const { return m_samplesDropped; }
+	unsigned threads() const;
+
+private:
+
+	struct Batch
+	{
+		size_t samples = 0;							// Output samples of the batch.
+		size_t leading = 0;							// Context samples in front of the batch.
+		bool dropped = false;
+		std::vector<std::complex<float>> input;		// Leading context, the batch and trailing context.
+	};
+
+	PulseCompressor m_compressor;
+	size_t m_context;								// Context needed on either side of a batch.
+	size_t m_batchSamples;
+	size_t m_maxPending;
+	unsigned m_threads = 0;							// Executor threads per batch, 0 for all of them.
+	std::ofstream m_file;
+	bool m_open = false;
+	std::unique_ptr<MTIStream> m_mti;				// Runs on the worker, it needs the previous PRIs.
+	std::vector<std::complex<float>> m_cancelled;
+
+	// Samples received but not yet batched, starting with the context of the next batch.
+	std::vector<std::complex<float>> m_stream;
+	size_t m_streamLeading = 0;						// Context samples at the start of m_stream.
+
+	// Batches are compressed and written in the order they are queued.
+	std::thread m_worker;
+	std::mutex m_mutex;								// Guards the queue and the buffers.
+	std::condition_variable m_queueSignal;
+	std::deque<Batch> m_queue;
+	std::vector<std::vector<std::complex<float>>> m_freeBuffers;
+	size_t m_pending = 0;							// Batches with data queued or being compressed.
+	bool m_finishing = false;
+	bool m_finished = false;
+	size_t m_samplesWritten = 0;
+	size_t m_samplesDropped = 0;
+
+	// Queue the first samples of m_stream as a batch, keeping the context of the next one.
+	void queueBatch(size_t samples, size_t trailing);
+	void work();
+};
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
@@ -0,0 +1,144 @@
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include "Synchronisation.h"
+#include "../Utils/FFT.h"
+#include "../Utils/ComplexKernels.h"
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+// ================================================================================================================================================================================ //
+//  Interpolation.                                                                                                                                                                  //
+// ================================================================================================================================================================================ //
+
+namespace
+{
+	// The averaged correlation is periodic in the PRI, so neighbours wrap around.
+	float sample(const std::vector<float>& values, long long index)
+	{
+		long long size = (long long)values.size();
+		return values[((index % size) + size) % size];
+	}
+
+	float parabolicOffset(const std::vector<float>& magnitude, size_t peak)
+	{
+		float before = sample(magnitude, (long long)peak - 1);
+		float centre = magnitude[peak];
+		float after = sample(magnitude, (long long)peak + 1);
+		float curvature = before - 2 * centre + after;
+		if (curvature >= 0) return 0;
+		return std::clamp(0.5f * (before - after) / curvature, -0.5f, 0.5f);
+	}
+
+	// Hann windowed sinc reconstruction of the magnitude at peak + offset.
+	float sincValue(const std::vector<float>& magnitude, size_t peak, unsigned taps, float offset)
+	{
+		float value = 0;
+		for (int k = -(int)taps; k <= (int)taps; k++)
+		{
+			float x = offset - k;
+			float sinc = (std::abs(x) < 1e-6f) ? 1.f : std::sin(std::numbers::pi_v<float> * x) / (std::numbers::pi_v<float> * x);
+			float window = 0.5f + 0.5f * std::cos(std::numbers::pi_v<float> * x / (taps + 1));
+			value += sample(magnitude, (long long)peak + k) * sinc * window;
+		}
+		return value;
+	}
+
+	// Golden section search for the maximum of the reconstruction within half a sample.
+	float sincOffset(const std::vector<float>& magnitude, size_t peak, unsigned taps)
+	{
+		const float ratio = 0.5f * (std::sqrt(5.f) - 1);
+		float low = -0.5f;
+		float high = 0.5f;
+		float a = high - ratio * (high - low);
+		float b = low + ratio * (high - low);
+		float valueA = sincValue(magnitude, peak, taps, a);
+		float valueB = sincValue(magnitude, peak, taps, b);
+		for (int iteration = 0; iteration < 32; iteration++)
+		{
+			if (valueA > valueB) { high = b; b = a; valueB = valueA; a = high - ratio * (high - low); valueA = sincValue(magnitude, peak, taps, a); }
+			else { low = a; a = b; valueA = valueB; b = low + ratio * (high - low); valueB = sincValue(magnitude, peak, taps, b); }
+		}
+		return 0.5f * (low + high);
+	}
+}
+
+// ================================================================================================================================================================================ //
+//  Synchronisation.                                                                                                                                                                //
+// ================================================================================================================================================================================ //
+
+PulseGridSync synchronisePulseGrid(std::span<const std::complex<float>> capture, std::span<const std::complex<float>> pulse, size_t priSamples, const SyncParameters& parameters)
+{
+	if (pulse.empty() || priSamples < pulse.size()) throw std::invalid_argument("Synchronisation needs a pulse that fits in the PRI.");
+	if (parameters.interpolation != "None" && parameters.interpolation != "Parabolic" && parameters.interpolation != "Sinc")
+		throw std::invalid_argument("Peak interpolation '" + parameters.interpolation + "' is not supported.");
+
+	// Every PRI is correlated with the pulse starting anywhere in it, so a PRI needs the pulse
+	// length of samples after it as well.
+	PulseGridSync sync;
+	const size_t pulseSamples = pulse.size();
+	const size_t first = parameters.skipPRIs * priSamples;
+	const size_t span = priSamples + pulseSamples - 1;
+	if (capture.size() < first + span) return sync;
+	size_t pris = std::min(parameters.pris, (capture.size() - first - span) / priSamples + 1);
+	if (!pris) return sync;
+
+	const FFTPlan& plan = *sharedPlan(nextPowerOfTwo(span));
+	const size_t size = plan.size();
+	std::vector<std::complex<float>> filter(size, std::complex<float>(0, 0));
+	std::copy(pulse.begin(), pulse.end(), filter.begin());
+	plan.forward(filter);
+	for (std::complex<float>& bin : filter) bin = std::conj(bin);
+
+	// --------------- //
+	//  A V E R A G E  //
+	// --------------- //
+
+	// Power is averaged rather than the complex correlation, the phase of the echo drifts from
+	// one PRI to the next.
+	std::vector<float> power(priSamples, 0.f);
+	std::vector<std::complex<float>> block(size);
+	for (size_t pri = 0; pri < pris; pri++)
+	{
+		const std::complex<float>* input = capture.data() + first + pri * priSamples;
+		std::copy(input, input + span, block.begin());
+		std::fill(block.begin() + span, block.end(), std::complex<float>(0, 0));
+		plan.forward(block);
+		complexMultiply(block, filter, block);
+		plan.inverse(block);
+		for (size_t lag = 0; lag < priSamples; lag++) power[lag] += std::norm(block[lag]);
+	}
+
+	// --------- //
+	//  P E A K  //
+	// --------- //
+
+	size_t peak = (size_t)(std::max_element(power.begin(), power.end()) - power.begin());
+	double mean = 0;
+	for (float value : power) mean += value;
+	mean /= priSamples;
+	sync.prisAveraged = pris;
+	sync.contrast = (mean > 0) ? 10.f * (float)std::log10(power[peak] / mean) : 0.f;
+	sync.found = (power[peak] > 0) && (sync.contrast >= parameters.minimumContrast);
+
+	// Refined on the magnitude, which is closer to a parabola and a band limited signal than
+	// the power.
+	std::vector<float> magnitude(priSamples);
+	for (size_t lag = 0; lag < priSamples; lag++) magnitude[lag] = std::sqrt(power[lag]);
+	float offset = 0;
+	if (parameters.interpolation == "Parabolic") offset = parabolicOffset(magnitude, peak);
+	else if (parameters.interpolation == "Sinc") offset = sincOffset(magnitude, peak, std::max(1u, parameters.sincTaps));
+
+	// The whole samples go into the offset, what is left is within half a sample.
+	long long start = (long long)peak + (long long)std::lround(offset);
+	sync.fraction = offset - (float)std::lround(offset);
+	start = ((start % (long long)priSamples) + (long long)priSamples) % (long long)priSamples;
+	sync.offset = first + (size_t)start;
+	return sync;
+}
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
@@ -0,0 +1,55 @@
+#pragma once
+
+/*
+* Synchronisation of a capture to the pulse grid.  Every PRI of the capture is correlated with
+* the pulse through an FFT, and the correlation power is averaged over the PRIs before the
+* peak is searched, so noise and a single bad PRI do not move it.  The peak is refined to a
+* fraction of a sample.  The result is an offset into the capture, the capture is not moved.
+*/
+
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include <vector>
+#include <complex>
+#include <span>
+#include <string>
+#include <algorithm>
+
+// ================================================================================================================================================================================ //
+//  Types.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+struct SyncParameters
+{
+	size_t skipPRIs = 0;					// PRIs at the start of the capture that are not used, e.g. while the RX settles.
+	size_t pris = 16;						// PRIs that are correlated and averaged.
+	std::string interpolation = "Sinc";		// Peak refinement, "None", "Parabolic" or "Sinc".
+	unsigned sincTaps = 8;					// Sinc: samples used on either side of the peak.
+	float minimumContrast = 6;				// Averaged peak over the mean correlation for the pulse to be found [dB].
+};
+
+struct PulseGridSync
+{
+	bool found = false;
+	size_t offset = 0;						// First sample of the first pulse after the skipped PRIs.
+	float fraction = 0;						// The pulse starts at offset + fraction, within half a sample.
+	float contrast = 0;						// Averaged peak over the mean correlation [dB].
+	size_t prisAveraged = 0;
+
+	// The capture from the first pulse on, as a view.
+	std::span<const std::complex<float>> apply(std::span<const std::complex<float>> capture) const { return capture.subspan(std::min(offset, capture.size())); }
+};
+
+// ================================================================================================================================================================================ //
+//  Synchronisation.                                                                                                                                                                //
+// ================================================================================================================================================================================ //
+
+// Find where the pulses start in a capture of a pulse that repeats every priSamples.  Uses as
+// many of the requested PRIs as the capture holds.
+PulseGridSync synchronisePulseGrid(std::span<const std::complex<float>> capture, std::span<const std::complex<float>> pulse, size_t priSamples, const SyncParameters& parameters = SyncParameters());
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
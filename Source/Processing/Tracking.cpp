@@ -0,0 +1,463 @@
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include "Tracking.h"
+#include <cmath>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <sstream>
+#include <cstring>
+
+// ================================================================================================================================================================================ //
+//  Setup.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+namespace
+{
+	// Cost of a pair outside of the gate, larger than any sum of gated pairs.
+	const float outsideGate = 1e9f;
+	const double speedOfLight = 299792458.0;
+}
+
+float rangeBinMetres(double samplingFreq)
+{
+	return (float)(speedOfLight / (2 * samplingFreq));
+}
+
+float velocityBinMetres(double carrierFreq, double prf, size_t dopplerBins)
+{
+	return dopplerBins ? (float)(-speedOfLight / carrierFreq * prf / (2.0 * dopplerBins)) : 0.f;
+}
+
+Tracker::Tracker(const TrackerParameters& parameters)
+	: m_parameters(parameters)
+{
+	if (parameters.filter != "Kalman" && parameters.filter != "Alpha-beta") throw std::invalid_argument("Unknown tracking filter \"" + parameters.filter + "\".");
+	if (parameters.rangeBin <= 0) throw std::invalid_argument("The tracker needs the range per bin.");
+	if (!parameters.maxTracks || !parameters.maxDetections) throw std::invalid_argument("The tracker needs room for tracks and detections.");
+	if (parameters.alpha <= 0 || parameters.alpha >= 1) throw std::out_of_range("The alpha of the tracker has to be between 0 and 1.");
+	if (!parameters.confirmHits || parameters.confirmHits > parameters.confirmUpdates || parameters.confirmUpdates > 32) throw std::out_of_range("The tracker needs confirmHits of at most confirmUpdates of at most 32 updates.");
+	m_kalman = parameters.filter == "Kalman";
+
+	size_t tracks = parameters.maxTracks;
+	size_t plots = parameters.maxDetections;
+	m_tracks.reserve(tracks);
+	m_plots.resize(plots);
+	m_strongest.reserve(plots);
+	m_distance.resize(tracks * plots);
+	m_parent.resize(tracks + plots);
+	m_order.resize(tracks + plots);
+	m_clusterStart.resize(tracks + plots + 1);
+	m_trackPlot.resize(tracks);
+	m_plotUsed.resize(plots);
+	m_u.resize(tracks + 1);
+	m_v.resize(tracks + plots + 1);
+	m_minimum.resize(tracks + plots + 1);
+	m_match.resize(tracks + plots + 1);
+	m_way.resize(tracks + plots + 1);
+	m_visited.resize(tracks + plots + 1);
+}
+
+// ================================================================================================================================================================================ //
+//  Filters.                                                                                                                                                                        //
+// ================================================================================================================================================================================ //
+
+void Tracker::predict(Track& track, double time) const
+{
+	float dt = (float)std::max(0.0, time - track.time);
+	track.time = time;
+	track.interval = dt;
+	track.range += track.velocity * dt;
+	if (!m_kalman) return;
+
+	// Constant velocity with white acceleration.
+	float q = m_parameters.accelerationNoise * m_parameters.accelerationNoise;
+	float* P = track.covariance;
+	float rr = P[0] + 2 * dt * P[1] + dt * dt * P[2] + q * dt * dt * dt * dt / 4;
+	float rv = P[1] + dt * P[2] + q * dt * dt * dt / 2;
+	float vv = P[2] + q * dt * dt;
+	P[0] = rr;
+	P[1] = rv;
+	P[2] = vv;
+}
+
+void Tracker::innovation(const Track& track, bool doppler, float S[3]) const
+{
+	float R0 = m_parameters.rangeNoise * m_parameters.rangeNoise;
+	float R1 = m_parameters.velocityNoise * m_parameters.velocityNoise;
+	if (m_kalman)
+	{
+		S[0] = track.covariance[0] + R0;
+		S[1] = track.covariance[1];
+		S[2] = track.covariance[2] + R1;
+		return;
+	}
+
+	// The steady state innovation of the alpha-beta filter, widened by the speed a new track
+	// may have until its range rate is known.
+	float spread = (!doppler && track.hits <= 1) ? track.interval * m_parameters.maxSpeed : 0.f;
+	S[0] = R0 / (1 - m_parameters.alpha) + spread * spread;
+	S[1] = 0;
+	S[2] = R1 / (1 - m_parameters.alpha);
+}
+
+float Tracker::distance(const Track& track, const Plot& plot, bool doppler) const
+{
+	float S[3];
+	innovation(track, doppler, S);
+	float er = plot.range - track.range;
+	if (!doppler) return er * er / S[0];
+	float ev = plot.velocity - track.velocity;
+	float determinant = S[0] * S[2] - S[1] * S[1];
+	return (er * er * S[2] - 2 * er * ev * S[1] + ev * ev * S[0]) / determinant;
+}
+
+void Tracker::correct(Track& track, const Plot& plot, bool doppler) const
+{
+	float er = plot.range - track.range;
+	float ev = plot.velocity - track.velocity;
+	float* P = track.covariance;
+	track.snr = plot.snr;
+
+	if (!m_kalman)
+	{
+		// A measured range rate is smoothed with alpha in place of the range residual over the
+		// interval, which is far noisier at the PRF of a CPI.
+		track.range += m_parameters.alpha * er;
+		if (doppler) track.velocity += m_parameters.alpha * ev;
+		else if (track.interval > 0) track.velocity += m_parameters.beta / track.interval * er;
+		P[0] = m_parameters.alpha * m_parameters.rangeNoise * m_parameters.rangeNoise;
+		P[1] = 0;
+		P[2] = m_parameters.alpha * m_parameters.velocityNoise * m_parameters.velocityNoise;
+		return;
+	}
+
+	float S[3];
+	innovation(track, doppler, S);
+	if (!doppler)
+	{
+		float k0 = P[0] / S[0];
+		float k1 = P[1] / S[0];
+		track.range += k0 * er;
+		track.velocity += k1 * er;
+		float rr = P[0] - k0 * P[0];
+		float rv = P[1] - k0 * P[1];
+		float vv = P[2] - k1 * P[1];
+		P[0] = rr;
+		P[1] = rv;
+		P[2] = vv;
+		return;
+	}
+
+	// K = P S^-1, x += K e and P -= K P, with the measurement matrix the identity.
+	float determinant = S[0] * S[2] - S[1] * S[1];
+	float i00 = S[2] / determinant, i01 = -S[1] / determinant, i11 = S[0] / determinant;
+	float k00 = P[0] * i00 + P[1] * i01, k01 = P[0] * i01 + P[1] * i11;
+	float k10 = P[1] * i00 + P[2] * i01, k11 = P[1] * i01 + P[2] * i11;
+	track.range += k00 * er + k01 * ev;
+	track.velocity += k10 * er + k11 * ev;
+	float rr = P[0] - (k00 * P[0] + k01 * P[1]);
+	float rv = P[1] - (k00 * P[1] + k01 * P[2]);
+	float vv = P[2] - (k10 * P[1] + k11 * P[2]);
+	P[0] = rr;
+	P[1] = rv;
+	P[2] = vv;
+}
+
+void Tracker::start(const Plot& plot, double time, bool doppler)
+{
+	if (m_tracks.size() == m_parameters.maxTracks)
+	{
+		m_statistics.tracksRefused++;
+		return;
+	}
+
+	// Without Doppler the range rate is unknown, anything up to maxSpeed.
+	Track& track = m_tracks.emplace_back();
+	track.id = m_nextId++;
+	track.time = time;
+	track.range = plot.range;
+	track.velocity = doppler ? plot.velocity : 0.f;
+	track.covariance[0] = m_parameters.rangeNoise * m_parameters.rangeNoise;
+	track.covariance[2] = doppler ? m_parameters.velocityNoise * m_parameters.velocityNoise : m_parameters.maxSpeed * m_parameters.maxSpeed;
+	track.snr = plot.snr;
+	track.history = 1;
+	track.updates = 1;
+	track.hits = 1;
+	track.hit = true;
+	m_statistics.tracksStarted++;
+	if (m_parameters.confirmHits == 1)
+	{
+		track.status = TrackStatus::Confirmed;
+		m_statistics.tracksConfirmed++;
+	}
+}
+
+// ================================================================================================================================================================================ //
+//  Association.                                                                                                                                                                    //
+// ================================================================================================================================================================================ //
+
+uint32_t Tracker::find(uint32_t node)
+{
+	while (m_parent[node] != node)
+	{
+		m_parent[node] = m_parent[m_parent[node]];
+		node = m_parent[node];
+	}
+	return node;
+}
+
+void Tracker::assign(const uint32_t* tracks, size_t trackCount, const uint32_t* plots, size_t plotCount)
+{
+	// Hungarian method with potentials on trackCount rows and plotCount + trackCount columns,
+	// the last ones being "no plot" at the cost of the gate.  Indices start at 1, column 0
+	// holds the row being added.
+	const size_t n = trackCount;
+	const size_t m = plotCount + trackCount;
+	const size_t plotsPerTrack = m_parameters.maxDetections;
+	const double missCost = (double)m_parameters.gate * m_parameters.gate;
+	auto cost = [&](size_t row, size_t column)
+	{
+		if (column > plotCount) return missCost;
+		return (double)m_distance[tracks[row - 1] * plotsPerTrack + plots[column - 1]];
+	};
+
+	std::fill(m_u.begin(), m_u.begin() + n + 1, 0.0);
+	std::fill(m_v.begin(), m_v.begin() + m + 1, 0.0);
+	std::fill(m_match.begin(), m_match.begin() + m + 1, 0u);
+	for (size_t row = 1; row <= n; row++)
+	{
+		m_match[0] = (uint32_t)row;
+		size_t column = 0;
+		std::fill(m_minimum.begin(), m_minimum.begin() + m + 1, 1e300);
+		std::fill(m_visited.begin(), m_visited.begin() + m + 1, (uint8_t)0);
+		do
+		{
+			m_visited[column] = 1;
+			size_t current = m_match[column];
+			double delta = 1e300;
+			size_t next = 0;
+			for (size_t j = 1; j <= m; j++)
+			{
+				if (m_visited[j]) continue;
+				double reduced = cost(current, j) - m_u[current] - m_v[j];
+				if (reduced < m_minimum[j]) { m_minimum[j] = reduced; m_way[j] = (uint32_t)column; }
+				if (m_minimum[j] < delta) { delta = m_minimum[j]; next = j; }
+			}
+			for (size_t j = 0; j <= m; j++)
+			{
+				if (m_visited[j]) { m_u[m_match[j]] += delta; m_v[j] -= delta; }
+				else m_minimum[j] -= delta;
+			}
+			column = next;
+		} while (m_match[column] != 0);
+		do
+		{
+			size_t previous = m_way[column];
+			m_match[column] = m_match[previous];
+			column = previous;
+		} while (column);
+	}
+
+	for (size_t j = 1; j <= plotCount; j++)
+	{
+		if (!m_match[j]) continue;
+		uint32_t track = tracks[m_match[j] - 1];
+		if (m_distance[track * plotsPerTrack + plots[j - 1]] >= outsideGate) continue;
+		m_trackPlot[track] = (int32_t)plots[j - 1];
+		m_plotUsed[plots[j - 1]] = 1;
+	}
+}
+
+// ================================================================================================================================================================================ //
+//  Update.                                                                                                                                                                         //
+// ================================================================================================================================================================================ //
+
+void Tracker::update(std::span<const Detection> detections, double time, size_t dopplerBins)
+{
+	const bool doppler = dopplerBins && m_parameters.velocityBin != 0;
+	m_statistics.updates++;
+	m_statistics.detections += detections.size();
+
+	// ----------- //
+	//  P L O T S  //
+	// ----------- //
+
+	// The strongest detections when there are too many, kept in a heap of the weakest on top.
+	auto makePlot = [&](const Detection& detection)
+	{
+		Plot plot;
+		plot.range = m_parameters.rangeOffset + detection.rangePosition * m_parameters.rangeBin;
+		plot.velocity = doppler ? (detection.dopplerPosition - (float)(dopplerBins / 2)) * m_parameters.velocityBin : 0.f;
+		plot.snr = detection.snr;
+		return plot;
+	};
+	size_t plotCount = std::min(detections.size(), m_parameters.maxDetections);
+	if (detections.size() > m_parameters.maxDetections)
+	{
+		m_strongest.clear();
+		auto weaker = std::greater<std::pair<float, uint32_t>>();
+		for (size_t d = 0; d < detections.size(); d++)
+		{
+			std::pair<float, uint32_t> entry(detections[d].snr, (uint32_t)d);
+			if (m_strongest.size() < plotCount) { m_strongest.push_back(entry); std::push_heap(m_strongest.begin(), m_strongest.end(), weaker); }
+			else if (entry.first > m_strongest.front().first)
+			{
+				std::pop_heap(m_strongest.begin(), m_strongest.end(), weaker);
+				m_strongest.back() = entry;
+				std::push_heap(m_strongest.begin(), m_strongest.end(), weaker);
+			}
+		}
+		for (size_t p = 0; p < plotCount; p++) m_plots[p] = makePlot(detections[m_strongest[p].second]);
+		m_statistics.detectionsDropped += detections.size() - plotCount;
+	}
+	else for (size_t p = 0; p < plotCount; p++) m_plots[p] = makePlot(detections[p]);
+
+	// ------------- //
+	//  G A T I N G  //
+	// ------------- //
+
+	const size_t trackCount = m_tracks.size();
+	const size_t plotsPerTrack = m_parameters.maxDetections;
+	const float gate = m_parameters.gate * m_parameters.gate;
+	for (size_t node = 0; node < trackCount + plotCount; node++) m_parent[node] = (uint32_t)node;
+	for (size_t t = 0; t < trackCount; t++)
+	{
+		Track& track = m_tracks[t];
+		predict(track, time);
+		m_trackPlot[t] = -1;
+		float S[3];
+		innovation(track, doppler, S);
+		float reach = m_parameters.gate * std::sqrt(S[0]);
+		for (size_t p = 0; p < plotCount; p++)
+		{
+			float& d = m_distance[t * plotsPerTrack + p];
+			d = outsideGate;
+			if (std::abs(m_plots[p].range - track.range) > reach) continue;
+			float normalised = distance(track, m_plots[p], doppler);
+			if (normalised > gate) continue;
+			d = normalised;
+			uint32_t a = find((uint32_t)t), b = find((uint32_t)(trackCount + p));
+			if (a != b) m_parent[a] = b;
+		}
+	}
+	std::fill(m_plotUsed.begin(), m_plotUsed.begin() + plotCount, (uint8_t)0);
+
+	// ----------------------- //
+	//  A S S O C I A T I O N  //
+	// ----------------------- //
+
+	// Tracks and plots in order of their cluster, a counting sort on the root, so the tracks of
+	// a cluster come before its plots.
+	const size_t nodes = trackCount + plotCount;
+	std::fill(m_clusterStart.begin(), m_clusterStart.begin() + nodes + 1, 0u);
+	for (size_t node = 0; node < nodes; node++) m_parent[node] = find((uint32_t)node);
+	for (size_t node = 0; node < nodes; node++) m_clusterStart[m_parent[node] + 1]++;
+	for (size_t root = 0; root < nodes; root++) m_clusterStart[root + 1] += m_clusterStart[root];
+	for (size_t node = 0; node < nodes; node++) m_order[m_clusterStart[m_parent[node]]++] = (uint32_t)node;
+	for (size_t root = nodes; root > 0; root--) m_clusterStart[root] = m_clusterStart[root - 1];
+	m_clusterStart[0] = 0;
+
+	for (size_t root = 0; root < nodes; root++)
+	{
+		uint32_t* cluster = m_order.data() + m_clusterStart[root];
+		size_t size = m_clusterStart[root + 1] - m_clusterStart[root];
+		size_t tracks = 0;
+		while (tracks < size && cluster[tracks] < trackCount) tracks++;
+		if (!tracks || tracks == size) continue;
+		for (size_t k = tracks; k < size; k++) cluster[k] -= (uint32_t)trackCount;
+		assign(cluster, tracks, cluster + tracks, size - tracks);
+	}
+
+	// --------------------- //
+	//  M A N A G E M E N T  //
+	// --------------------- //
+
+	const uint32_t window = (m_parameters.confirmUpdates >= 32) ? 0xffffffffu : (1u << m_parameters.confirmUpdates) - 1;
+	size_t kept = 0;
+	for (size_t t = 0; t < trackCount; t++)
+	{
+		Track& track = m_tracks[t];
+		track.hit = m_trackPlot[t] >= 0;
+		if (track.hit) correct(track, m_plots[m_trackPlot[t]], doppler);
+		track.history = (track.history << 1) | (track.hit ? 1u : 0u);
+		track.updates++;
+		track.hits += track.hit;
+		track.misses = track.hit ? 0 : track.misses + 1;
+
+		bool drop = false;
+		if (track.status == TrackStatus::Tentative)
+		{
+			// Confirmed on M hits in the first N updates, dropped once they are out of reach.
+			unsigned hits = 0;
+			for (uint32_t bits = track.history & window; bits; bits &= bits - 1) hits++;
+			if (hits >= m_parameters.confirmHits && track.updates <= m_parameters.confirmUpdates)
+			{
+				track.status = TrackStatus::Confirmed;
+				m_statistics.tracksConfirmed++;
+			}
+			else drop = track.updates >= m_parameters.confirmUpdates || hits + (m_parameters.confirmUpdates - track.updates) < m_parameters.confirmHits;
+		}
+		else drop = track.misses >= m_parameters.maxMisses;
+
+		if (drop) m_statistics.tracksDropped++;
+		else m_tracks[kept++] = track;
+	}
+	m_tracks.resize(kept);
+
+	// Plots that no track took start tentative tracks.
+	for (size_t p = 0; p < plotCount; p++)
+		if (!m_plotUsed[p]) start(m_plots[p], time, doppler);
+}
+
+size_t Tracker::confirmedTracks() const
+{
+	return (size_t)std::count_if(m_tracks.begin(), m_tracks.end(), [](const Track& track) { return track.status == TrackStatus::Confirmed; });
+}
+
+std::string Tracker::describe() const
+{
+	std::ostringstream description;
+	description << m_parameters.filter << ", " << m_tracks.size() << " tracks (" << confirmedTracks() << " confirmed), "
+				<< m_statistics.tracksStarted << " started, " << m_statistics.tracksDropped << " dropped";
+	return description.str();
+}
+
+// ================================================================================================================================================================================ //
+//  Output.                                                                                                                                                                         //
+// ================================================================================================================================================================================ //
+
+TrackWriter::TrackWriter(const std::string& file)
+	: m_file(file, std::ofstream::binary)
+{
+	m_open = (bool)m_file;
+	if (m_open) m_file.write("B210TRK1", 8);
+}
+
+void TrackWriter::write(const Tracker& tracker)
+{
+	if (!m_open) return;
+	for (const Track& track : tracker.tracks())
+	{
+		if (track.status != TrackStatus::Confirmed) continue;
+		char record[36];
+		uint8_t status = (uint8_t)track.status;
+		uint8_t hit = track.hit;
+		uint16_t hits = (uint16_t)std::min(track.hits, 65535u);
+		float values[5] = { track.range, track.velocity, std::sqrt(std::max(0.f, track.covariance[0])), std::sqrt(std::max(0.f, track.covariance[2])), track.snr };
+		std::memcpy(record, &track.time, 8);
+		std::memcpy(record + 8, &track.id, 4);
+		std::memcpy(record + 12, &status, 1);
+		std::memcpy(record + 13, &hit, 1);
+		std::memcpy(record + 14, &hits, 2);
+		std::memcpy(record + 16, values, 20);
+		m_file.write(record, sizeof(record));
+		m_records++;
+	}
+}
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
@@ -0,0 +1,176 @@
+#pragma once
+
+/*
+* Tracking of CFAR detections from one CPI to the next.  Detections become plots of range, and
+* of range rate when they come from a range-Doppler map, and are gated against the prediction
+* of every track.  They are assigned by global nearest neighbour: the assignment with the least
+* total normalised distance, solved on every cluster of tracks and plots that share gates.
+* The tracks are filtered by a fixed gain alpha-beta filter or a constant velocity Kalman
+* filter, confirmed after M hits in N updates and dropped after a number of misses.  Every
+* buffer is allocated up front for the most tracks and detections, so an update never allocates.
+*/
+
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include <vector>
+#include <span>
+#include <string>
+#include <fstream>
+#include <cstdint>
+#include <utility>
+#include "CFAR.h"
+
+// ================================================================================================================================================================================ //
+//  Types.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+struct TrackerParameters
+{
+	std::string filter = "Kalman";		// "Kalman" (constant velocity) or "Alpha-beta".
+	float rangeBin = 0;					// Range per range bin [m], see rangeBinMetres().
+	float rangeOffset = 0;				// Range of bin 0 [m], e.g. the start of the range gate.
+	float velocityBin = 0;				// Range rate per Doppler bin [m/s], see velocityBinMetres().  0 tracks range only.
+	float rangeNoise = 5;				// Standard deviation of a measured range [m].
+	float velocityNoise = 1;			// Standard deviation of a measured range rate [m/s].
+	float accelerationNoise = 2;		// Kalman: standard deviation of the white acceleration of a target [m/s^2].
+	float alpha = 0.5f;					// Alpha-beta: gain of the range residual on the range.
+	float beta = 0.2f;					// Alpha-beta: gain of the range residual on the range rate.
+	float maxSpeed = 100;				// Largest range rate of a new track that has no Doppler [m/s].
+	float gate = 3.5f;					// Largest normalised distance of a plot to a track [standard deviations].
+	unsigned confirmHits = 3;			// A track is confirmed after confirmHits hits in its first confirmUpdates
+	unsigned confirmUpdates = 5;		// updates, and dropped as soon as it cannot get there.
+	unsigned maxMisses = 3;				// A confirmed track is dropped after this many misses in a row.
+	size_t maxTracks = 256;
+	size_t maxDetections = 1024;		// Detections used per update, the ones with the highest SNR are kept.
+};
+
+enum class TrackStatus : uint8_t
+{
+	Tentative,
+	Confirmed
+};
+
+struct Track
+{
+	uint32_t id = 0;
+	TrackStatus status = TrackStatus::Tentative;
+	double time = 0;					// Time of the state [s].
+	float range = 0;					// [m]
+	float velocity = 0;					// Range rate [m/s], positive when the target moves away.
+	float covariance[3] = {};			// Of range and range rate: rr, rv and vv.
+	float snr = 0;						// Of the last plot [dB].
+	float interval = 0;					// Time since the previous update [s].
+	uint32_t history = 0;				// One bit per update, set for a hit, the last update in bit 0.
+	unsigned updates = 0;
+	unsigned hits = 0;
+	unsigned misses = 0;				// Misses in a row.
+	bool hit = false;					// Whether the last update had a plot.
+};
+
+struct TrackerStatistics
+{
+	size_t updates = 0;
+	size_t detections = 0;
+	size_t detectionsDropped = 0;		// Over maxDetections.
+	size_t tracksStarted = 0;
+	size_t tracksConfirmed = 0;
+	size_t tracksDropped = 0;
+	size_t tracksRefused = 0;			// New tracks over maxTracks.
+};
+
+// ================================================================================================================================================================================ //
+//  Tracker.                                                                                                                                                                        //
+// ================================================================================================================================================================================ //
+
+class Tracker
+{
+public:
+
+	explicit Tracker(const TrackerParameters& parameters = TrackerParameters());
+
+	// Predict every track to the time of the CPI [s], assign it the detections and start tracks
+	// on the ones left over.  dopplerBins is that of the map, 0 for detections along range.
+	void update(std::span<const Detection> detections, double time, size_t dopplerBins = 0);
+
+	// Tentative and confirmed tracks.
+	std::span<const Track> tracks() const { return m_tracks; }
+	size_t confirmedTracks() const;
+	const TrackerStatistics& statistics() const { return m_statistics; }
+	// E.g. "Kalman, 12 tracks (9 confirmed), 40 started, 28 dropped".
+	std::string describe() const;
+
+private:
+
+	struct Plot
+	{
+		float range;
+		float velocity;
+		float snr;
+	};
+
+	TrackerParameters m_parameters;
+	bool m_kalman;
+	uint32_t m_nextId = 1;
+	TrackerStatistics m_statistics;
+
+	// Sized once, for maxTracks and maxDetections.
+	std::vector<Track> m_tracks;
+	std::vector<Plot> m_plots;
+	std::vector<std::pair<float, uint32_t>> m_strongest;	// Heap of the strongest detections.
+	std::vector<float> m_distance;							// Normalised distance squared, track by plot.
+	std::vector<uint32_t> m_parent;							// Union find of tracks and plots.
+	std::vector<uint32_t> m_order;							// Tracks and plots sorted by cluster.
+	std::vector<uint32_t> m_clusterStart;
+	std::vector<int32_t> m_trackPlot;						// Plot of every track, -1 for none.
+	std::vector<uint8_t> m_plotUsed;
+	std::vector<double> m_u, m_v, m_minimum;				// Assignment potentials and scratch.
+	std::vector<uint32_t> m_match, m_way;
+	std::vector<uint8_t> m_visited;
+
+	void predict(Track& track, double time) const;
+	// Innovation covariance rr, rv and vv of a track and the normalised distance squared to a plot.
+	void innovation(const Track& track, bool doppler, float S[3]) const;
+	float distance(const Track& track, const Plot& plot, bool doppler) const;
+	void correct(Track& track, const Plot& plot, bool doppler) const;
+	void start(const Plot& plot, double time, bool doppler);
+
+	uint32_t find(uint32_t node);
+	// Least cost assignment of the cluster's tracks to its plots, or to no plot at gate^2.
+	void assign(const uint32_t* tracks, size_t trackCount, const uint32_t* plots, size_t plotCount);
+};
+
+// Range per range bin [m] for the sampling frequency.
+float rangeBinMetres(double samplingFreq);
+// Range rate per Doppler bin [m/s], for the carrier and the PRF [Hz].  Negative, since an
+// approaching target has a positive Doppler shift.
+float velocityBinMetres(double carrierFreq, double prf, size_t dopplerBins);
+
+// ================================================================================================================================================================================ //
+//  Output.                                                                                                                                                                         //
+// ================================================================================================================================================================================ //
+
+// Writes the confirmed tracks after every update to a binary file, one 36 byte record per track:
+// time (f64), id (u32), status (u8), hit (u8), hits (u16), range, range rate, their standard
+// deviations and the SNR (f32).  The file starts with the 8 byte magic "B210TRK1".
+class TrackWriter
+{
+public:
+
+	explicit TrackWriter(const std::string& file);
+
+	bool isOpen() const { return m_open; }
+	void write(const Tracker& tracker);
+	size_t records() const { return m_records; }
+
+private:
+
+	std::ofstream m_file;
+	bool m_open = false;
+	size_t m_records = 0;
+};
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
@@ -0,0 +1,92 @@
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include "Transpose.h"
+#include "Executor.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+// ================================================================================================================================================================================ //
+//  Tiles.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+namespace
+{
+	using Sample = std::complex<float>;
+
+	void copyTile(const Sample* input, size_t inputStride, Sample* output, size_t outputStride, size_t rows, size_t columns)
+	{
+		// Every output line of the tile is written in one run, the input lines it reads from stay
+		// in the L1 cache across the columns.
+		for (size_t c = 0; c < columns; c++)
+		{
+			Sample* out = output + c * outputStride;
+			const Sample* in = input + c;
+			for (size_t r = 0; r < rows; r++) out[r] = in[r * inputStride];
+		}
+	}
+
+	// Swap tile (row, column) with its mirror, or transpose it in place on the diagonal.
+	void swapTiles(Sample* data, size_t stride, size_t row, size_t column, size_t rows, size_t columns)
+	{
+		for (size_t r = 0; r < rows; r++)
+		{
+			size_t first = (row == column) ? r + 1 : 0;
+			Sample* line = data + (row + r) * stride + column;
+			for (size_t c = first; c < columns; c++) std::swap(line[c], data[(column + c) * stride + row + r]);
+		}
+	}
+}
+
+// ================================================================================================================================================================================ //
+//  Transpose.                                                                                                                                                                      //
+// ================================================================================================================================================================================ //
+
+void transpose(const std::complex<float>* input, size_t rows, size_t columns, size_t inputStride, std::complex<float>* output, size_t outputStride, unsigned threads)
+{
+	if (!rows || !columns) return;
+
+	// Tiles in row order, so a chunk of tiles reads whole bands of the input.
+	const size_t rowTiles = (rows + transposeTile - 1) / transposeTile;
+	const size_t columnTiles = (columns + transposeTile - 1) / transposeTile;
+	Executor& executor = Executor::shared();
+	size_t grain = executor.grainFor(2 * transposeTile * transposeTile * sizeof(Sample));
+	executor.parallelFor("Transpose", rowTiles * columnTiles, grain, [&](size_t first, size_t last, unsigned)
+	{
+		for (size_t tile = first; tile < last; tile++)
+		{
+			size_t r = (tile / columnTiles) * transposeTile;
+			size_t c = (tile % columnTiles) * transposeTile;
+			copyTile(input + r * inputStride + c, inputStride, output + c * outputStride + r, outputStride, std::min(transposeTile, rows - r), std::min(transposeTile, columns - c));
+		}
+	}, threads);
+}
+
+void transposeSquare(std::complex<float>* data, size_t n, size_t stride, unsigned threads)
+{
+	if (n < 2) return;
+
+	// Pairs of tiles on and above the diagonal, numbered row by row.
+	const size_t tiles = (n + transposeTile - 1) / transposeTile;
+	std::vector<std::pair<size_t, size_t>> pairs;
+	pairs.reserve(tiles * (tiles + 1) / 2);
+	for (size_t row = 0; row < tiles; row++)
+		for (size_t column = row; column < tiles; column++) pairs.emplace_back(row * transposeTile, column * transposeTile);
+
+	Executor& executor = Executor::shared();
+	size_t grain = executor.grainFor(2 * transposeTile * transposeTile * sizeof(Sample));
+	executor.parallelFor("Transpose (in place)", pairs.size(), grain, [&](size_t first, size_t last, unsigned)
+	{
+		for (size_t pair = first; pair < last; pair++)
+		{
+			auto [row, column] = pairs[pair];
+			swapTiles(data, stride, row, column, std::min(transposeTile, n - row), std::min(transposeTile, n - column));
+		}
+	}, threads);
+}
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
@@ -0,0 +1,34 @@
+#pragma once
+
+/*
+* Transpose of complex matrices between fast time and slow time order.  A plain loop writes
+* every output sample to another line, so every write misses the cache.  The kernels copy
+* square tiles instead, small enough that the input and output lines of a tile stay in the L1
+* cache, and hand the tiles to the executor.  Square matrices can be transposed in place.
+*/
+
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include <complex>
+
+// ================================================================================================================================================================================ //
+//  Transpose.                                                                                                                                                                      //
+// ================================================================================================================================================================================ //
+
+// Samples along either side of a tile, 32 x 32 samples is 8 kB of input and 8 kB of output.
+const size_t transposeTile = 32;
+
+// output[c * outputStride + r] = input[r * inputStride + c] for rows x columns samples.  The
+// strides are in samples and the matrices may not overlap.  threads caps the executor threads
+// used, 0 uses all of them.
+void transpose(const std::complex<float>* input, size_t rows, size_t columns, size_t inputStride, std::complex<float>* output, size_t outputStride, unsigned threads = 0);
+
+// Transpose the n x n matrix in place.  The tiles above the diagonal are swapped with the ones
+// below it, every pair by one thread.
+void transposeSquare(std::complex<float>* data, size_t n, size_t stride, unsigned threads = 0);
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
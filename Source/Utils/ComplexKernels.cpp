@@ -0,0 +1,560 @@
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include "ComplexKernels.h"
+#include <cmath>
+#include <atomic>
+#include <algorithm>
+#include <stdexcept>
+#if defined(_M_X64) || defined(__x86_64__)
+#define COMPLEX_KERNELS_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define SIMD_TARGET(features)
+#else
+#include <cpuid.h>
+#define SIMD_TARGET(features) __attribute__((target(features)))
+#endif
+#endif
+
+// ================================================================================================================================================================================ //
+//  Scalar.                                                                                                                                                                         //
+// ================================================================================================================================================================================ //
+
+namespace
+{
+	using Complex = std::complex<float>;
+
+	// The products are written out, std::complex multiplication handles infinities and NaN
+	// and is not inlined by every compiler.  These also finish the vectors of the other levels.
+	namespace scalar
+	{
+		void multiply(const Complex* a, const Complex* b, Complex* output, size_t n)
+		{
+			for (size_t k = 0; k < n; k++)
+			{
+				float ar = a[k].real(), ai = a[k].imag(), br = b[k].real(), bi = b[k].imag();
+				output[k] = Complex(ar * br - ai * bi, ar * bi + ai * br);
+			}
+		}
+
+		void conjugateMultiply(const Complex* a, const Complex* b, Complex* output, size_t n)
+		{
+			for (size_t k = 0; k < n; k++)
+			{
+				float ar = a[k].real(), ai = a[k].imag(), br = b[k].real(), bi = b[k].imag();
+				output[k] = Complex(ar * br + ai * bi, ai * br - ar * bi);
+			}
+		}
+
+		void multiplyAccumulate(const Complex* a, const Complex* b, Complex* accumulator, size_t n)
+		{
+			for (size_t k = 0; k < n; k++)
+			{
+				float ar = a[k].real(), ai = a[k].imag(), br = b[k].real(), bi = b[k].imag();
+				accumulator[k] = Complex(accumulator[k].real() + (ar * br - ai * bi), accumulator[k].imag() + (ar * bi + ai * br));
+			}
+		}
+
+		void magnitudeSquared(const Complex* a, float* output, size_t n)
+		{
+			for (size_t k = 0; k < n; k++) output[k] = a[k].real() * a[k].real() + a[k].imag() * a[k].imag();
+		}
+
+		void magnitude(const Complex* a, float* output, size_t n)
+		{
+			for (size_t k = 0; k < n; k++) output[k] = std::sqrt(a[k].real() * a[k].real() + a[k].imag() * a[k].imag());
+		}
+
+		double powerSum(const Complex* a, size_t n)
+		{
+			double sum = 0;
+			for (size_t k = 0; k < n; k++) sum += (double)a[k].real() * a[k].real() + (double)a[k].imag() * a[k].imag();
+			return sum;
+		}
+
+		void scale(const Complex* a, float factor, Complex* output, size_t n)
+		{
+			for (size_t k = 0; k < n; k++) output[k] = Complex(a[k].real() * factor, a[k].imag() * factor);
+		}
+	}
+}
+
+// ================================================================================================================================================================================ //
+//  SSE2.                                                                                                                                                                           //
+// ================================================================================================================================================================================ //
+
+#ifdef COMPLEX_KERNELS_X86
+namespace
+{
+	// Two complex samples per vector.  SSE2 is part of x64, so these need no target.
+	namespace sse2
+	{
+		// a b, the real parts of b times a, plus the imaginary parts times a swapped, with the
+		// sign of the real lanes flipped.
+		inline __m128 product(__m128 a, __m128 b)
+		{
+			__m128 real = _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 2, 0, 0));
+			__m128 imag = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 3, 1, 1));
+			__m128 swapped = _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1));
+			return _mm_add_ps(_mm_mul_ps(a, real), _mm_xor_ps(_mm_mul_ps(swapped, imag), _mm_setr_ps(-0.f, 0.f, -0.f, 0.f)));
+		}
+
+		// a conj(b), the same with the sign of the imaginary lanes flipped.
+		inline __m128 conjugateProduct(__m128 a, __m128 b)
+		{
+			__m128 real = _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 2, 0, 0));
+			__m128 imag = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 3, 1, 1));
+			__m128 swapped = _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1));
+			return _mm_add_ps(_mm_mul_ps(a, real), _mm_xor_ps(_mm_mul_ps(swapped, imag), _mm_setr_ps(0.f, -0.f, 0.f, -0.f)));
+		}
+
+		// |a|^2 of four samples.
+		inline __m128 power(const float* a)
+		{
+			__m128 low = _mm_loadu_ps(a);
+			__m128 high = _mm_loadu_ps(a + 4);
+			low = _mm_mul_ps(low, low);
+			high = _mm_mul_ps(high, high);
+			return _mm_add_ps(_mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1)));
+		}
+
+		void multiply(const Complex* a, const Complex* b, Complex* output, size_t n)
+		{
+			size_t k = 0;
+			for (; k + 2 <= n; k += 2) _mm_storeu_ps((float*)(output + k), product(_mm_loadu_ps((const float*)(a + k)), _mm_loadu_ps((const float*)(b + k))));
+			scalar::multiply(a + k, b + k, output + k, n - k);
+		}
+
+		void conjugateMultiply(const Complex* a, const Complex* b, Complex* output, size_t n)
+		{
+			size_t k = 0;
+			for (; k + 2 <= n; k += 2) _mm_storeu_ps((float*)(output + k), conjugateProduct(_mm_loadu_ps((const float*)(a + k)), _mm_loadu_ps((const float*)(b + k))));
+			scalar::conjugateMultiply(a + k, b + k, output + k, n - k);
+		}
+
+		void multiplyAccumulate(const Complex* a, const Complex* b, Complex* accumulator, size_t n)
+		{
+			size_t k = 0;
+			for (; k + 2 <= n; k += 2)
+			{
+				__m128 sum = _mm_add_ps(_mm_loadu_ps((const float*)(accumulator + k)), product(_mm_loadu_ps((const float*)(a + k)), _mm_loadu_ps((const float*)(b + k))));
+				_mm_storeu_ps((float*)(accumulator + k), sum);
+			}
+			scalar::multiplyAccumulate(a + k, b + k, accumulator + k, n - k);
+		}
+
+		void magnitudeSquared(const Complex* a, float* output, size_t n)
+		{
+			size_t k = 0;
+			for (; k + 4 <= n; k += 4) _mm_storeu_ps(output + k, power((const float*)(a + k)));
+			scalar::magnitudeSquared(a + k, output + k, n - k);
+		}
+
+		void magnitude(const Complex* a, float* output, size_t n)
+		{
+			size_t k = 0;
+			for (; k + 4 <= n; k += 4) _mm_storeu_ps(output + k, _mm_sqrt_ps(power((const float*)(a + k))));
+			scalar::magnitude(a + k, output + k, n - k);
+		}
+
+		double powerSum(const Complex* a, size_t n)
+		{
+			// Squared and summed in double, as the scalar version does.
+			__m128d low = _mm_setzero_pd();
+			__m128d high = _mm_setzero_pd();
+			size_t k = 0;
+			for (; k + 2 <= n; k += 2)
+			{
+				__m128 samples = _mm_loadu_ps((const float*)(a + k));
+				__m128d first = _mm_cvtps_pd(samples);
+				__m128d second = _mm_cvtps_pd(_mm_movehl_ps(samples, samples));
+				low = _mm_add_pd(low, _mm_mul_pd(first, first));
+				high = _mm_add_pd(high, _mm_mul_pd(second, second));
+			}
+			double lanes[2];
+			_mm_storeu_pd(lanes, _mm_add_pd(low, high));
+			return lanes[0] + lanes[1] + scalar::powerSum(a + k, n - k);
+		}
+
+		void scale(const Complex* a, float factor, Complex* output, size_t n)
+		{
+			__m128 factors = _mm_set1_ps(factor);
+			size_t k = 0;
+			for (; k + 2 <= n; k += 2) _mm_storeu_ps((float*)(output + k), _mm_mul_ps(_mm_loadu_ps((const float*)(a + k)), factors));
+			scalar::scale(a + k, factor, output + k, n - k);
+		}
+	}
+}
+
+// ================================================================================================================================================================================ //
+//  AVX2.                                                                                                                                                                           //
+// ================================================================================================================================================================================ //
+
+namespace
+{
+	// Four complex samples per vector, with FMA.
+	namespace avx2
+	{
+		// fmaddsub subtracts in the real lanes and adds in the imaginary ones.
+		SIMD_TARGET("avx2,fma") inline __m256 product(__m256 a, __m256 b)
+		{
+			__m256 swapped = _mm256_permute_ps(a, _MM_SHUFFLE(2, 3, 0, 1));
+			return _mm256_fmaddsub_ps(a, _mm256_moveldup_ps(b), _mm256_mul_ps(swapped, _mm256_movehdup_ps(b)));
+		}
+
+		SIMD_TARGET("avx2,fma") inline __m256 conjugateProduct(__m256 a, __m256 b)
+		{
+			__m256 swapped = _mm256_permute_ps(a, _MM_SHUFFLE(2, 3, 0, 1));
+			return _mm256_fmsubadd_ps(a, _mm256_moveldup_ps(b), _mm256_mul_ps(swapped, _mm256_movehdup_ps(b)));
+		}
+
+		// |a|^2 of eight samples.  The shuffles work within the 128 bit halves, so the pairs of
+		// results are put back in order afterwards.
+		SIMD_TARGET("avx2,fma") inline __m256 power(const float* a)
+		{
+			__m256 low = _mm256_loadu_ps(a);
+			__m256 high = _mm256_loadu_ps(a + 8);
+			low = _mm256_mul_ps(low, low);
+			high = _mm256_mul_ps(high, high);
+			__m256 sum = _mm256_add_ps(_mm256_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0)), _mm256_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1)));
+			return _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(sum), _MM_SHUFFLE(3, 1, 2, 0)));
+		}
+
+		SIMD_TARGET("avx2,fma") void multiply(const Complex* a, const Complex* b, Complex* output, size_t n)
+		{
+			size_t k = 0;
+			for (; k + 4 <= n; k += 4) _mm256_storeu_ps((float*)(output + k), product(_mm256_loadu_ps((const float*)(a + k)), _mm256_loadu_ps((const float*)(b + k))));
+			scalar::multiply(a + k, b + k, output + k, n - k);
+		}
+
+		SIMD_TARGET("avx2,fma") void conjugateMultiply(const Complex* a, const Complex* b, Complex* output, size_t n)
+		{
+			size_t k = 0;
+			for (; k + 4 <= n; k += 4) _mm256_storeu_ps((float*)(output + k), conjugateProduct(_mm256_loadu_ps((const float*)(a + k)), _mm256_loadu_ps((const float*)(b + k))));
+			scalar::conjugateMultiply(a + k, b + k, output + k, n - k);
+		}
+
+		SIMD_TARGET("avx2,fma") void multiplyAccumulate(const Complex* a, const Complex* b, Complex* accumulator, size_t n)
+		{
+			size_t k = 0;
+			for (; k + 4 <= n; k += 4)
+			{
+				__m256 sum = _mm256_add_ps(_mm256_loadu_ps((const float*)(accumulator + k)), product(_mm256_loadu_ps((const float*)(a + k)), _mm256_loadu_ps((const float*)(b + k))));
+				_mm256_storeu_ps((float*)(accumulator + k), sum);
+			}
+			scalar::multiplyAccumulate(a + k, b + k, accumulator + k, n - k);
+		}
+
+		SIMD_TARGET("avx2,fma") void magnitudeSquared(const Complex* a, float* output, size_t n)
+		{
+			size_t k = 0;
+			for (; k + 8 <= n; k += 8) _mm256_storeu_ps(output + k, power((const float*)(a + k)));
+			scalar::magnitudeSquared(a + k, output + k, n - k);
+		}
+
+		SIMD_TARGET("avx2,fma") void magnitude(const Complex* a, float* output, size_t n)
+		{
+			size_t k = 0;
+			for (; k + 8 <= n; k += 8) _mm256_storeu_ps(output + k, _mm256_sqrt_ps(power((const float*)(a + k))));
+			scalar::magnitude(a + k, output + k, n - k);
+		}
+
+		SIMD_TARGET("avx2,fma") double powerSum(const Complex* a, size_t n)
+		{
+			__m256d low = _mm256_setzero_pd();
+			__m256d high = _mm256_setzero_pd();
+			size_t k = 0;
+			for (; k + 4 <= n; k += 4)
+			{
+				__m256 samples = _mm256_loadu_ps((const float*)(a + k));
+				__m256d first = _mm256_cvtps_pd(_mm256_castps256_ps128(samples));
+				__m256d second = _mm256_cvtps_pd(_mm256_extractf128_ps(samples, 1));
+				low = _mm256_fmadd_pd(first, first, low);
+				high = _mm256_fmadd_pd(second, second, high);
+			}
+			double lanes[4];
+			_mm256_storeu_pd(lanes, _mm256_add_pd(low, high));
+			return lanes[0] + lanes[1] + lanes[2] + lanes[3] + scalar::powerSum(a + k, n - k);
+		}
+
+		SIMD_TARGET("avx2,fma") void scale(const Complex* a, float factor, Complex* output, size_t n)
+		{
+			__m256 factors = _mm256_set1_ps(factor);
+			size_t k = 0;
+			for (; k + 4 <= n; k += 4) _mm256_storeu_ps((float*)(output + k), _mm256_mul_ps(_mm256_loadu_ps((const float*)(a + k)), factors));
+			scalar::scale(a + k, factor, output + k, n - k);
+		}
+	}
+}
+
+// ================================================================================================================================================================================ //
+//  AVX-512.                                                                                                                                                                        //
+// ================================================================================================================================================================================ //
+
+namespace
+{
+	// Eight complex samples per vector, AVX-512F only.
+	namespace avx512
+	{
+		SIMD_TARGET("avx512f") inline __m512 product(__m512 a, __m512 b)
+		{
+			__m512 swapped = _mm512_permute_ps(a, _MM_SHUFFLE(2, 3, 0, 1));
+			return _mm512_fmaddsub_ps(a, _mm512_moveldup_ps(b), _mm512_mul_ps(swapped, _mm512_movehdup_ps(b)));
+		}
+
+		SIMD_TARGET("avx512f") inline __m512 conjugateProduct(__m512 a, __m512 b)
+		{
+			__m512 swapped = _mm512_permute_ps(a, _MM_SHUFFLE(2, 3, 0, 1));
+			return _mm512_fmsubadd_ps(a, _mm512_moveldup_ps(b), _mm512_mul_ps(swapped, _mm512_movehdup_ps(b)));
+		}
+
+		// |a|^2 of sixteen samples, the real and imaginary lanes picked from both vectors in order.
+		SIMD_TARGET("avx512f") inline __m512 power(const float* a)
+		{
+			const __m512i even = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+			const __m512i odd = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+			__m512 low = _mm512_loadu_ps(a);
+			__m512 high = _mm512_loadu_ps(a + 16);
+			low = _mm512_mul_ps(low, low);
+			high = _mm512_mul_ps(high, high);
+			return _mm512_add_ps(_mm512_permutex2var_ps(low, even, high), _mm512_permutex2var_ps(low, odd, high));
+		}
+
+		SIMD_TARGET("avx512f") void multiply(const Complex* a, const Complex* b, Complex* output, size_t n)
+		{
+			size_t k = 0;
+			for (; k + 8 <= n; k += 8) _mm512_storeu_ps((float*)(output + k), product(_mm512_loadu_ps((const float*)(a + k)), _mm512_loadu_ps((const float*)(b + k))));
+			scalar::multiply(a + k, b + k, output + k, n - k);
+		}
+
+		SIMD_TARGET("avx512f") void conjugateMultiply(const Complex* a, const Complex* b, Complex* output, size_t n)
+		{
+			size_t k = 0;
+			for (; k + 8 <= n; k += 8) _mm512_storeu_ps((float*)(output + k), conjugateProduct(_mm512_loadu_ps((const float*)(a + k)), _mm512_loadu_ps((const float*)(b + k))));
+			scalar::conjugateMultiply(a + k, b + k, output + k, n - k);
+		}
+
+		SIMD_TARGET("avx512f") void multiplyAccumulate(const Complex* a, const Complex* b, Complex* accumulator, size_t n)
+		{
+			size_t k = 0;
+			for (; k + 8 <= n; k += 8)
+			{
+				__m512 sum = _mm512_add_ps(_mm512_loadu_ps((const float*)(accumulator + k)), product(_mm512_loadu_ps((const float*)(a + k)), _mm512_loadu_ps((const float*)(b + k))));
+				_mm512_storeu_ps((float*)(accumulator + k), sum);
+			}
+			scalar::multiplyAccumulate(a + k, b + k, accumulator + k, n - k);
+		}
+
+		SIMD_TARGET("avx512f") void magnitudeSquared(const Complex* a, float* output, size_t n)
+		{
+			size_t k = 0;
+			for (; k + 16 <= n; k += 16) _mm512_storeu_ps(output + k, power((const float*)(a + k)));
+			scalar::magnitudeSquared(a + k, output + k, n - k);
+		}
+
+		SIMD_TARGET("avx512f") void magnitude(const Complex* a, float* output, size_t n)
+		{
+			size_t k = 0;
+			for (; k + 16 <= n; k += 16) _mm512_storeu_ps(output + k, _mm512_sqrt_ps(power((const float*)(a + k))));
+			scalar::magnitude(a + k, output + k, n - k);
+		}
+
+		SIMD_TARGET("avx512f") double powerSum(const Complex* a, size_t n)
+		{
+			__m512d low = _mm512_setzero_pd();
+			__m512d high = _mm512_setzero_pd();
+			size_t k = 0;
+			for (; k + 8 <= n; k += 8)
+			{
+				__m512 samples = _mm512_loadu_ps((const float*)(a + k));
+				__m512d first = _mm512_cvtps_pd(_mm512_castps512_ps256(samples));
+				__m512d second = _mm512_cvtps_pd(_mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(samples), 1)));
+				low = _mm512_fmadd_pd(first, first, low);
+				high = _mm512_fmadd_pd(second, second, high);
+			}
+			return _mm512_reduce_add_pd(_mm512_add_pd(low, high)) + scalar::powerSum(a + k, n - k);
+		}
+
+		SIMD_TARGET("avx512f") void scale(const Complex* a, float factor, Complex* output, size_t n)
+		{
+			__m512 factors = _mm512_set1_ps(factor);
+			size_t k = 0;
+			for (; k + 8 <= n; k += 8) _mm512_storeu_ps((float*)(output + k), _mm512_mul_ps(_mm512_loadu_ps((const float*)(a + k)), factors));
+			scalar::scale(a + k, factor, output + k, n - k);
+		}
+	}
+}
+#endif
+
+// ================================================================================================================================================================================ //
+//  Dispatch.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+namespace
+{
+#ifdef COMPLEX_KERNELS_X86
+	void cpuid(unsigned leaf, unsigned subleaf, unsigned registers[4])
+	{
+#ifdef _MSC_VER
+		int values[4];
+		__cpuidex(values, (int)leaf, (int)subleaf);
+		for (int r = 0; r < 4; r++) registers[r] = (unsigned)values[r];
+#else
+		__cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+	}
+
+	// The register state the OS saves on a context switch.
+	unsigned long long enabledState()
+	{
+#ifdef _MSC_VER
+		return _xgetbv(0);
+#else
+		unsigned low, high;
+		__asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+		return ((unsigned long long)high << 32) | low;
+#endif
+	}
+#endif
+
+	const ComplexKernels& kernelTable(SimdLevel level)
+	{
+		static const ComplexKernels tables[] =
+		{
+			{ SimdLevel::Scalar, scalar::multiply, scalar::conjugateMultiply, scalar::multiplyAccumulate, scalar::magnitude, scalar::magnitudeSquared, scalar::powerSum, scalar::scale },
+#ifdef COMPLEX_KERNELS_X86
+			{ SimdLevel::SSE2, sse2::multiply, sse2::conjugateMultiply, sse2::multiplyAccumulate, sse2::magnitude, sse2::magnitudeSquared, sse2::powerSum, sse2::scale },
+			{ SimdLevel::AVX2, avx2::multiply, avx2::conjugateMultiply, avx2::multiplyAccumulate, avx2::magnitude, avx2::magnitudeSquared, avx2::powerSum, avx2::scale },
+			{ SimdLevel::AVX512, avx512::multiply, avx512::conjugateMultiply, avx512::multiplyAccumulate, avx512::magnitude, avx512::magnitudeSquared, avx512::powerSum, avx512::scale },
+#endif
+		};
+		return tables[(size_t)level];
+	}
+
+	std::atomic<const ComplexKernels*> activeKernels{ nullptr };
+
+	void checkLength(size_t length, size_t other)
+	{
+		if (length != other) throw std::invalid_argument("The buffers of a complex kernel differ in length.");
+	}
+}
+
+std::string simdLevelName(SimdLevel level)
+{
+	switch (level)
+	{
+	case SimdLevel::SSE2:	return "SSE2";
+	case SimdLevel::AVX2:	return "AVX2";
+	case SimdLevel::AVX512:	return "AVX-512";
+	default:				return "Scalar";
+	}
+}
+
+SimdLevel detectSimdLevel()
+{
+#ifdef COMPLEX_KERNELS_X86
+	static const SimdLevel detected = []()
+	{
+		unsigned registers[4];
+		cpuid(0, 0, registers);
+		unsigned maxLeaf = registers[0];
+		cpuid(1, 0, registers);
+		bool osxsave = (registers[2] >> 27) & 1;
+		bool avx = (registers[2] >> 28) & 1;
+		bool fma = (registers[2] >> 12) & 1;
+		unsigned long long state = osxsave ? enabledState() : 0;
+		bool avxState = (state & 0x6) == 0x6;			// SSE and AVX registers.
+		bool avx512State = (state & 0xe6) == 0xe6;		// And the opmask and upper ZMM registers.
+		bool avx2 = false;
+		bool avx512f = false;
+		if (maxLeaf >= 7)
+		{
+			cpuid(7, 0, registers);
+			avx2 = (registers[1] >> 5) & 1;
+			avx512f = (registers[1] >> 16) & 1;
+		}
+		if (avx && avxState && fma && avx2 && avx512f && avx512State) return SimdLevel::AVX512;
+		if (avx && avxState && fma && avx2) return SimdLevel::AVX2;
+		return SimdLevel::SSE2;
+	}();
+	return detected;
+#else
+	return SimdLevel::Scalar;
+#endif
+}
+
+const ComplexKernels& complexKernels()
+{
+	const ComplexKernels* kernels = activeKernels.load(std::memory_order_acquire);
+	if (kernels) return *kernels;
+	kernels = &kernelTable(detectSimdLevel());
+	activeKernels.store(kernels, std::memory_order_release);
+	return *kernels;
+}
+
+const ComplexKernels* complexKernels(SimdLevel level)
+{
+	return (level <= detectSimdLevel()) ? &kernelTable(level) : nullptr;
+}
+
+SimdLevel limitSimdLevel(SimdLevel maximum)
+{
+	SimdLevel level = std::min(maximum, detectSimdLevel());
+	activeKernels.store(&kernelTable(level), std::memory_order_release);
+	return level;
+}
+
+// ================================================================================================================================================================================ //
+//  Spans.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+void complexMultiply(std::span<const std::complex<float>> a, std::span<const std::complex<float>> b, std::span<std::complex<float>> output)
+{
+	checkLength(a.size(), b.size());
+	checkLength(a.size(), output.size());
+	complexKernels().multiply(a.data(), b.data(), output.data(), a.size());
+}
+
+void complexConjugateMultiply(std::span<const std::complex<float>> a, std::span<const std::complex<float>> b, std::span<std::complex<float>> output)
+{
+	checkLength(a.size(), b.size());
+	checkLength(a.size(), output.size());
+	complexKernels().conjugateMultiply(a.data(), b.data(), output.data(), a.size());
+}
+
+void complexMultiplyAccumulate(std::span<const std::complex<float>> a, std::span<const std::complex<float>> b, std::span<std::complex<float>> accumulator)
+{
+	checkLength(a.size(), b.size());
+	checkLength(a.size(), accumulator.size());
+	complexKernels().multiplyAccumulate(a.data(), b.data(), accumulator.data(), a.size());
+}
+
+void complexMagnitude(std::span<const std::complex<float>> a, std::span<float> output)
+{
+	checkLength(a.size(), output.size());
+	complexKernels().magnitude(a.data(), output.data(), a.size());
+}
+
+void complexMagnitudeSquared(std::span<const std::complex<float>> a, std::span<float> output)
+{
+	checkLength(a.size(), output.size());
+	complexKernels().magnitudeSquared(a.data(), output.data(), a.size());
+}
+
+double complexPowerSum(std::span<const std::complex<float>> a)
+{
+	return complexKernels().powerSum(a.data(), a.size());
+}
+
+void complexScale(std::span<const std::complex<float>> a, float factor, std::span<std::complex<float>> output)
+{
+	checkLength(a.size(), output.size());
+	complexKernels().scale(a.data(), factor, output.data(), a.size());
+}
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
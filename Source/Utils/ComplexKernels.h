@@ -0,0 +1,77 @@
+#pragma once
+
+/*
+* Element wise kernels on complex<float> buffers, in scalar, SSE2, AVX2 and AVX-512 versions.
+* The version is chosen once at runtime from what the CPU and the OS support, so one binary
+* uses the widest vectors of every capture host.  The vector versions are compiled with the
+* instruction set of their own function only, the rest of the program does not need it.
+* Outputs may be the same buffer as an input.
+*/
+
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include <complex>
+#include <span>
+#include <string>
+
+// ================================================================================================================================================================================ //
+//  Kernels.                                                                                                                                                                        //
+// ================================================================================================================================================================================ //
+
+enum class SimdLevel
+{
+	Scalar,
+	SSE2,
+	AVX2,			// With FMA.
+	AVX512			// AVX-512F.
+};
+
+// E.g. "AVX2".
+std::string simdLevelName(SimdLevel level);
+
+// One version of every kernel, n is the number of complex samples.
+struct ComplexKernels
+{
+	SimdLevel level = SimdLevel::Scalar;
+	void (*multiply)(const std::complex<float>* a, const std::complex<float>* b, std::complex<float>* output, size_t n) = nullptr;
+	// a times the conjugate of b.
+	void (*conjugateMultiply)(const std::complex<float>* a, const std::complex<float>* b, std::complex<float>* output, size_t n) = nullptr;
+	void (*multiplyAccumulate)(const std::complex<float>* a, const std::complex<float>* b, std::complex<float>* accumulator, size_t n) = nullptr;
+	void (*magnitude)(const std::complex<float>* a, float* output, size_t n) = nullptr;
+	void (*magnitudeSquared)(const std::complex<float>* a, float* output, size_t n) = nullptr;
+	// Sum of the magnitudes squared, in double.
+	double (*powerSum)(const std::complex<float>* a, size_t n) = nullptr;
+	void (*scale)(const std::complex<float>* a, float factor, std::complex<float>* output, size_t n) = nullptr;
+};
+
+// The widest level the CPU and the OS support.
+SimdLevel detectSimdLevel();
+
+// The kernels the program uses, the detected level unless limitSimdLevel() lowered it.
+const ComplexKernels& complexKernels();
+
+// The kernels of the given level, or nullptr when this machine (or build) does not have it.
+const ComplexKernels* complexKernels(SimdLevel level);
+
+// Use no level above the given one from now on, e.g. to compare the levels.  Returns the level
+// in use.  May only be called while no kernels are running.
+SimdLevel limitSimdLevel(SimdLevel maximum);
+
+// ================================================================================================================================================================================ //
+//  Spans.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+// The kernels in use, on spans.  The inputs and the output have to be equally long.
+void complexMultiply(std::span<const std::complex<float>> a, std::span<const std::complex<float>> b, std::span<std::complex<float>> output);
+void complexConjugateMultiply(std::span<const std::complex<float>> a, std::span<const std::complex<float>> b, std::span<std::complex<float>> output);
+void complexMultiplyAccumulate(std::span<const std::complex<float>> a, std::span<const std::complex<float>> b, std::span<std::complex<float>> accumulator);
+void complexMagnitude(std::span<const std::complex<float>> a, std::span<float> output);
+void complexMagnitudeSquared(std::span<const std::complex<float>> a, std::span<float> output);
+double complexPowerSum(std::span<const std::complex<float>> a);
+void complexScale(std::span<const std::complex<float>> a, float factor, std::span<std::complex<float>> output);
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
@@ -0,0 +1,104 @@
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include "FFT.h"
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+#include <utility>
+#include <string>
+#include <map>
+#include <mutex>
+
+// ================================================================================================================================================================================ //
+//  Plan.                                                                                                                                                                           //
+// ================================================================================================================================================================================ //
+
+FFTPlan::FFTPlan(size_t size)
+	: m_size(size)
+{
+	if (size == 0 || (size & (size - 1))) throw std::invalid_argument("FFT size " + std::to_string(size) + " is not a power of two.");
+
+	// Twiddles are computed in double so that large transforms stay accurate.
+	m_twiddles.resize(size / 2);
+	for (size_t k = 0; k < size / 2; k++)
+		m_twiddles[k] = std::polar(1.0, -2.0 * std::numbers::pi * k / size);
+
+	unsigned bits = 0;
+	while (((size_t)1 << bits) < size) bits++;
+	m_bitReverse.resize(size);
+	for (size_t n = 0; n < size; n++)
+	{
+		uint32_t reversed = 0;
+		for (unsigned b = 0; b < bits; b++) if (n & ((size_t)1 << b)) reversed |= 1u << (bits - 1 - b);
+		m_bitReverse[n] = reversed;
+	}
+}
+
+void FFTPlan::forward(std::span<std::complex<float>> data) const
+{
+	transform(data, false);
+}
+
+void FFTPlan::inverse(std::span<std::complex<float>> data) const
+{
+	transform(data, true);
+	float scale = 1.f / m_size;
+	for (std::complex<float>& sample : data) sample *= scale;
+}
+
+void FFTPlan::transform(std::span<std::complex<float>> data, bool inverse) const
+{
+	if (data.size() != m_size) throw std::invalid_argument("FFT buffer does not match the plan size.");
+
+	// Bit reversal permutation.
+	for (size_t n = 0; n < m_size; n++)
+		if (n < m_bitReverse[n]) std::swap(data[n], data[m_bitReverse[n]]);
+
+	// Butterflies.  The twiddle table is strided for the smaller stages, the inverse uses
+	// the conjugate twiddles.
+	for (size_t half = 1; half < m_size; half *= 2)
+	{
+		size_t stride = m_size / (2 * half);
+		for (size_t start = 0; start < m_size; start += 2 * half)
+		{
+			for (size_t k = 0; k < half; k++)
+			{
+				// The product is written out, std::complex multiplication handles infinities
+				// and NaN and is not inlined by every compiler.
+				float twiddleRe = m_twiddles[k * stride].real();
+				float twiddleIm = inverse ? -m_twiddles[k * stride].imag() : m_twiddles[k * stride].imag();
+				std::complex<float> sample = data[start + k + half];
+				std::complex<float> odd(twiddleRe * sample.real() - twiddleIm * sample.imag(), twiddleRe * sample.imag() + twiddleIm * sample.real());
+				data[start + k + half] = data[start + k] - odd;
+				data[start + k] += odd;
+			}
+		}
+	}
+}
+
+// ================================================================================================================================================================================ //
+//  Helpers.                                                                                                                                                                        //
+// ================================================================================================================================================================================ //
+
+size_t nextPowerOfTwo(size_t n)
+{
+	size_t size = 1;
+	while (size < n) size *= 2;
+	return size;
+}
+
+std::shared_ptr<const FFTPlan> sharedPlan(size_t size)
+{
+	static std::mutex mutex;
+	static std::map<size_t, std::shared_ptr<const FFTPlan>> plans;
+	std::lock_guard<std::mutex> lock(mutex);
+	std::shared_ptr<const FFTPlan>& plan = plans[size];
+	if (!plan) plan = std::make_shared<const FFTPlan>(size);
+	return plan;
+}
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
@@ -0,0 +1,60 @@
+#pragma once
+
+/*
+* Radix-2 FFT.  A plan precomputes the twiddle factors and the bit reversal permutation for
+* one size, after which it can transform any number of buffers of that size.  Transforms are
+* const and in place, so a single plan can be shared between threads.  sharedPlan() keeps one
+* plan per size for the whole process, so the stages do not rebuild the tables every call.
+*/
+
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include <vector>
+#include <complex>
+#include <span>
+#include <cstdint>
+#include <memory>
+
+// ================================================================================================================================================================================ //
+//  Plan.                                                                                                                                                                           //
+// ================================================================================================================================================================================ //
+
+class FFTPlan
+{
+public:
+
+	// The size has to be a power of two, see nextPowerOfTwo().
+	explicit FFTPlan(size_t size);
+
+	size_t size() const { return m_size; }
+
+	// In place forward transform.
+	void forward(std::span<std::complex<float>> data) const;
+	// In place inverse transform, scaled by 1/size.
+	void inverse(std::span<std::complex<float>> data) const;
+
+private:
+
+	size_t m_size;
+	std::vector<std::complex<float>> m_twiddles;	// exp(-j 2 pi k / size) for k < size / 2.
+	std::vector<uint32_t> m_bitReverse;
+
+	void transform(std::span<std::complex<float>> data, bool inverse) const;
+};
+
+// ================================================================================================================================================================================ //
+//  Helpers.                                                                                                                                                                        //
+// ================================================================================================================================================================================ //
+
+// Smallest power of two that is equal to or larger than n.
+size_t nextPowerOfTwo(size_t n);
+
+// The plan of the given size shared by every thread, built on the first request.  Plans are
+// kept until the process ends.
+std::shared_ptr<const FFTPlan> sharedPlan(size_t size);
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
@@ -0,0 +1,241 @@
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include "Predistortion.h"
+#include "FFT.h"
+#include "ComplexKernels.h"
+#include "WindowFunctions.h"
+#include <cmath>
+#include <numbers>
+#include <algorithm>
+#include <sstream>
+#include <fstream>
+#include <filesystem>
+#include <cstdio>
+
+// ================================================================================================================================================================================ //
+//  Key.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
+
+std::string PredistortionKey::describe() const
+{
+	std::ostringstream description;
+	description << "carrier " << carrier / 1e6 << " MHz, rate " << rate / 1e6 << " MHz, gain " << gain << " dB";
+	return description.str();
+}
+
+std::string PredistortionKey::fileName() const
+{
+	// Rounded so that tiny differences in the actual values still find the correction.
+	char name[96];
+	snprintf(name, sizeof(name), "PD_%.0fkHz_%.0fkSps_%.1fdB.pdc", carrier / 1e3, rate / 1e3, gain);
+	return name;
+}
+
+std::string Predistortion::id() const
+{
+	// FNV-1a over the taps.
+	uint64_t hash = 14695981039346656037ull;
+	const unsigned char* bytes = (const unsigned char*)taps.data();
+	for (size_t b = 0; b < taps.size() * sizeof(std::complex<float>); b++) { hash ^= bytes[b]; hash *= 1099511628211ull; }
+	char text[20];
+	snprintf(text, sizeof(text), "%016llx", (unsigned long long)hash);
+	return text;
+}
+
+// ================================================================================================================================================================================ //
+//  Estimation.                                                                                                                                                                     //
+// ================================================================================================================================================================================ //
+
+Predistortion estimatePredistortion(std::span<const std::complex<float>> reference, unsigned pulseSamples, std::span<const std::complex<float>> capture, unsigned nTaps, float regularisation)
+{
+	Predistortion correction;
+	size_t pri = reference.size();
+	pulseSamples = std::min(pulseSamples, (unsigned)pri);
+	if (!pri || !pulseSamples || capture.size() < 3 * pri) return correction;
+	nTaps |= 1;
+
+	// ------------------- //
+	//  A L I G N M E N T  //
+	// ------------------- //
+
+	// Correlate two PRIs of the capture (skipping the first, which contains the start up
+	// transient) with the reference PRI to find where the PRIs start in the capture.
+	const FFTPlan& alignPlan = *sharedPlan(nextPowerOfTwo(3 * pri));
+	std::vector<std::complex<float>> captured(alignPlan.size()), transmitted(alignPlan.size());
+	std::copy(capture.begin() + pri, capture.begin() + 3 * pri, captured.begin());
+	std::copy(reference.begin(), reference.end(), transmitted.begin());
+	alignPlan.forward(captured);
+	alignPlan.forward(transmitted);
+	complexConjugateMultiply(captured, transmitted, captured);
+	alignPlan.inverse(captured);
+	size_t lag = 0;
+	for (size_t l = 0; l < pri; l++) if (std::abs(captured[l]) > std::abs(captured[lag])) lag = l;
+	size_t start = pri + lag;
+
+	// Coherently average all of the complete PRIs, this averages out the noise.
+	size_t nPRIs = (capture.size() - start) / pri;
+	if (!nPRIs) return correction;
+	std::vector<std::complex<float>> averaged(pri, std::complex<float>(0, 0));
+	for (size_t k = 0; k < nPRIs; k++)
+		for (size_t n = 0; n < pri; n++) averaged[n] += capture[start + k * pri + n];
+	for (std::complex<float>& sample : averaged) sample /= (float)nPRIs;
+
+	// --------------------- //
+	//  E S T I M A T I O N  //
+	// --------------------- //
+
+	// Window the pulse with a margin for the response of the chain on either side.  Both the
+	// margin and the pulse fit inside the transform, so the ratio of the spectra is the response.
+	size_t margin = std::min((size_t)nTaps, (pri - pulseSamples) / 2);
+	const FFTPlan& plan = *sharedPlan(nextPowerOfTwo(pulseSamples + 2 * margin));
+	size_t fftSize = plan.size();
+	std::vector<std::complex<float>> R(fftSize), Y(fftSize);
+	for (size_t n = 0; n < pulseSamples + 2 * margin; n++)
+	{
+		size_t index = (n + pri - margin) % pri;
+		R[n] = reference[index];
+		Y[n] = averaged[index];
+	}
+	plan.forward(R);
+	plan.forward(Y);
+
+	// Only the band occupied by the pulse can be estimated.
+	float maxPower = 0;
+	for (const std::complex<float>& bin : R) maxPower = std::max(maxPower, std::norm(bin));
+	std::vector<bool> inBand(fftSize);
+	std::vector<std::complex<float>> H(fftSize, std::complex<float>(1, 0));
+	for (size_t k = 0; k < fftSize; k++)
+	{
+		inBand[k] = std::norm(R[k]) > 0.01f * maxPower;
+		if (inBand[k]) H[k] = Y[k] / R[k];
+	}
+
+	// Remove the bulk gain of the loopback and the residual (fractional) delay, which shows up
+	// as a linear phase.  What is left is the distortion of the chain.
+	std::complex<double> gain = 0, slope = 0;
+	double weight = 0;
+	for (size_t k = 0; k < fftSize; k++)
+	{
+		if (!inBand[k]) continue;
+		gain += std::complex<double>(H[k]) * (double)std::norm(R[k]);
+		weight += std::norm(R[k]);
+		size_t next = (k + 1) % fftSize;
+		if (inBand[next]) slope += std::complex<double>(H[next] * std::conj(H[k]));
+	}
+	if (weight == 0 || std::abs(gain) == 0) return correction;
+	double delayPhase = std::arg(slope);
+	std::complex<float> bulk = std::complex<float>(gain / weight);
+	float minDB = 1e9f, maxDB = -1e9f;
+	double phaseSquares = 0;
+	size_t bandBins = 0;
+	for (size_t k = 0; k < fftSize; k++)
+	{
+		if (!inBand[k]) continue;
+		double frequency = (k < fftSize / 2) ? (double)k : (double)k - fftSize;
+		H[k] = H[k] / bulk * std::complex<float>(std::polar(1.0, -delayPhase * frequency));
+		float magnitudeDB = 20 * std::log10(std::abs(H[k]));
+		minDB = std::min(minDB, magnitudeDB);
+		maxDB = std::max(maxDB, magnitudeDB);
+		phaseSquares += std::pow(std::arg(H[k]) * 180 / std::numbers::pi, 2);
+		bandBins++;
+	}
+	correction.ripple = maxDB - minDB;
+	correction.phaseError = (float)std::sqrt(phaseSquares / bandBins);
+
+	// ------------- //
+	//  D E S I G N  //
+	// ------------- //
+
+	// Regularised inverse in band, unity outside of it.
+	std::vector<std::complex<float>> C(fftSize);
+	for (size_t k = 0; k < fftSize; k++)
+		C[k] = inBand[k] ? std::conj(H[k]) / (std::norm(H[k]) + regularisation) * (1 + regularisation) : std::complex<float>(1, 0);
+	plan.inverse(C);
+
+	// Centre and window the impulse response to get the FIR.
+	nTaps = std::min(nTaps, (unsigned)fftSize | 1u);
+	const std::vector<float>& window = getWindow("Hamming", nTaps);
+	int half = nTaps / 2;
+	correction.taps.resize(nTaps);
+	for (int j = 0; j < (int)nTaps; j++)
+		correction.taps[j] = C[(j - half + fftSize) % fftSize] * window[j];
+	return correction;
+}
+
+// ================================================================================================================================================================================ //
+//  Application.                                                                                                                                                                    //
+// ================================================================================================================================================================================ //
+
+void applyPredistortion(std::vector<std::complex<float>>& wave, unsigned pulseSamples, const Predistortion& correction)
+{
+	if (correction.empty() || wave.empty()) return;
+	int pri = (int)wave.size();
+	int half = (int)correction.taps.size() / 2;
+	pulseSamples = std::min(pulseSamples, (unsigned)pri);
+	// Only the pulse (and the filter tails around it) is non zero.
+	std::vector<std::complex<float>> filtered(pri, std::complex<float>(0, 0));
+	for (int n = -half; n < (int)pulseSamples + half; n++)
+	{
+		std::complex<float> sum = 0;
+		for (int j = 0; j < (int)correction.taps.size(); j++)
+		{
+			int m = n - (j - half);
+			if (m >= 0 && m < (int)pulseSamples) sum += correction.taps[j] * wave[m];
+		}
+		filtered[(n + pri) % pri] = sum;
+	}
+	wave = std::move(filtered);
+}
+
+// ================================================================================================================================================================================ //
+//  Storage.                                                                                                                                                                        //
+// ================================================================================================================================================================================ //
+
+// File layout: magic, key (carrier, rate, gain), ripple, phase error, tap count, taps.
+static const char predistortionMagic[8] = { 'B', '2', '1', '0', 'P', 'D', 'C', '1' };
+
+bool savePredistortion(const Predistortion& correction, const std::string& directory)
+{
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+	std::ofstream file(std::filesystem::path(directory) / correction.key.fileName(), std::ofstream::binary);
+	if (!file) return false;
+	uint32_t nTaps = (uint32_t)correction.taps.size();
+	file.write(predistortionMagic, sizeof(predistortionMagic));
+	file.write((const char*)&correction.key.carrier, sizeof(double));
+	file.write((const char*)&correction.key.rate, sizeof(double));
+	file.write((const char*)&correction.key.gain, sizeof(double));
+	file.write((const char*)&correction.ripple, sizeof(float));
+	file.write((const char*)&correction.phaseError, sizeof(float));
+	file.write((const char*)&nTaps, sizeof(nTaps));
+	file.write((const char*)correction.taps.data(), nTaps * sizeof(std::complex<float>));
+	return (bool)file;
+}
+
+bool loadPredistortion(const PredistortionKey& key, const std::string& directory, Predistortion& correction)
+{
+	std::ifstream file(std::filesystem::path(directory) / key.fileName(), std::ifstream::binary);
+	if (!file) return false;
+	char magic[sizeof(predistortionMagic)];
+	Predistortion loaded;
+	uint32_t nTaps = 0;
+	file.read(magic, sizeof(magic));
+	file.read((char*)&loaded.key.carrier, sizeof(double));
+	file.read((char*)&loaded.key.rate, sizeof(double));
+	file.read((char*)&loaded.key.gain, sizeof(double));
+	file.read((char*)&loaded.ripple, sizeof(float));
+	file.read((char*)&loaded.phaseError, sizeof(float));
+	file.read((char*)&nTaps, sizeof(nTaps));
+	if (!file || !std::equal(magic, magic + sizeof(magic), predistortionMagic) || nTaps > 65535) return false;
+	loaded.taps.resize(nTaps);
+	file.read((char*)loaded.taps.data(), nTaps * sizeof(std::complex<float>));
+	if (!file) return false;
+	correction = std::move(loaded);
+	return true;
+}
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
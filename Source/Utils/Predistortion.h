@@ -0,0 +1,68 @@
+#pragma once
+
+/*
+* TX predistortion.  The transmitted pulse is captured through a cable (and attenuator)
+* loopback, the amplitude ripple and phase non-linearity of the TX chain is estimated from it
+* and an equalising FIR is designed that is applied to the pulse before it is quantised.
+* Corrections depend on the carrier, sampling rate and TX gain, and are cached per combination.
+*/
+
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include <vector>
+#include <complex>
+#include <span>
+#include <string>
+#include <cstdint>
+
+// ================================================================================================================================================================================ //
+//  Types.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+// The settings a correction was calibrated for.
+struct PredistortionKey
+{
+	double carrier = 0;		// TX carrier [Hz].
+	double rate = 0;		// TX sampling rate [Hz].
+	double gain = 0;		// TX gain [dB].
+
+	std::string describe() const;
+	// File the correction is stored in, inside the predistortion directory.
+	std::string fileName() const;
+};
+
+struct Predistortion
+{
+	PredistortionKey key;
+	std::vector<std::complex<float>> taps;		// Equalising FIR, centred on the middle tap.
+	float ripple = 0;							// Peak to peak in band amplitude ripple of the TX chain [dB].
+	float phaseError = 0;						// RMS in band phase non-linearity of the TX chain [deg].
+
+	bool empty() const { return taps.empty(); }
+	// Identifies the taps, so that waveforms predistorted by different calibrations are told apart.
+	std::string id() const;
+};
+
+// ================================================================================================================================================================================ //
+//  Declerations.                                                                                                                                                                   //
+// ================================================================================================================================================================================ //
+
+// Estimate the correction from a loopback capture of the periodic transmission.  reference is one
+// PRI of the transmitted wave with the pulse in the first pulseSamples, capture should hold at
+// least three PRIs.  regularisation limits the gain of the inverse where the chain attenuates.
+// Returns an empty correction if the capture is too short or the pulse was not found.
+Predistortion estimatePredistortion(std::span<const std::complex<float>> reference, unsigned pulseSamples, std::span<const std::complex<float>> capture, unsigned nTaps = 63, float regularisation = 0.01f);
+
+// Filter one PRI of the wave with the correction.  The transmission is periodic, so the
+// filter wraps around the PRI.
+void applyPredistortion(std::vector<std::complex<float>>& wave, unsigned pulseSamples, const Predistortion& correction);
+
+// Store and load corrections in the given directory.
+bool savePredistortion(const Predistortion& correction, const std::string& directory);
+bool loadPredistortion(const PredistortionKey& key, const std::string& directory, Predistortion& correction);
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
@@ -0,0 +1,213 @@
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include "PulseProfiles.h"
+#include <array>
+#include <map>
+#include <mutex>
+#include <numbers>
+#include <string_view>
+#include <sstream>
+#include <algorithm>
+
+// ================================================================================================================================================================================ //
+//  Compile time generation.                                                                                                                                                        //
+// ================================================================================================================================================================================ //
+
+#ifdef PULSE_PROFILES
+
+namespace
+{
+	// ----------------------- //
+	//  M A T H E M A T I C S  //
+	// ----------------------- //
+
+	// std::sin and std::cos are not constexpr, these are accurate to a few ulp in double, which
+	// is well below the float precision of the pulse.
+
+	constexpr double PI = std::numbers::pi;
+
+	// Reduce to [-pi, pi], with 2 pi split in two parts so the large phases of long pulses
+	// are reduced without losing precision.
+	constexpr double reducePhase(double x)
+	{
+		constexpr double twoPiHigh = 6.28318530717958623200e+00;
+		constexpr double twoPiLow = 2.44929359829470635445e-16;
+		double turns = x / twoPiHigh;
+		double k = (double)(long long)(turns + ((turns >= 0) ? 0.5 : -0.5));
+		return (x - k * twoPiHigh) - k * twoPiLow;
+	}
+
+	constexpr double sine(double x)
+	{
+		x = reducePhase(x);
+		double sum = 0;
+		double term = x;
+		for (int n = 1; n < 24; n++)
+		{
+			sum += term;
+			term *= -x * x / ((2.0 * n) * (2.0 * n + 1));
+		}
+		return sum;
+	}
+
+	constexpr double cosine(double x)
+	{
+		x = reducePhase(x);
+		double sum = 0;
+		double term = 1;
+		for (int n = 1; n < 24; n++)
+		{
+			sum += term;
+			term *= -x * x / ((2.0 * n - 1) * (2.0 * n));
+		}
+		return sum;
+	}
+
+	// --------------- //
+	//  W I N D O W S  //
+	// --------------- //
+
+	// Same definitions as WindowFunctions.cpp, evaluated in double and stored as float.
+	constexpr float window(std::string_view type, int n, int nSamples)
+	{
+		if (type == "Hamming")
+		{
+			int min = -(nSamples / 2);
+			return (float)(0.54 + 0.46 * cosine((2 * PI * (n + min)) / nSamples));
+		}
+		if (type == "Blackman")
+		{
+			if (nSamples == 1) return 1.f;
+			return (float)(0.42 - 0.5 * cosine((2 * PI * n) / (nSamples - 1)) + 0.08 * cosine(((4 * PI * n) / (nSamples - 1))));
+		}
+		return 1.f;
+	}
+
+	// ------------- //
+	//  P U L S E S  //
+	// ------------- //
+
+	template <size_t N>
+	struct PulseTable
+	{
+		std::array<float, 2 * N> samples{};
+		double peak = 0;
+		double power = 0;
+	};
+
+	// Frequency ramp with the same float order of operations as kernels::linearChirp(), so only
+	// the rounding of the sine and cosine can differ from the runtime generator.
+	template <size_t N>
+	constexpr PulseTable<N> linearChirpTable(unsigned samplingFreq, float bandwidth, std::string_view windowType)
+	{
+		static_assert(N % 2 == 1, "Pulse tables need an odd number of samples.");
+		PulseTable<N> table;
+		const float pi = std::numbers::pi_v<float>;
+		const float fs = (float)samplingFreq;
+		float freqGradient = bandwidth / ((float)N - 1);
+		int offset = ((int)N - 1) / 2;
+		for (int index = 0; index < (int)N; index++)
+		{
+			float freq = ((freqGradient * index) - (bandwidth / 2)) / fs;
+			float phase = (float)((index - offset) * -2) * pi * freq;
+			float weight = window(windowType, index, (int)N);
+			float re = weight * (float)cosine(phase);
+			float im = weight * (float)sine(phase);
+			table.samples[2 * index] = re;
+			table.samples[2 * index + 1] = im;
+			table.peak = std::max(table.peak, (double)std::max((re < 0) ? -re : re, (im < 0) ? -im : im));
+			table.power += (double)re * re + (double)im * im;
+		}
+		return table;
+	}
+
+	// ----------------- //
+	//  P R O F I L E S  //
+	// ----------------- //
+
+	// The bandwidth follows generateTransmissionPusle(), fs / 2.1 for the linear chirp.
+	// The pulse lengths correspond to a 3 km dead zone.
+	constexpr unsigned fs12M = 12000000;
+	constexpr unsigned fs20M = 20000000;
+	constexpr float bw12M = (float)(fs12M / 2.1);
+	constexpr float bw20M = (float)(fs20M / 2.1);
+
+	constexpr auto lfm12M241 = linearChirpTable<241>(fs12M, bw12M, "None");
+	constexpr auto lfm12M241Hamming = linearChirpTable<241>(fs12M, bw12M, "Hamming");
+	constexpr auto lfm20M401 = linearChirpTable<401>(fs20M, bw20M, "None");
+	constexpr auto lfm20M401Blackman = linearChirpTable<401>(fs20M, bw20M, "Blackman");
+
+	template <size_t N>
+	PulseProfile makeProfile(const char* name, const char* window, unsigned samplingFreq, float bandwidth, const PulseTable<N>& table)
+	{
+		return { name, linearChirpWave, window, samplingFreq, bandwidth, (unsigned)N, table.samples.data(), table.peak, table.power };
+	}
+}
+
+#endif
+
+// ================================================================================================================================================================================ //
+//  Lookup.                                                                                                                                                                         //
+// ================================================================================================================================================================================ //
+
+const std::vector<PulseProfile>& pulseProfiles()
+{
+#ifdef PULSE_PROFILES
+	static const std::vector<PulseProfile> profiles = {
+		makeProfile("LFM-12M-241", "None", fs12M, bw12M, lfm12M241),
+		makeProfile("LFM-12M-241-Hamming", "Hamming", fs12M, bw12M, lfm12M241Hamming),
+		makeProfile("LFM-20M-401", "None", fs20M, bw20M, lfm20M401),
+		makeProfile("LFM-20M-401-Blackman", "Blackman", fs20M, bw20M, lfm20M401Blackman)
+	};
+#else
+	static const std::vector<PulseProfile> profiles;
+#endif
+	return profiles;
+}
+
+const PulseProfile* findPulseProfile(const std::string& name)
+{
+	for (const PulseProfile& profile : pulseProfiles())
+		if (name == profile.name) return &profile;
+	return nullptr;
+}
+
+// ================================================================================================================================================================================ //
+//  Consistency.                                                                                                                                                                    //
+// ================================================================================================================================================================================ //
+
+bool verifyPulseProfile(const PulseProfile& profile, std::string& problem)
+{
+	static std::mutex checkedMutex;
+	static std::map<const PulseProfile*, std::string> checked;
+	std::lock_guard<std::mutex> lock(checkedMutex);
+	auto previous = checked.find(&profile);
+	if (previous != checked.end()) { problem = previous->second; return problem.empty(); }
+
+	// Generate the pulse at runtime and find the largest difference to the table.
+	std::vector<std::complex<float>> pulse(profile.pulseSamples);
+	problem.clear();
+	if (!generateWave(std::span(pulse), profile.waveType, profile.bandwidth, 1.f, profile.samplingFreq, profile.window))
+		problem = "the runtime generator does not support the profile";
+	else
+	{
+		float maxError = 0;
+		for (unsigned n = 0; n < profile.pulseSamples; n++)
+			maxError = std::max(maxError, std::abs(pulse[n] - std::complex<float>(profile.samples[2 * n], profile.samples[2 * n + 1])));
+		// A few float ulp of the phase, far below the sc16 resolution.
+		if (maxError > 1e-4f)
+		{
+			std::ostringstream description;
+			description << "the table differs from the runtime generator by up to " << maxError;
+			problem = description.str();
+		}
+	}
+	checked[&profile] = problem;
+	return problem.empty();
+}
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
@@ -0,0 +1,63 @@
+#pragma once
+
+/*
+* Pulse tables for the standard operating profiles.  A profile fixes the sampling rate, the
+* pulse length, the wave type and the window, so its pulse never changes and is evaluated at
+* compile time into read only tables.  Setup copies the table instead of generating the pulse.
+* The tables are only compiled in when PULSE_PROFILES is defined (see the project settings).
+*/
+
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include <vector>
+#include <complex>
+#include <span>
+#include <string>
+#include <cmath>
+#include "Waveforms.h"
+#include "WaveformKernels.h"
+
+// ================================================================================================================================================================================ //
+//  Profiles.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+struct PulseProfile
+{
+	const char* name;			// Name used in Settings.yml, e.g. "LFM-12M-241".
+	const char* waveType;		// Wave type, as passed to generateWave().
+	const char* window;			// Window function.
+	unsigned samplingFreq;		// [Hz].
+	float bandwidth;			// Bandwidth passed to the generator [Hz].
+	unsigned pulseSamples;		// Samples in the pulse.
+	const float* samples;		// Interleaved I Q of the pulse at unit amplitude.
+	double peak;				// Per rail peak of the pulse.
+	double power;				// Summed power of the pulse.
+
+	WaveLevel level() const { return { peak, std::sqrt(power / pulseSamples) }; }
+};
+
+// The profiles compiled into the binary.  Empty if PULSE_PROFILES is not defined.
+const std::vector<PulseProfile>& pulseProfiles();
+
+// The profile with the given name, nullptr if there is none.
+const PulseProfile* findPulseProfile(const std::string& name);
+
+// Compare the table to the pulse from the runtime generator.  The comparison is done once per
+// profile and remembered.  On a mismatch problem describes it.
+bool verifyPulseProfile(const PulseProfile& profile, std::string& problem);
+
+// Copy the pulse of the profile into the span, scaled by gain (the DAC gain for sc16).
+template <typename SampleType>
+void copyPulseProfile(const PulseProfile& profile, std::span<SampleType> pulse, float gain = 1)
+{
+	using Traits = SampleTraits<SampleType>;
+	using Real = typename Traits::Real;
+	for (size_t n = 0; n < std::min<size_t>(pulse.size(), profile.pulseSamples); n++)
+		pulse[n] = Traits::convert((Real)gain * profile.samples[2 * n], (Real)gain * profile.samples[2 * n + 1]);
+}
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
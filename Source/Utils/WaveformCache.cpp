@@ -0,0 +1,53 @@
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include "WaveformCache.h"
+#include <sstream>
+
+// ================================================================================================================================================================================ //
+//  Key.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
+
+std::string WaveformKey::describe() const
+{
+	// Full precision so that any change to a parameter changes the key.
+	std::ostringstream description;
+	description.precision(9);
+	description << "v" << generatorVersion << "|" << type << "|" << pulseSamples << "|" << priSamples << "|" << bandwidth << "|" << samplingFreq << "|"
+				<< describeWindow(window, windowParameters) << "|" << amplitude << "|" << format << "|" << scaling << "|" << predistortion;
+	return description.str();
+}
+
+uint64_t WaveformKey::hash() const
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (char character : describe())
+	{
+		hash ^= (unsigned char)character;
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+std::string WaveformKey::differences(const WaveformKey& other) const
+{
+	std::vector<std::string> changed;
+	if (type != other.type)										changed.push_back("wave type");
+	if (pulseSamples != other.pulseSamples)						changed.push_back("pulse samples");
+	if (priSamples != other.priSamples)							changed.push_back("PRI samples");
+	if (bandwidth != other.bandwidth)							changed.push_back("bandwidth");
+	if (samplingFreq != other.samplingFreq)						changed.push_back("sampling frequency");
+	if (describeWindow(window, windowParameters) != describeWindow(other.window, other.windowParameters)) changed.push_back("window");
+	if (amplitude != other.amplitude)							changed.push_back("amplitude");
+	if (format != other.format)									changed.push_back("format");
+	if (scaling != other.scaling)								changed.push_back("scaling");
+	if (predistortion != other.predistortion)					changed.push_back("predistortion");
+	std::string list;
+	for (size_t k = 0; k < changed.size(); k++) list += (k ? ", " : "") + changed[k];
+	return list;
+}
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
@@ -0,0 +1,182 @@
+#pragma once
+
+/*
+* Cache for generated transmission waveforms.  A waveform is identified by every parameter
+* that went into generating it, so an unchanged configuration never regenerates its waveform.
+* Entries live in memory and are persisted to disk so they survive between sessions.
+*/
+
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include <string>
+#include <vector>
+#include <map>
+#include <deque>
+#include <complex>
+#include <cstdint>
+#include <cstdio>
+#include <type_traits>
+#include <fstream>
+#include <filesystem>
+#include "WindowFunctions.h"
+
+// ================================================================================================================================================================================ //
+//  Key.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
+
+// Every parameter that determines the samples of a transmission waveform.
+struct WaveformKey
+{
+	// Version of the generators, windows and scaling.  Raise it whenever a change to them changes
+	// the samples of a key, so entries generated by an older build are not served.
+	static constexpr unsigned generatorVersion = 1;
+
+	std::string type;					// Wave type, e.g. "Linear Frequency Chirp".
+	unsigned pulseSamples = 0;			// Samples in the pulse.
+	unsigned priSamples = 0;			// Samples in the pulse plus the zero padding.
+	float bandwidth = 0;				// Bandwidth (or frequency) passed to the generator [Hz].
+	float samplingFreq = 0;				// Sampling frequency [Hz].
+	std::string window = "None";		// Window function.
+	WindowParameters windowParameters;	// Parameters of the window function.
+	float amplitude = 0;				// Amplitude of the pulse.
+	std::string format = "fc32";		// Sample format of the stored waveform.
+	std::string scaling = "None";		// Scaling to the integer formats, e.g. "Peak -1 dBFS".
+	std::string predistortion = "None";	// Id of the TX predistortion applied to the waveform.
+
+	// Canonical text description, used as the cache key.  Starts with the generator version.
+	std::string describe() const;
+	// 64 bit FNV-1a hash of the description.
+	uint64_t hash() const;
+	// Lists the parameters that differ from the other key, e.g. "bandwidth, window".
+	std::string differences(const WaveformKey& other) const;
+};
+
+// Outcome of looking up a waveform in the cache.
+enum class CacheResult
+{
+	MemoryHit,		// Waveform was generated earlier this session.
+	DiskHit,		// Waveform was loaded from the cache directory.
+	Miss			// Waveform has to be generated.
+};
+
+// Name of the sample format of the given sample type.
+template <typename SampleType>
+constexpr const char* sampleFormatName()
+{
+	if constexpr (std::is_same_v<SampleType, std::complex<float>>)		return "fc32";
+	else if constexpr (std::is_same_v<SampleType, std::complex<double>>)	return "fc64";
+	else if constexpr (std::is_same_v<SampleType, std::complex<int16_t>>)	return "sc16";
+	else static_assert(sizeof(SampleType) == 0, "Unsupported sample type.");
+}
+
+// ================================================================================================================================================================================ //
+//  Cache.                                                                                                                                                                          //
+// ================================================================================================================================================================================ //
+
+template <typename SampleType>
+class WaveformCache
+{
+public:
+
+	// The directory the cache is persisted to.  Persisting is disabled while it is empty.
+	void setDirectory(const std::string& directory)
+	{
+		m_directory = directory;
+		std::error_code error;
+		if (m_directory.size()) std::filesystem::create_directories(m_directory, error);
+	}
+
+	// Look for the waveform in memory and then on disk.
+	CacheResult fetch(const WaveformKey& key, std::vector<SampleType>& wave)
+	{
+		std::string description = key.describe();
+		auto entry = m_memory.find(description);
+		if (entry != m_memory.end()) { wave = entry->second; return CacheResult::MemoryHit; }
+		if (loadFromDisk(key, description, wave)) { remember(description, wave); return CacheResult::DiskHit; }
+		return CacheResult::Miss;
+	}
+
+	// Add a newly generated waveform to the cache.
+	void store(const WaveformKey& key, const std::vector<SampleType>& wave)
+	{
+		std::string description = key.describe();
+		remember(description, wave);
+		saveToDisk(key, description, wave);
+	}
+
+private:
+
+	// Max waveforms kept in memory.  Older waveforms are still available from disk.
+	static const size_t m_maxMemoryEntries = 16;
+	// Identifies cache files and their layout.
+	static constexpr char m_magic[8] = { 'B', '2', '1', '0', 'W', 'F', 'C', '1' };
+
+	std::string m_directory;
+	std::map<std::string, std::vector<SampleType>> m_memory;
+	std::deque<std::string> m_insertionOrder;
+
+	void remember(const std::string& description, const std::vector<SampleType>& wave)
+	{
+		if (m_memory.count(description)) return;
+		if (m_insertionOrder.size() >= m_maxMemoryEntries)
+		{
+			m_memory.erase(m_insertionOrder.front());
+			m_insertionOrder.pop_front();
+		}
+		m_memory[description] = wave;
+		m_insertionOrder.push_back(description);
+	}
+
+	std::string filePath(const WaveformKey& key) const
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "%016llx.wfc", (unsigned long long)key.hash());
+		return (std::filesystem::path(m_directory) / name).string();
+	}
+
+	// File layout: magic, description length, description, sample count, samples.
+	void saveToDisk(const WaveformKey& key, const std::string& description, const std::vector<SampleType>& wave) const
+	{
+		if (m_directory.empty()) return;
+		std::ofstream file(filePath(key), std::ofstream::binary);
+		if (!file) return;
+		uint32_t descriptionLength = (uint32_t)description.size();
+		uint64_t sampleCount = wave.size();
+		file.write(m_magic, sizeof(m_magic));
+		file.write((const char*)&descriptionLength, sizeof(descriptionLength));
+		file.write(description.data(), descriptionLength);
+		file.write((const char*)&sampleCount, sizeof(sampleCount));
+		file.write((const char*)wave.data(), sampleCount * sizeof(SampleType));
+	}
+
+	bool loadFromDisk(const WaveformKey& key, const std::string& description, std::vector<SampleType>& wave) const
+	{
+		if (m_directory.empty()) return false;
+		std::ifstream file(filePath(key), std::ifstream::binary);
+		if (!file) return false;
+		// Check the header and that the file belongs to this exact key.
+		char magic[sizeof(m_magic)];
+		uint32_t descriptionLength = 0;
+		file.read(magic, sizeof(magic));
+		file.read((char*)&descriptionLength, sizeof(descriptionLength));
+		if (!file || std::string(magic, sizeof(magic)) != std::string(m_magic, sizeof(m_magic)) || descriptionLength != description.size()) return false;
+		std::string storedDescription(descriptionLength, '\0');
+		file.read(storedDescription.data(), descriptionLength);
+		if (storedDescription != description) return false;
+		// Read the samples.
+		uint64_t sampleCount = 0;
+		file.read((char*)&sampleCount, sizeof(sampleCount));
+		if (!file || sampleCount != key.priSamples) return false;
+		std::vector<SampleType> stored(sampleCount);
+		file.read((char*)stored.data(), sampleCount * sizeof(SampleType));
+		if (!file) return false;
+		wave = std::move(stored);
+		return true;
+	}
+};
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
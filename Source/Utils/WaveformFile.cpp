@@ -0,0 +1,147 @@
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include "WaveformFile.h"
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// ================================================================================================================================================================================ //
+//  Writing.                                                                                                                                                                        //
+// ================================================================================================================================================================================ //
+
+uint64_t waveformChecksum(const void* data, size_t bytes)
+{
+	uint64_t hash = 14695981039346656037ull;
+	const unsigned char* byte = (const unsigned char*)data;
+	for (size_t b = 0; b < bytes; b++) { hash ^= byte[b]; hash *= 1099511628211ull; }
+	return hash;
+}
+
+namespace
+{
+	// Copy text into a fixed size header field, leaving it null terminated.
+	template <size_t size>
+	void copyText(char (&field)[size], const std::string& text)
+	{
+		std::memcpy(field, text.data(), std::min(text.size(), size - 1));
+	}
+
+	bool writeSamples(const std::string& path, const char* format, const void* data, size_t nSamples, uint32_t sampleSize, double samplingFreq, uint64_t pulseSamples, const std::string& generator)
+	{
+		WaveformFileHeader header;
+		copyText(header.format, format);
+		header.sampleSize = sampleSize;
+		header.samplingFreq = samplingFreq;
+		header.pulseSamples = pulseSamples;
+		header.priSamples = nSamples;
+		header.dataOffset = (sizeof(WaveformFileHeader) + waveformFileAlignment - 1) / waveformFileAlignment * waveformFileAlignment;
+		header.checksum = waveformChecksum(data, nSamples * sampleSize);
+		copyText(header.generator, generator);
+
+		std::ofstream file(path, std::ofstream::binary);
+		if (!file) return false;
+		file.write((const char*)&header, sizeof(header));
+		std::vector<char> padding(header.dataOffset - sizeof(header), 0);
+		file.write(padding.data(), padding.size());
+		file.write((const char*)data, nSamples * sampleSize);
+		return (bool)file;
+	}
+}
+
+bool writeWaveformFile(const std::string& path, std::span<const std::complex<int16_t>> samples, double samplingFreq, uint64_t pulseSamples, const std::string& generator)
+{
+	return writeSamples(path, "sc16", samples.data(), samples.size(), sizeof(std::complex<int16_t>), samplingFreq, pulseSamples, generator);
+}
+
+bool writeWaveformFile(const std::string& path, std::span<const std::complex<float>> samples, double samplingFreq, uint64_t pulseSamples, const std::string& generator)
+{
+	return writeSamples(path, "fc32", samples.data(), samples.size(), sizeof(std::complex<float>), samplingFreq, pulseSamples, generator);
+}
+
+// ================================================================================================================================================================================ //
+//  Reading.                                                                                                                                                                        //
+// ================================================================================================================================================================================ //
+
+bool MappedWaveform::open(const std::string& path)
+{
+	close();
+
+	// --------------- //
+	//  M A P P I N G  //
+	// --------------- //
+
+#ifdef _WIN32
+	m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (m_file == INVALID_HANDLE_VALUE) { m_file = nullptr; m_error = "Could not open " + path + "."; return false; }
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(m_file, &fileSize);
+	m_size = (size_t)fileSize.QuadPart;
+	if (m_size < sizeof(WaveformFileHeader)) { m_error = path + " is too small to be a waveform file."; close(); return false; }
+	m_mapping = CreateFileMappingA(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (m_mapping) m_data = (const char*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+	m_file = ::open(path.c_str(), O_RDONLY);
+	if (m_file < 0) { m_error = "Could not open " + path + "."; return false; }
+	struct stat fileStat;
+	fstat(m_file, &fileStat);
+	m_size = (size_t)fileStat.st_size;
+	if (m_size < sizeof(WaveformFileHeader)) { m_error = path + " is too small to be a waveform file."; close(); return false; }
+	void* data = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, m_file, 0);
+	if (data != MAP_FAILED) m_data = (const char*)data;
+#endif
+	if (!m_data) { m_error = "Could not map " + path + "."; close(); return false; }
+
+	// --------------------- //
+	//  V A L I D A T I O N  //
+	// --------------------- //
+
+	const WaveformFileHeader& fileHeader = header();
+	WaveformFileHeader expected;
+	std::string fileFormat = format();
+	uint32_t sampleSize = (fileFormat == "fc32") ? sizeof(std::complex<float>) : (fileFormat == "sc16") ? sizeof(std::complex<int16_t>) : 0;
+	if (!std::equal(fileHeader.magic, fileHeader.magic + sizeof(fileHeader.magic), expected.magic)) m_error = path + " is not a waveform file.";
+	else if (fileHeader.version != expected.version) m_error = path + " has unsupported version " + std::to_string(fileHeader.version) + ".";
+	else if (!sampleSize || fileHeader.sampleSize != sampleSize) m_error = path + " has unsupported format '" + fileFormat + "'.";
+	else if (fileHeader.dataOffset % waveformFileAlignment || fileHeader.dataOffset < sizeof(WaveformFileHeader)) m_error = path + " has misaligned samples.";
+	else if (fileHeader.pulseSamples > fileHeader.priSamples || fileHeader.dataOffset + fileHeader.priSamples * sampleSize > m_size) m_error = path + " is truncated.";
+	else { m_error.clear(); return true; }
+	close();
+	return false;
+}
+
+bool MappedWaveform::verify() const
+{
+	if (!isOpen()) return false;
+	return waveformChecksum(m_data + header().dataOffset, header().priSamples * header().sampleSize) == header().checksum;
+}
+
+void MappedWaveform::close()
+{
+#ifdef _WIN32
+	if (m_data) UnmapViewOfFile(m_data);
+	if (m_mapping) CloseHandle(m_mapping);
+	if (m_file) CloseHandle(m_file);
+	m_mapping = nullptr;
+	m_file = nullptr;
+#else
+	if (m_data) munmap((void*)m_data, m_size);
+	if (m_file >= 0) ::close(m_file);
+	m_file = -1;
+#endif
+	m_data = nullptr;
+	m_size = 0;
+}
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
@@ -0,0 +1,108 @@
+#pragma once
+
+/*
+* Binary waveform files, shared by the transmitter, the processing and the Julia scripts so that
+* they all use the exact same samples.  A file is a fixed 256 byte header followed by the samples,
+* which start on a 64 byte boundary.  Files are memory mapped, so reading them does not copy.
+*/
+
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include <string>
+#include <vector>
+#include <complex>
+#include <span>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// ================================================================================================================================================================================ //
+//  Header.                                                                                                                                                                         //
+// ================================================================================================================================================================================ //
+
+struct WaveformFileHeader
+{
+	char magic[8] = { 'B', '2', '1', '0', 'W', 'F', 'M', '1' };
+	uint32_t version = 1;
+	uint32_t headerSize = sizeof(WaveformFileHeader);
+	char format[8] = {};			// Sample format, "fc32" or "sc16".
+	uint32_t sampleSize = 0;		// Bytes per complex sample.
+	uint32_t reserved = 0;
+	double samplingFreq = 0;		// [Hz].
+	uint64_t pulseSamples = 0;		// Samples in the pulse.
+	uint64_t priSamples = 0;		// Samples stored, the pulse plus the zero padding.
+	uint64_t dataOffset = 0;		// Offset of the first sample in the file.
+	uint64_t checksum = 0;			// 64 bit FNV-1a of the sample bytes.
+	char generator[184] = {};		// Description of the generator parameters, null terminated.
+};
+static_assert(sizeof(WaveformFileHeader) == 256, "The waveform file header layout is fixed.");
+
+// Alignment of the samples in the file.
+const uint64_t waveformFileAlignment = 64;
+
+// ================================================================================================================================================================================ //
+//  Writing.                                                                                                                                                                        //
+// ================================================================================================================================================================================ //
+
+// 64 bit FNV-1a checksum of the samples.
+uint64_t waveformChecksum(const void* data, size_t bytes);
+
+// Write the samples with a header.  Returns false if the file could not be written.
+bool writeWaveformFile(const std::string& path, std::span<const std::complex<int16_t>> samples, double samplingFreq, uint64_t pulseSamples, const std::string& generator);
+bool writeWaveformFile(const std::string& path, std::span<const std::complex<float>> samples, double samplingFreq, uint64_t pulseSamples, const std::string& generator);
+
+// ================================================================================================================================================================================ //
+//  Reading.                                                                                                                                                                        //
+// ================================================================================================================================================================================ //
+
+// A read only memory mapping of a waveform file.
+class MappedWaveform
+{
+public:
+
+	MappedWaveform() = default;
+	explicit MappedWaveform(const std::string& path) { open(path); }
+	~MappedWaveform() { close(); }
+	MappedWaveform(const MappedWaveform&) = delete;
+	MappedWaveform& operator=(const MappedWaveform&) = delete;
+
+	// Map the file and check the header.  On failure error() describes the problem.
+	bool open(const std::string& path);
+	void close();
+
+	bool isOpen() const { return m_data != nullptr; }
+	const std::string& error() const { return m_error; }
+	const WaveformFileHeader& header() const { return *(const WaveformFileHeader*)m_data; }
+	std::string format() const { return std::string(header().format, strnlen(header().format, sizeof(header().format))); }
+
+	// Recompute the checksum of the samples and compare it to the header.
+	bool verify() const;
+
+	// The samples, without copying.  Empty if the file holds a different format.
+	template <typename SampleType>
+	std::span<const SampleType> samples() const
+	{
+		static_assert(std::is_same_v<SampleType, std::complex<float>> || std::is_same_v<SampleType, std::complex<int16_t>>, "Unsupported sample type.");
+		const char* wanted = std::is_same_v<SampleType, std::complex<float>> ? "fc32" : "sc16";
+		if (!isOpen() || format() != wanted) return {};
+		return { (const SampleType*)(m_data + header().dataOffset), (size_t)header().priSamples };
+	}
+
+private:
+
+	const char* m_data = nullptr;
+	size_t m_size = 0;
+	std::string m_error;
+#ifdef _WIN32
+	void* m_file = nullptr;
+	void* m_mapping = nullptr;
+#else
+	int m_file = -1;
+#endif
+};
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
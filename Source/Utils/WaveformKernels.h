@@ -0,0 +1,190 @@
+#pragma once
+
+/*
+* Waveform generator kernels, specialised at compile time on the output sample type and the
+* window policy.  Kernels write into a caller provided span and never allocate, so they can
+* generate straight into transmit buffers.  Waveforms.h is the runtime (string) dispatch layer.
+*/
+
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include <span>
+#include <complex>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+#include <algorithm>
+
+// ================================================================================================================================================================================ //
+//  Sample types.                                                                                                                                                                   //
+// ================================================================================================================================================================================ //
+
+// Converts the real and imaginary parts computed by the kernels to the output sample type.
+// Real is the type the kernel computes in.
+template <typename SampleType>
+struct SampleTraits;
+
+template <>
+struct SampleTraits<std::complex<float>>
+{
+	using Real = float;
+	static std::complex<float> convert(float re, float im) { return { re, im }; }
+};
+
+template <>
+struct SampleTraits<std::complex<double>>
+{
+	using Real = double;
+	static std::complex<double> convert(double re, double im) { return { re, im }; }
+};
+
+// The parts are expected to already be scaled to the DAC range, they are rounded and saturated.
+template <>
+struct SampleTraits<std::complex<int16_t>>
+{
+	using Real = float;
+	static int16_t saturate(float value) { return (int16_t)std::clamp(std::round(value), -32767.f, 32767.f); }
+	static std::complex<int16_t> convert(float re, float im) { return { saturate(re), saturate(im) }; }
+};
+
+// ================================================================================================================================================================================ //
+//  Window policies.                                                                                                                                                                //
+// ================================================================================================================================================================================ //
+
+// Rectangular window, the weight multiply is optimised away.
+struct NoWindow
+{
+	float operator()(int) const { return 1.f; }
+};
+
+// Window from a precomputed table (see getWindow() in WindowFunctions.h).
+struct TableWindow
+{
+	const float* weights;
+	float operator()(int n) const { return weights[n]; }
+};
+
+// ================================================================================================================================================================================ //
+//  Kernels.                                                                                                                                                                        //
+// ================================================================================================================================================================================ //
+
+namespace kernels
+{
+	// ------------- //
+	//  P H A S E S  //
+	// ------------- //
+
+	// Each kernel calls sink(index, re, im) for every sample.  Phases are evaluated in the same
+	// order of operations as the original generators so fc32 output is unchanged.
+
+	// Frequency ramp centred on the middle sample, from -bandwidth/2 to bandwidth/2.
+	template <typename Real, typename WindowPolicy, typename Sink>
+	void linearChirp(int nSamples, Real bandwidth, Real amplitude, Real samplingFreq, const WindowPolicy& window, Sink&& sink)
+	{
+		const Real pi = std::numbers::pi_v<Real>;
+		Real freqGradient = bandwidth / ((Real)nSamples - 1);
+		int offset = (nSamples - 1) / 2;
+		for (int index = 0; index < nSamples; index++)
+		{
+			Real freq = ((freqGradient * index) - (bandwidth / 2)) / samplingFreq;
+			Real phase = (Real)((index - offset) * -2) * pi * freq;
+			Real weight = amplitude * window(index);
+			sink(index, weight * std::cos(phase), weight * std::sin(phase));
+		}
+	}
+
+	// Constant frequency tone.
+	template <typename Real, typename WindowPolicy, typename Sink>
+	void constSine(int nSamples, Real frequency, Real amplitude, const WindowPolicy& window, Sink&& sink)
+	{
+		const Real pi = std::numbers::pi_v<Real>;
+		for (int n = 0; n < nSamples; n++)
+		{
+			Real phase = (Real)(n * -2) * pi * frequency;
+			Real weight = amplitude * window(n);
+			sink(n, weight * std::cos(phase), weight * std::sin(phase));
+		}
+	}
+
+	// Frequency ramp over the whole wave for FMCW, from -bandwidth/2 to bandwidth/2.  A sawtooth
+	// sweeps up once, a triangle sweeps up over the first half and down over the second.  The
+	// phase returns to zero at the end of every sweep, so the repeated wave is phase continuous.
+	// The phase is kept in double since a sweep is thousands of cycles long.
+	template <typename Real, typename WindowPolicy, typename Sink>
+	void fmcwRamp(int nSamples, bool triangle, Real bandwidth, Real amplitude, Real samplingFreq, const WindowPolicy& window, Sink&& sink)
+	{
+		const double twoPi = 2 * std::numbers::pi;
+		int rise = triangle ? nSamples / 2 : nSamples;
+		for (int n = 0; n < nSamples; n++)
+		{
+			bool rising = n < rise;
+			double m = rising ? n : n - rise;
+			double length = rising ? rise : nSamples - rise;
+			double cycles = (double)bandwidth / samplingFreq * (m * m / (2 * length) - m / 2);
+			if (!rising) cycles = -cycles;
+			double phase = twoPi * (cycles - std::floor(cycles));
+			Real weight = amplitude * window(n);
+			sink(n, weight * (Real)std::cos(phase), weight * (Real)std::sin(phase));
+		}
+	}
+
+	// --------------- //
+	//  O U T P U T S  //
+	// --------------- //
+
+	// Writes the samples to the span, scaled by gain (the DAC gain for sc16).
+	template <typename SampleType>
+	struct SpanSink
+	{
+		using Real = typename SampleTraits<SampleType>::Real;
+		std::span<SampleType> wave;
+		Real gain;
+		void operator()(int n, Real re, Real im) const { wave[n] = SampleTraits<SampleType>::convert(gain * re, gain * im); }
+	};
+
+	// Measures the per rail peak and the power of the samples without storing them.
+	struct LevelSink
+	{
+		double peak = 0;
+		double power = 0;
+		void operator()(int, float re, float im)
+		{
+			peak = std::max(peak, (double)std::max(std::abs(re), std::abs(im)));
+			power += (double)re * re + (double)im * im;
+		}
+	};
+}
+
+// ================================================================================================================================================================================ //
+//  Generators.                                                                                                                                                                     //
+// ================================================================================================================================================================================ //
+
+// Generate a frequency ramp into the span.  The span should have an odd length.
+template <typename SampleType, typename WindowPolicy>
+void linearChirp(std::span<SampleType> wave, float bandwidth, float amplitude, unsigned samplingFreq, const WindowPolicy& window, float gain = 1)
+{
+	using Real = typename SampleTraits<SampleType>::Real;
+	kernels::linearChirp<Real>((int)wave.size(), bandwidth, amplitude, (Real)samplingFreq, window, kernels::SpanSink<SampleType>{ wave, gain });
+}
+
+// Generate a constant sine into the span.
+template <typename SampleType, typename WindowPolicy>
+void constSine(std::span<SampleType> wave, float frequency, float amplitude, const WindowPolicy& window, float gain = 1)
+{
+	using Real = typename SampleTraits<SampleType>::Real;
+	kernels::constSine<Real>((int)wave.size(), frequency, amplitude, window, kernels::SpanSink<SampleType>{ wave, gain });
+}
+
+// Generate an FMCW sawtooth or triangle ramp over the whole span.
+template <typename SampleType, typename WindowPolicy>
+void fmcwRamp(std::span<SampleType> wave, bool triangle, float bandwidth, float amplitude, unsigned samplingFreq, const WindowPolicy& window, float gain = 1)
+{
+	using Real = typename SampleTraits<SampleType>::Real;
+	kernels::fmcwRamp<Real>((int)wave.size(), triangle, bandwidth, amplitude, (Real)samplingFreq, window, kernels::SpanSink<SampleType>{ wave, gain });
+}
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
@@ -4,147 +4,98 @@
 
 #include <iostream>
 #include "Waveforms.h"
+#include "WaveformKernels.h"
+#include "ComplexKernels.h"
 #include <string>
 #include <vector>
 #include <complex>
-#include <math.h>
+#include <cmath>
+#include <random>
+#include <algorithm>
 #include "../External/Misc/ConsoleColor.h"
 
 // ================================================================================================================================================================================ //
-//  Constants.                                                                                                                                                                      //
+//  Dispatch.                                                                                                                                                                       //
 // ================================================================================================================================================================================ //
 
-const float PI = 3.14159265359;
-const std::complex<float> i(0, 1);
+template <typename SampleType>
+bool generateWave(std::span<SampleType> wave, const std::string& type, float bandwidth, float amplitude, unsigned samplingFreq, const std::string& window, const WindowParameters& windowParameters, float gain)
+{
+	std::fill(wave.begin(), wave.end(), SampleType());
+	bool symmetric = (type == linearChirpWave || type == constantSineWave);
+
+	// Ensure nSamples is odd.
+	if (symmetric && wave.size() % 2 == 0) { std::cout << red << "\n[WAVEFORM] [ERROR]: " << white << "nSamples is not an odd number.\n"; return false; }
+
+	// Select the kernel specialised for the window.
+	auto generate = [&](const auto& weights)
+	{
+		if (type == linearChirpWave)					linearChirp(wave, bandwidth, amplitude, samplingFreq, weights, gain);
+		// The non linear chirp currently uses the constant sine phase law.
+		else if (type == constantSineWave ||
+				 type == nonLinearChirpWave)			constSine(wave, bandwidth, amplitude, weights, gain);
+		else if (type == "FMCW Sawtooth" ||
+				 type == "FMCW Triangle")				fmcwRamp(wave, type == "FMCW Triangle", bandwidth, amplitude, samplingFreq, weights, gain);
+		else { std::cout << red << "\n[WAVEFORM] [ERROR]: " << white << "Wave type '" << type << "' not supported.\n"; return false; }
+		return true;
+	};
+	if (window == "None") return generate(NoWindow());
+	return generate(TableWindow{ getWindow(window, (int)wave.size(), windowParameters).data() });
+}
+
+template bool generateWave(std::span<std::complex<float>>, const std::string&, float, float, unsigned, const std::string&, const WindowParameters&, float);
+template bool generateWave(std::span<std::complex<double>>, const std::string&, float, float, unsigned, const std::string&, const WindowParameters&, float);
+template bool generateWave(std::span<std::complex<int16_t>>, const std::string&, float, float, unsigned, const std::string&, const WindowParameters&, float);
+
+WaveLevel measureWave(const std::string& type, int nSamples, float bandwidth, float amplitude, unsigned samplingFreq, const std::string& window, const WindowParameters& windowParameters)
+{
+	WaveLevel level;
+	if (nSamples <= 0) return level;
+	kernels::LevelSink meter;
+	TableWindow weights = { getWindow(window, nSamples, windowParameters).data() };
+	if (type == linearChirpWave)			kernels::linearChirp<float>(nSamples, bandwidth, amplitude, (float)samplingFreq, weights, meter);
+	else if (type == "FMCW Sawtooth" ||
+			 type == "FMCW Triangle")		kernels::fmcwRamp<float>(nSamples, type == "FMCW Triangle", bandwidth, amplitude, (float)samplingFreq, weights, meter);
+	else									kernels::constSine<float>(nSamples, bandwidth, amplitude, weights, meter);
+	level.peak = meter.peak;
+	level.rms = std::sqrt(meter.power / nSamples);
+	return level;
+}
+
+std::string canonicalWaveType(const std::string& type)
+{
+	// The menu used to save these spellings.
+	if (type == "Non-Linear Frequency Chirp") return nonLinearChirpWave;
+	if (type == "Constant sine") return constantSineWave;
+	return type;
+}
+
+double dacGain(const WaveLevel& level, float backoffDBFS, const std::string& normalisation)
+{
+	double reference = (normalisation == "RMS") ? level.rms : level.peak;
+	if (reference == 0) return 0;
+	return 32767.0 * std::pow(10.0, -backoffDBFS / 20.0) / reference;
+}
 
 // ================================================================================================================================================================================ //
 //  Frequency ramp.                                                                                                                                                                 //
 // ================================================================================================================================================================================ //
 
-std::vector<std::complex<float>> generateLinearChirp(int nSamples, float bandwidth, float amplitude, unsigned samplingFreq, std::string window)
+std::vector<std::complex<float>> generateLinearChirp(int nSamples, float bandwidth, float amplitude, unsigned samplingFreq, std::string window, const WindowParameters& windowParameters)
 {
-	// --------------------- //
-	//  G E N E R A T I O N  //
-	// --------------------- //
-
 	std::vector<std::complex<float>> wave(nSamples);
-
-	// Ensure nSamples is odd.
-	if (nSamples % 2 == 0) { std::cout << red << "\n[WAVEFORM] [ERROR]: " << white << "nSamples is not an odd number.\n"; }
-
-	else
-	{
-		// Calculate wave parameters.
-		float freqGradient = bandwidth / ((float)nSamples - 1.f);
-		int index = 0;
-		float FREQ;
-		// Populate wave vector.
-		for (int n = floor(-(nSamples - 1) / 2); n <= ceil((nSamples - 1) / 2); n++)
-		{
-			FREQ = ((freqGradient * index) - (bandwidth / 2)) / samplingFreq;
-			wave[index] = std::exp(n * -2 * PI * FREQ * i);
-			index++;
-		}
-	}
-
-	// ------------------- //
-	//  W I N D O W I N G  //
-	// ------------------- //
-
-	// [NOTE]: Window calculations may change with even and odd lengths?
-	//		   ATM even waveforms cannot be generated.
-
-	// No window.
-	if(window=="None")
-		return wave;
-
-	// Blackman window.
-	if (window == "Blackman")
-	{
-		std::vector<float> blackmanWindow(nSamples);
-		for (int n = 0; n < nSamples; n++)
-			blackmanWindow[n] = 0.42 - 0.5 * std::cos((2 * PI * n) / (nSamples - 1)) + 0.08 * std::cos(((4 * PI * n) / (nSamples - 1)));
-		for (int n = 0; n < nSamples; n++)
-			wave[n] *= blackmanWindow[n];
-	}
-
-	// Hamming window.
-	else if (window == "Hamming")
-	{
-		std::vector<float> hammingWindow(nSamples);
-		int min = -std::floor(nSamples / 2);
-		int max = std::floor(nSamples / 2);
-		for (int n = min; n <= max; n++)
-			hammingWindow[n-min] = 0.54 + 0.46 * std::cos( ( 2 * PI * n ) / nSamples );
-		for (int n = 0; n < nSamples; n++)
-			wave[n] *= hammingWindow[n];
-	}
-
-	// Return windowed wave.
+	generateWave(std::span(wave), linearChirpWave, bandwidth, amplitude, samplingFreq, window, windowParameters);
 	return wave;
 }
 
 // ================================================================================================================================================================================ //
-//  Constant sine wave.                                                                                                                                                                 //
+//  Constant sine wave.                                                                                                                                                             //
 // ================================================================================================================================================================================ //
 
-std::vector<std::complex<float>> generateConstSine(int nSamples, float frequency, float amplitude, unsigned samplingFreq, std::string window)
+std::vector<std::complex<float>> generateConstSine(int nSamples, float frequency, float amplitude, unsigned samplingFreq, std::string window, const WindowParameters& windowParameters)
 {
-	// --------------------- //
-	//  G E N E R A T I O N  //
-	// --------------------- //
-
 	std::vector<std::complex<float>> wave(nSamples);
-
-	// Ensure nSamples is odd.
-	if (nSamples % 2 == 0) { std::cout << red << "\n[WAVEFORM] [ERROR]: " << white << "nSamples is not an odd number.\n"; }
-
-	else
-	{
-		// Calculate wave parameters.
-		int index = 0;
-		// Populate wave vector.
-		for (int n = 0; n < nSamples; n++)
-		{
-			wave[index] = std::exp(n * -2 * PI * frequency * i);
-			index++;
-		}
-	}
-
-	// ------------------- //
-	//  W I N D O W I N G  //
-	// ------------------- //
-
-	// [NOTE]: Window calculations may change with even and odd lengths?
-	//		   ATM even waveforms cannot be generated.
-
-	// No window.
-	if (window == "None")
-		return wave;
-
-	// Blackman window.
-	if (window == "Blackman")
-	{
-		std::vector<float> blackmanWindow(nSamples);
-		for (int n = 0; n < nSamples; n++)
-			blackmanWindow[n] = 0.42 - 0.5 * std::cos((2 * PI * n) / (nSamples - 1)) + 0.08 * std::cos(((4 * PI * n) / (nSamples - 1)));
-		for (int n = 0; n < nSamples; n++)
-			wave[n] *= blackmanWindow[n];
-	}
-
-	// Hamming window.
-	else if (window == "Hamming")
-	{
-		std::vector<float> hammingWindow(nSamples);
-		int min = -std::floor(nSamples / 2);
-		int max = std::floor(nSamples / 2);
-		for (int n = min; n <= max; n++)
-			hammingWindow[n - min] = 0.54 + 0.46 * std::cos((2 * PI * n) / nSamples);
-		for (int n = 0; n < nSamples; n++)
-			wave[n] *= hammingWindow[n];
-	}
-
-	// Return windowed wave.
+	generateWave(std::span(wave), constantSineWave, frequency, amplitude, samplingFreq, window, windowParameters);
 	return wave;
 }
 
@@ -152,58 +103,56 @@ std::vector<std::complex<float>> generateConstSine(int nSamples, float frequency
 //  Non Linear Frequency Chirp.                                                                                                                                                     //
 // ================================================================================================================================================================================ //
 
-std::vector<std::complex<float>> generateNonLinearChirp(int nSamples, float frequency, float amplitude, unsigned samplingFreq, std::string window)
+std::vector<std::complex<float>> generateNonLinearChirp(int nSamples, float frequency, float amplitude, unsigned samplingFreq, std::string window, const WindowParameters& windowParameters)
 {
-	// --------------------- //
-	//  G E N E R A T I O N  //
-	// --------------------- //
-
 	std::vector<std::complex<float>> wave(nSamples);
+	generateWave(std::span(wave), nonLinearChirpWave, frequency, amplitude, samplingFreq, window, windowParameters);
+	return wave;
+}
 
-	// Calculate wave parameters.
-	int index = 0;
-	// Populate wave vector.
-	for (int n = 0; n < nSamples; n++)
-	{
-		wave[index] = std::exp(n * -2 * PI * frequency * i);
-		index++;
-	}
-
-	// ------------------- //
-	//  W I N D O W I N G  //
-	// ------------------- //
-
-	// [NOTE]: Window calculations may change with even and odd lengths?
-	//		   ATM even waveforms cannot be generated.
-
-	// No window.
-	if (window == "None")
-		return wave;
+// ================================================================================================================================================================================ //
+//  SC16 conversion.                                                                                                                                                                //
+// ================================================================================================================================================================================ //
 
-	// Blackman window.
-	if (window == "Blackman")
-	{
-		std::vector<float> blackmanWindow(nSamples);
-		for (int n = 0; n < nSamples; n++)
-			blackmanWindow[n] = 0.42 - 0.5 * std::cos((2 * PI * n) / (nSamples - 1)) + 0.08 * std::cos(((4 * PI * n) / (nSamples - 1)));
-		for (int n = 0; n < nSamples; n++)
-			wave[n] *= blackmanWindow[n];
-	}
-
-	// Hamming window.
-	else if (window == "Hamming")
+std::vector<std::complex<int16_t>> convertToSC16(const std::vector<std::complex<float>>& wave, int activeSamples, float backoffDBFS, std::string normalisation, bool dither)
+{
+	std::vector<std::complex<int16_t>> waveSC16(wave.size(), std::complex<int16_t>(0, 0));
+	activeSamples = std::min(activeSamples, (int)wave.size());
+	if (activeSamples <= 0) return waveSC16;
+
+	// --------------------------- //
+	//  N O R M A L I S A T I O N  //
+	// --------------------------- //
+
+	// Measure the level of the pulse.  The peak is taken per rail since the I and Q DACs clip
+	// independently.  The whole wave is measured so that the tails a predistortion filter adds
+	// around the pulse are included, but the RMS is taken over the pulse length.
+	WaveLevel level;
+	for (int n = 0; n < (int)wave.size(); n++) level.peak = std::max(level.peak, (double)std::max(std::abs(wave[n].real()), std::abs(wave[n].imag())));
+	double power = complexPowerSum(wave);
+	level.rms = std::sqrt(power / activeSamples);
+	double gain = dacGain(level, backoffDBFS, normalisation);
+	if (gain == 0) return waveSC16;
+	double fullScale = 32767.0;
+
+	// ------------------------- //
+	//  Q U A N T I S A T I O N  //
+	// ------------------------- //
+
+	// TPDF dither: the sum of two uniform variables spanning one LSB each.  Seeded so that
+	// the same settings always produce the same samples.
+	std::mt19937 generator(2021);
+	std::uniform_real_distribution<double> uniform(-0.5, 0.5);
+	auto quantise = [&](double value)
 	{
-		std::vector<float> hammingWindow(nSamples);
-		int min = -std::floor(nSamples / 2);
-		int max = std::floor(nSamples / 2);
-		for (int n = min; n <= max; n++)
-			hammingWindow[n - min] = 0.54 + 0.46 * std::cos((2 * PI * n) / nSamples);
-		for (int n = 0; n < nSamples; n++)
-			wave[n] *= hammingWindow[n];
-	}
-
-	// Return windowed wave.
-	return wave;
+		if (dither) value += uniform(generator) + uniform(generator);
+		return (int16_t)std::clamp(std::round(value), -fullScale, fullScale);
+	};
+	// The zero padding stays exactly zero, without dither.
+	for (int n = 0; n < (int)wave.size(); n++)
+		if (wave[n] != std::complex<float>(0, 0)) waveSC16[n] = std::complex<int16_t>(quantise(gain * wave[n].real()), quantise(gain * wave[n].imag()));
+
+	return waveSC16;
 }
 
 // ================================================================================================================================================================================ //
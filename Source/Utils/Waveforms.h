@@ -6,19 +6,54 @@
 
 #include <vector>
 #include <complex>
+#include <string>
+#include <cstdint>
+#include <span>
+#include "WindowFunctions.h"
 
 // ================================================================================================================================================================================ //
 //  Declerations.                                                                                                                                                                   //
 // ================================================================================================================================================================================ //
 
+// Names of the wave types, as passed to generateWave() and saved in the settings.
+inline constexpr const char* linearChirpWave = "Linear Frequency Chirp";
+inline constexpr const char* nonLinearChirpWave = "Non Linear Frequency Chirp";
+inline constexpr const char* constantSineWave = "Constant Sine";
+
+// The name of a wave type as above, for the spellings older settings files may hold.
+std::string canonicalWaveType(const std::string& type);
+
 // Generate a frequency ramp complex wave.
-std::vector<std::complex<float>> generateLinearChirp(int nSamples, float bandwidth, float amplitude, unsigned samplingFreq, std::string window = "None");
+std::vector<std::complex<float>> generateLinearChirp(int nSamples, float bandwidth, float amplitude, unsigned samplingFreq, std::string window = "None", const WindowParameters& windowParameters = WindowParameters());
 
 // Generate a constant sine complex wave.
-std::vector<std::complex<float>> generateConstSine(int nSamples, float frequuency, float amplitude, unsigned samplingFreq, std::string window = "None");
+std::vector<std::complex<float>> generateConstSine(int nSamples, float frequuency, float amplitude, unsigned samplingFreq, std::string window = "None", const WindowParameters& windowParameters = WindowParameters());
 
 // Generate a non linear frequency chirp.
-std::vector<std::complex<float>> generateNonLinearChirp(int nSamples, float bandwidth, float amplitude, unsigned samplingFreq, std::string window = "None");
+std::vector<std::complex<float>> generateNonLinearChirp(int nSamples, float bandwidth, float amplitude, unsigned samplingFreq, std::string window = "None", const WindowParameters& windowParameters = WindowParameters());
+
+// Generate the pulse of the given wave type into the span, with the window chosen at runtime.  This
+// dispatches to the kernels in WaveformKernels.h, gain scales the output (the DAC gain for sc16).
+// Returns false and leaves the span zeroed if the wave type or length is not supported.
+template <typename SampleType>
+bool generateWave(std::span<SampleType> wave, const std::string& type, float bandwidth, float amplitude, unsigned samplingFreq, const std::string& window = "None", const WindowParameters& windowParameters = WindowParameters(), float gain = 1);
+
+// Level of a pulse, with the peak taken per rail.
+struct WaveLevel
+{
+	double peak = 0;
+	double rms = 0;
+};
+
+// Measure the level of a pulse without storing it.
+WaveLevel measureWave(const std::string& type, int nSamples, float bandwidth, float amplitude, unsigned samplingFreq, const std::string& window = "None", const WindowParameters& windowParameters = WindowParameters());
+
+// Gain that puts the "Peak" or "RMS" level backoffDBFS below sc16 full scale.
+double dacGain(const WaveLevel& level, float backoffDBFS, const std::string& normalisation);
+
+// Convert a waveform to sc16 samples for the DAC.  The pulse (activeSamples long) is normalised so
+// that its "Peak" or "RMS" level sits backoffDBFS below full scale, with optional TPDF dither.
+std::vector<std::complex<int16_t>> convertToSC16(const std::vector<std::complex<float>>& wave, int activeSamples, float backoffDBFS, std::string normalisation = "Peak", bool dither = false);
 
 // ================================================================================================================================================================================ //
 //  EOF.	                                                                                                                                                                        //
@@ -0,0 +1,230 @@
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include "WindowFunctions.h"
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <cmath>
+#include <numbers>
+#include <algorithm>
+#include <sstream>
+#include "../External/Misc/ConsoleColor.h"
+
+// ================================================================================================================================================================================ //
+//  Memoisation.                                                                                                                                                                    //
+// ================================================================================================================================================================================ //
+
+namespace
+{
+	// Key identifying a window table.  Parameters that do not apply to the window
+	// type are left at zero so they do not cause duplicate tables.
+	struct WindowKey
+	{
+		std::string type;
+		int nSamples;
+		float parameterA;
+		float parameterB;
+
+		bool operator<(const WindowKey& other) const
+		{
+			return std::tie(type, nSamples, parameterA, parameterB) < std::tie(other.type, other.nSamples, other.parameterA, other.parameterB);
+		}
+	};
+
+	std::mutex windowMutex;
+	std::map<WindowKey, std::vector<float>> windowTables;
+
+	const double PI = std::numbers::pi;
+
+	// Zeroth order modified Bessel function of the first kind.
+	double besselI0(double x)
+	{
+		double sum = 1.0;
+		double term = 1.0;
+		double quarterX2 = x * x / 4.0;
+		for (int k = 1; k < 64; k++)
+		{
+			term *= quarterX2 / ((double)k * k);
+			sum += term;
+			if (term < sum * 1e-16) break;
+		}
+		return sum;
+	}
+
+	// Chebyshev polynomial of the first kind, valid for |x| > 1 as well.
+	double chebyshevPolynomial(int order, double x)
+	{
+		if (std::abs(x) <= 1.0) return std::cos(order * std::acos(x));
+		if (x > 1.0) return std::cosh(order * std::acosh(x));
+		return ((order % 2) ? -1.0 : 1.0) * std::cosh(order * std::acosh(-x));
+	}
+
+	// --------------------- //
+	//  G E N E R A T I O N  //
+	// --------------------- //
+
+	void rectangularWindow(std::vector<float>& window)
+	{
+		std::fill(window.begin(), window.end(), 1.f);
+	}
+
+	void blackmanWindow(std::vector<float>& window)
+	{
+		int nSamples = (int)window.size();
+		if (nSamples == 1) { window[0] = 1.f; return; }
+		for (int n = 0; n < nSamples; n++)
+			window[n] = 0.42 - 0.5 * std::cos((2 * PI * n) / (nSamples - 1)) + 0.08 * std::cos(((4 * PI * n) / (nSamples - 1)));
+	}
+
+	void hammingWindow(std::vector<float>& window)
+	{
+		// Centred definition, as it has always been used by the pulse generators.
+		int nSamples = (int)window.size();
+		int min = -(nSamples / 2);
+		for (int k = 0; k < nSamples; k++)
+			window[k] = 0.54 + 0.46 * std::cos((2 * PI * (k + min)) / nSamples);
+	}
+
+	void kaiserWindow(std::vector<float>& window, double beta)
+	{
+		int nSamples = (int)window.size();
+		if (nSamples == 1) { window[0] = 1.f; return; }
+		double denominator = besselI0(beta);
+		for (int n = 0; n < nSamples; n++)
+		{
+			double ratio = (2.0 * n) / (nSamples - 1) - 1.0;
+			window[n] = besselI0(beta * std::sqrt(std::max(0.0, 1.0 - ratio * ratio))) / denominator;
+		}
+	}
+
+	void tukeyWindow(std::vector<float>& window, double alpha)
+	{
+		int nSamples = (int)window.size();
+		if (nSamples == 1 || alpha <= 0) { rectangularWindow(window); return; }
+		alpha = std::min(alpha, 1.0);
+		double taper = alpha * (nSamples - 1) / 2.0;
+		for (int n = 0; n < nSamples; n++)
+		{
+			if (n < taper)							window[n] = 0.5 * (1 - std::cos(PI * n / taper));
+			else if (n > (nSamples - 1) - taper)	window[n] = 0.5 * (1 - std::cos(PI * ((nSamples - 1) - n) / taper));
+			else									window[n] = 1.f;
+		}
+	}
+
+	void taylorWindow(std::vector<float>& window, unsigned nBar, double sidelobeLevel)
+	{
+		int nSamples = (int)window.size();
+		if (nBar < 2) { rectangularWindow(window); return; }
+		// Coefficients of the cosine series.
+		double B = std::pow(10.0, sidelobeLevel / 20.0);
+		double A = std::acosh(B) / PI;
+		double sigma2 = (double)nBar * nBar / (A * A + (nBar - 0.5) * (nBar - 0.5));
+		std::vector<double> Fm(nBar - 1);
+		for (unsigned m = 1; m < nBar; m++)
+		{
+			double numerator = (m % 2) ? 1.0 : -1.0;
+			double denominator = 2.0;
+			for (unsigned j = 1; j < nBar; j++)
+			{
+				numerator *= 1.0 - (double)m * m / sigma2 / (A * A + (j - 0.5) * (j - 0.5));
+				if (j != m) denominator *= 1.0 - (double)m * m / ((double)j * j);
+			}
+			Fm[m - 1] = numerator / denominator;
+		}
+		// Evaluate the series and normalise to a unity peak at the centre.
+		double centre = 1.0;
+		for (unsigned m = 1; m < nBar; m++) centre += 2.0 * Fm[m - 1];
+		for (int n = 0; n < nSamples; n++)
+		{
+			double value = 1.0;
+			double position = (n - nSamples / 2.0 + 0.5) / nSamples;
+			for (unsigned m = 1; m < nBar; m++)
+				value += 2.0 * Fm[m - 1] * std::cos(2 * PI * m * position);
+			window[n] = value / centre;
+		}
+	}
+
+	void chebyshevWindow(std::vector<float>& window, double sidelobeLevel)
+	{
+		int nSamples = (int)window.size();
+		if (nSamples == 1) { window[0] = 1.f; return; }
+		int order = nSamples - 1;
+		double x0 = std::cosh(std::acosh(std::pow(10.0, sidelobeLevel / 20.0)) / order);
+		// The window is the inverse DFT of the Chebyshev polynomial sampled on the unit
+		// circle.  Only half of it has to be evaluated since it is symmetric.
+		std::vector<double> spectrum(nSamples);
+		for (int k = 0; k < nSamples; k++)
+			spectrum[k] = chebyshevPolynomial(order, x0 * std::cos(PI * k / nSamples));
+		double peak = 0;
+		for (int n = 0; n <= order / 2; n++)
+		{
+			double sum = 0;
+			double shift = order / 2.0;
+			for (int k = 0; k < nSamples; k++)
+				sum += spectrum[k] * std::cos(2 * PI * k * (n - shift) / nSamples);
+			window[n] = sum;
+			window[order - n] = sum;
+			peak = std::max(peak, std::abs(sum));
+		}
+		for (float& value : window) value /= peak;
+	}
+}
+
+// ================================================================================================================================================================================ //
+//  Lookup.                                                                                                                                                                         //
+// ================================================================================================================================================================================ //
+
+const std::vector<std::string>& windowTypes()
+{
+	static const std::vector<std::string> types = { "None", "Blackman", "Hamming", "Kaiser", "Taylor", "Dolph-Chebyshev", "Tukey" };
+	return types;
+}
+
+const std::vector<float>& getWindow(const std::string& type, int nSamples, const WindowParameters& parameters)
+{
+	nSamples = std::max(nSamples, 0);
+
+	// Only the parameters of the requested type are part of the key.
+	WindowKey key = { type, nSamples, 0.f, 0.f };
+	if (type == "Kaiser")					key.parameterA = parameters.kaiserBeta;
+	else if (type == "Taylor")				{ key.parameterA = (float)parameters.taylorNBar; key.parameterB = parameters.sidelobeLevel; }
+	else if (type == "Dolph-Chebyshev")		key.parameterA = parameters.sidelobeLevel;
+	else if (type == "Tukey")				key.parameterA = parameters.tukeyAlpha;
+
+	std::lock_guard<std::mutex> lock(windowMutex);
+	auto existing = windowTables.find(key);
+	if (existing != windowTables.end()) return existing->second;
+
+	// Compute the table once.
+	std::vector<float> window(nSamples, 1.f);
+	if (nSamples)
+	{
+		if (type == "None")						rectangularWindow(window);
+		else if (type == "Blackman")			blackmanWindow(window);
+		else if (type == "Hamming")				hammingWindow(window);
+		else if (type == "Kaiser")				kaiserWindow(window, parameters.kaiserBeta);
+		else if (type == "Taylor")				taylorWindow(window, parameters.taylorNBar, parameters.sidelobeLevel);
+		else if (type == "Dolph-Chebyshev")		chebyshevWindow(window, parameters.sidelobeLevel);
+		else if (type == "Tukey")				tukeyWindow(window, parameters.tukeyAlpha);
+		else { std::cout << red << "\n[WINDOW] [ERROR]: " << white << "Window '" << type << "' not supported, no window applied.\n"; }
+	}
+	return windowTables.emplace(key, std::move(window)).first->second;
+}
+
+std::string describeWindow(const std::string& type, const WindowParameters& parameters)
+{
+	std::ostringstream description;
+	description << type;
+	if (type == "Kaiser")					description << " (beta " << parameters.kaiserBeta << ")";
+	else if (type == "Taylor")				description << " (nbar " << parameters.taylorNBar << ", " << parameters.sidelobeLevel << " dB)";
+	else if (type == "Dolph-Chebyshev")		description << " (" << parameters.sidelobeLevel << " dB)";
+	else if (type == "Tukey")				description << " (alpha " << parameters.tukeyAlpha << ")";
+	return description.str();
+}
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
@@ -0,0 +1,47 @@
+#pragma once
+
+/*
+* Window functions shared by the TX pulse generators and the receive-side weighting.
+* Tables are memoised by (type, length, parameters) so every caller asking for the
+* same window receives the same table, which is only ever computed once.
+*/
+
+// ================================================================================================================================================================================ //
+//  Includes.                                                                                                                                                                       //
+// ================================================================================================================================================================================ //
+
+#include <string>
+#include <vector>
+
+// ================================================================================================================================================================================ //
+//  Parameters.                                                                                                                                                                     //
+// ================================================================================================================================================================================ //
+
+// Shape parameters for the windows that have them.  Only the parameters used by the
+// requested window take part in the memoisation key.
+struct WindowParameters
+{
+	float kaiserBeta = 6.f;			// Kaiser shape parameter (beta).
+	unsigned taylorNBar = 4;		// Number of nearly constant level sidelobes (n bar) of the Taylor window.
+	float sidelobeLevel = 30.f;		// Sidelobe level below the mainlobe [dB], Taylor and Dolph-Chebyshev.
+	float tukeyAlpha = 0.5f;		// Fraction of the Tukey window inside the cosine tapers.
+};
+
+// ================================================================================================================================================================================ //
+//  Declerations.                                                                                                                                                                   //
+// ================================================================================================================================================================================ //
+
+// The window types that can be requested, in the order they are presented in the menu.
+const std::vector<std::string>& windowTypes();
+
+// Returns the memoised window table of the given type and length.  "None" returns a
+// rectangular window so that callers can always apply the table as a fused multiply.
+// The returned reference stays valid for the lifetime of the application.
+const std::vector<float>& getWindow(const std::string& type, int nSamples, const WindowParameters& parameters = WindowParameters());
+
+// Describes the window and the parameters that apply to it, e.g. "Kaiser (beta 6)".
+std::string describeWindow(const std::string& type, const WindowParameters& parameters);
+
+// ================================================================================================================================================================================ //
+//  EOF.                                                                                                                                                                            //
+// ================================================================================================================================================================================ //
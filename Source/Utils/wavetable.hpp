@@ -14,9 +14,18 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <cstdint>
+#include <span>
+#include <type_traits>
 
 static const size_t wave_table_len = 8192;
 
+//! DDS phase accumulator: the top bits index the table, the remaining bits are the fraction
+static const int wave_table_index_bits = 13; // log2(wave_table_len)
+static const int wave_table_phase_shift = 64 - wave_table_index_bits;
+static_assert((size_t(1) << wave_table_index_bits) == wave_table_len,
+    "wave_table_len must be a power of two for the DDS phase accumulator");
+
 class wave_table_class
 {
 public:
@@ -70,6 +79,9 @@ public:
         else {
             throw std::runtime_error("unknown waveform type: " + wave_type);
         }
+        // Guard entry so the interpolating DDS never has to wrap the upper index
+        _dds_table = _wave_table;
+        _dds_table.push_back(_wave_table.front());
     }
 
     inline std::complex<float> operator()(const size_t index) const
@@ -83,7 +95,88 @@ public:
         return _power_dbfs;
     }
 
+    /**************************************************************************
+     * DDS mode
+     *************************************************************************/
+    //! Phase increment per sample for a tone of freq [Hz] at rate [S/s]. One
+    //  full rotation of the table is 2^64, so the tone frequency is resolved to
+    //  rate / 2^64 instead of rate / wave_table_len. Negative freq is allowed.
+    static uint64_t get_phase_increment(const double freq, const double rate)
+    {
+        double cycles = freq / rate;
+        cycles -= std::floor(cycles);
+        const double increment = std::ldexp(cycles, 64);
+        return (increment >= 18446744073709551616.0) ? 0 : static_cast<uint64_t>(increment);
+    }
+
+    //! Interpolate linearly between table entries instead of truncating the phase
+    inline void set_interpolation(const bool enable)
+    {
+        _interpolate = enable;
+    }
+
+    //! Set (or reset) the phase of the accumulator, a full rotation is 2^64
+    inline void set_phase(const uint64_t phase)
+    {
+        _phase = phase;
+    }
+
+    inline uint64_t get_phase() const
+    {
+        return _phase;
+    }
+
+    //! Fill buff with consecutive samples stepped by phase_increment. The phase
+    //  carries over between calls, so consecutive buffers are phase continuous.
+    //  sample_type is std::complex<float> or std::complex<int16_t> (full scale
+    //  is an amplitude of 1.0).
+    template <typename sample_type>
+    void fill(std::span<sample_type> buff, const uint64_t phase_increment)
+    {
+        // The phase of each sample is computed from the start phase, so there
+        // is no dependency between iterations and the loops vectorise.
+        const uint64_t start = _phase;
+        const std::complex<float>* table = _dds_table.data();
+        const size_t n_samps = buff.size();
+        if (_interpolate) {
+            static const float frac_scale = 1.0f / float(uint64_t(1) << 24);
+            for (size_t n = 0; n < n_samps; n++) {
+                const uint64_t phase = start + n * phase_increment;
+                const size_t index = size_t(phase >> wave_table_phase_shift);
+                const float frac =
+                    float((phase >> (wave_table_phase_shift - 24)) & 0xFFFFFF) * frac_scale;
+                buff[n] = _convert<sample_type>(
+                    table[index] + frac * (table[index + 1] - table[index]));
+            }
+        } else {
+            for (size_t n = 0; n < n_samps; n++) {
+                const uint64_t phase = start + n * phase_increment;
+                buff[n] = _convert<sample_type>(table[phase >> wave_table_phase_shift]);
+            }
+        }
+        _phase = start + n_samps * phase_increment;
+    }
+
 private:
     std::vector<std::complex<float>> _wave_table;
+    std::vector<std::complex<float>> _dds_table;
     double _power_dbfs;
+    uint64_t _phase   = 0;
+    bool _interpolate = false;
+
+    template <typename sample_type>
+    static inline sample_type _convert(const std::complex<float>& sample)
+    {
+        if constexpr (std::is_same_v<sample_type, std::complex<int16_t>>) {
+            auto to_sc16 = [](const float value) {
+                return static_cast<int16_t>(
+                    std::clamp(std::round(value * 32767.0f), -32767.0f, 32767.0f));
+            };
+            return {to_sc16(sample.real()), to_sc16(sample.imag())};
+        } else {
+            static_assert(std::is_same_v<sample_type, std::complex<float>>,
+                "DDS fill supports std::complex<float> and std::complex<int16_t>");
+            return sample;
+        }
+    }
 };
\ No newline at end of file